@@ -0,0 +1,258 @@
+#!/bin/bash
+#
+# Benchmark de tpfs contra el programa de referencia tpfs_ref.
+#
+# Arma (si no existe) un corpus de imágenes FAT12/16/32, EXT2/3/4 y NTFS con el mismo árbol de prueba, corre sobre cada imágen
+# las cargas de trabajo (superbloque, DIR profundo, CAT grande y recorrido recursivo) con los dos programas, compara sus salidas
+# y guarda los resultados en bench/resultados/<fecha>.json. Se corre con "make bench".
+#
+# Variables de entorno:
+#	REPETICIONES	Corridas de cada carga, se informa la mediana (por defecto 5).
+#	TPFS		Programa a medir (por defecto tpfs_bench, que "make bench" compila optimizado).
+#
+# Las imágenes cuyos programas de formateo no están instalados (mkfs.fat/mcopy, mkntfs) se omiten. Cualquier otra imágen que se
+# deje en bench/imagenes se mide con las cargas que no dependen del contenido (superbloque y DIR de la raíz).
+#
+
+RAIZ=$(cd "$(dirname "$0")/.." && pwd)
+BENCH=$RAIZ/bench
+CORPUS=$BENCH/corpus
+TRABAJO=$BENCH/trabajo
+RESULTADOS=$BENCH/resultados
+REPETICIONES=${REPETICIONES:-5}
+TPFS=${TPFS:-$RAIZ/tpfs_bench}
+REF=$RAIZ/tpfs_ref
+MEDIR=$BENCH/medir
+
+# Forma del árbol de prueba
+PROFUNDIDAD=8
+ARCHIVOS_PROFUNDO=500
+LONGITUD_GRANDE=$((4*1024*1024))
+RAMAS=10
+ARCHIVOS_RAMA=5
+
+
+#
+# Arma en $1 el árbol de prueba: un directorio profundo con muchos archivos, un archivo grande y un árbol ancho para recorrer.
+#
+armar_arbol()
+{
+	local Destino=$1 Ruta i j k
+
+	rm -rf "$Destino"
+	mkdir -p "$Destino"
+
+	# Directorio profundo
+	Ruta=$Destino/profundo
+	for ((i=1; i<=PROFUNDIDAD; i++)); do
+		Ruta=$Ruta/nivel$i
+	done
+	mkdir -p "$Ruta"
+	for ((i=0; i<ARCHIVOS_PROFUNDO; i++)); do
+		printf 'archivo %d\n' $i > "$Ruta/f$i.txt"
+	done
+
+	# Archivo grande
+	head -c $LONGITUD_GRANDE /dev/urandom > "$Destino/grande.bin"
+
+	# Árbol ancho
+	for ((i=0; i<RAMAS; i++)); do
+		for ((j=0; j<RAMAS; j++)); do
+			mkdir -p "$Destino/arbol/r$i/s$j"
+			for ((k=0; k<ARCHIVOS_RAMA; k++)); do
+				printf '%d %d %d\n' $i $j $k > "$Destino/arbol/r$i/s$j/a$k.txt"
+			done
+		done
+	done
+}
+
+
+#
+# Arma las imágenes del corpus que falten, con las herramientas que haya instaladas.
+#
+armar_corpus()
+{
+	local Arbol=$CORPUS/arbol Tipo Fat
+
+	mkdir -p "$CORPUS"
+	[ -d "$Arbol" ] || armar_arbol "$Arbol"
+
+	# FAT12 de la cátedra
+	[ -f "$CORPUS/fat12_catedra.bin" ] || cp "$RAIZ/bins/FAT12.bin" "$CORPUS/fat12_catedra.bin"
+
+	# EXT2/3/4 (bloques de 1 KB, que es lo que soporta tpfs_ref)
+	for Tipo in ext2 ext3 ext4; do
+		[ -f "$CORPUS/$Tipo.img" ] && continue
+		if command -v mke2fs > /dev/null; then
+			truncate -s 32M "$CORPUS/$Tipo.img"
+			mke2fs -q -F -t $Tipo -b 1024 -d "$Arbol" "$CORPUS/$Tipo.img" 2> /dev/null || rm -f "$CORPUS/$Tipo.img"
+		fi
+	done
+
+	# FAT12/16/32 (hace falta mtools para copiar el árbol)
+	for Fat in 12 16 32; do
+		[ -f "$CORPUS/fat$Fat.img" ] && continue
+		if command -v mkfs.fat > /dev/null && command -v mcopy > /dev/null; then
+			rm -f "$CORPUS/fat$Fat.img"
+			mkfs.fat -C -F $Fat "$CORPUS/fat$Fat.img" $([ $Fat = 12 ] && echo 8192 || echo 65536) > /dev/null 2>&1 &&
+				mcopy -s -i "$CORPUS/fat$Fat.img" "$Arbol"/* ::/ 2> /dev/null || rm -f "$CORPUS/fat$Fat.img"
+		fi
+	done
+
+	# NTFS (vacía, llenarla requiere montarla)
+	if [ ! -f "$CORPUS/ntfs.img" ] && command -v mkntfs > /dev/null; then
+		truncate -s 32M "$CORPUS/ntfs.img"
+		mkntfs -q -F "$CORPUS/ntfs.img" > /dev/null 2>&1 || rm -f "$CORPUS/ntfs.img"
+	fi
+}
+
+
+#
+# Escribe en $2 el archivo de tests de la carga $1 para una imágen con el árbol de prueba ($3=1) o desconocida ($3=0).
+# Imprime la cantidad de operaciones y los bytes de archivos que lee, o nada si la carga no aplica.
+#
+escribir_carga()
+{
+	local Carga=$1 Tests=$2 ConArbol=$3 Ruta i j
+
+	: > "$Tests"
+	case $Carga in
+		superbloque)
+			echo "1 0"
+			;;
+		dir-profundo)
+			[ $ConArbol = 1 ] || { echo "DIR	/" > "$Tests"; echo "1 0"; return; }
+			Ruta=/profundo
+			for ((i=1; i<=PROFUNDIDAD; i++)); do
+				Ruta=$Ruta/nivel$i
+			done
+			for ((i=0; i<20; i++)); do
+				echo "DIR	$Ruta" >> "$Tests"
+			done
+			echo "20 0"
+			;;
+		cat-grande)
+			[ $ConArbol = 1 ] || return
+			echo "CAT	/grande.bin" > "$Tests"
+			echo "1 $LONGITUD_GRANDE"
+			;;
+		recorrido)
+			[ $ConArbol = 1 ] || return
+			echo "DIR	/arbol" > "$Tests"
+			for ((i=0; i<RAMAS; i++)); do
+				echo "DIR	/arbol/r$i" >> "$Tests"
+				for ((j=0; j<RAMAS; j++)); do
+					echo "DIR	/arbol/r$i/s$j" >> "$Tests"
+				done
+			done
+			echo "$((1+RAMAS+RAMAS*RAMAS)) 0"
+			;;
+		recorrido-find)
+			# Sólo tpfs: el mismo árbol con FIND y DU en paralelo
+			[ $ConArbol = 1 ] || return
+			printf 'FIND	/arbol\nDU	/arbol\n' > "$Tests"
+			echo "2 0"
+			;;
+	esac
+}
+
+
+#
+# Mide el programa copiado como $1 en el directorio de trabajo (así usa su propio archivo de tests) sobre la imágen $2.
+# Imprime "segundos rss_kb resultado".
+#
+medir()
+{
+	local Nombre=$1 Imagen=$2
+
+	cp "$TRABAJO/tests.txt" "$TRABAJO/${Nombre}_tests.txt"
+	(cd "$TRABAJO" && TZ=UTC "$MEDIR" $REPETICIONES "$TRABAJO/$Nombre.out" "$TRABAJO/$Nombre" "$Imagen")
+}
+
+
+#
+# Arma el objeto JSON de una medición ("segundos rss_kb resultado") con $2 operaciones y $3 bytes leídos.
+#
+json_medicion()
+{
+	echo "$1" | awk -v Ops=$2 -v Bytes=$3 '{
+		printf "{\"segundos\": %.6f, \"ops_por_segundo\": %.1f, \"mb_por_segundo\": %s, \"rss_max_kb\": %d, \"resultado\": %d}",
+		       $1, ($1>0 ? Ops/$1 : 0), (Bytes>0 && $1>0 ? sprintf("%.1f", Bytes/$1/1000000) : "null"), $2, $3 }'
+}
+
+
+# Validar lo necesario
+for Archivo in "$TPFS" "$REF" "$MEDIR"; do
+	if [ ! -x "$Archivo" ]; then
+		echo "Falta $Archivo (correr \"make bench\")" >&2
+		exit 1
+	fi
+done
+
+# Preparar el corpus y el directorio de trabajo
+armar_corpus
+rm -rf "$TRABAJO"
+mkdir -p "$TRABAJO" "$RESULTADOS"
+cp "$TPFS" "$TRABAJO/tpfs"
+cp "$REF" "$TRABAJO/tpfs_ref"
+
+# Encabezado
+Fecha=$(date -u +%Y%m%dT%H%M%SZ)
+Commit=$(git -C "$RAIZ" rev-parse --short HEAD 2> /dev/null || echo desconocido)
+Json=$RESULTADOS/$Fecha.json
+{
+	echo "{"
+	echo "  \"fecha\": \"$Fecha\","
+	echo "  \"commit\": \"$Commit\","
+	echo "  \"repeticiones\": $REPETICIONES,"
+	echo "  \"resultados\": ["
+} > "$Json"
+printf '%-22s %-15s %12s %10s %10s %12s %10s %10s  %s\n' Imagen Carga "tpfs ops/s" "MB/s" "RSS KB" "ref ops/s" "MB/s" "RSS KB" "Salida"
+
+# Cada imágen con cada carga
+Primero=1
+for Imagen in "$CORPUS"/*.img "$CORPUS"/*.bin "$BENCH"/imagenes/*; do
+	[ -f "$Imagen" ] || continue
+	case $Imagen in
+		$CORPUS/fat12_catedra.bin|$BENCH/imagenes/*)	ConArbol=0 ;;
+		*)						ConArbol=1 ;;
+	esac
+	for Carga in superbloque dir-profundo cat-grande recorrido recorrido-find; do
+		Medida=$(escribir_carga $Carga "$TRABAJO/tests.txt" $ConArbol)
+		[ -n "$Medida" ] || continue
+		set -- $Medida
+		Ops=$1
+		Bytes=$2
+
+		# tpfs siempre, tpfs_ref sólo con los comandos que conoce
+		Tpfs=$(medir tpfs "$Imagen")
+		if [ $Carga != recorrido-find ]; then
+			Ref=$(medir tpfs_ref "$Imagen")
+			cmp -s "$TRABAJO/tpfs.out" "$TRABAJO/tpfs_ref.out" && Identicos=true || Identicos=false
+			JsonRef=$(json_medicion "$Ref" $Ops $Bytes)
+		else
+			Ref="- - -"
+			Identicos=null
+			JsonRef=null
+		fi
+
+		# Guardar
+		[ $Primero = 1 ] || echo "," >> "$Json"
+		Primero=0
+		printf '    {"imagen": "%s", "carga": "%s", "operaciones": %d, "bytes": %d, "tpfs": %s, "tpfs_ref": %s, "salidas_identicas": %s}' \
+		       "$(basename "$Imagen")" $Carga $Ops $Bytes "$(json_medicion "$Tpfs" $Ops $Bytes)" "$JsonRef" $Identicos >> "$Json"
+
+		# Mostrar
+		echo "$(basename "$Imagen") $Carga $Tpfs $Ref $Ops $Bytes $Identicos" | awk '
+			function ops(s) { return (s=="-") ? "-" : (s>0 ? sprintf("%.1f", $9/s) : "0") }
+			function mb(s) { return (s=="-" || $10==0 || s<=0) ? "-" : sprintf("%.1f", $10/s/1000000) }
+			{ printf "%-22s %-15s %12s %10s %10s %12s %10s %10s  %s\n", $1, $2, ops($3), mb($3), $4, ops($6), mb($6), $7,
+				 ($11=="true") ? "idénticas" : (($11=="false") ? "DISTINTAS" : "-") }'
+	done
+done
+{
+	echo
+	echo "  ]"
+	echo "}"
+} >> "$Json"
+echo "Resultados en $Json"
@@ -0,0 +1,105 @@
+﻿#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "unistd.h"
+#include "fcntl.h"
+#include "time.h"
+#include "sys/wait.h"
+#include "sys/resource.h"
+#include <vector>
+#include <algorithm>
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *								 Correr									*
+ *																	*
+ * OBJETIVO: Esta función ejecuta un comando una vez, con stdout a un archivo y stderr descartado.					*
+ *																	*
+ * ENTRADA: Salida: Archivo donde queda lo que el comando escribe por stdout.								*
+ *	    Argumentos: Comando y sus parámetros, terminados en NULL.									*
+ *																	*
+ * SALIDA: En el nombre de la función el código de salida del comando (-1 si no se pudo ejecutar).					*
+ *	   Segundos: Tiempo de reloj que tardó.												*
+ *	   RSSMaximo: Memoria residente máxima, en KB.											*
+ *																	*
+ ****************************************************************************************************************************************/
+static int Correr(const char *Salida, char **Argumentos, double &Segundos, long &RSSMaximo)
+{
+struct timespec	Inicio, Fin;
+struct rusage	Uso;
+pid_t		Pid;
+int		Estado, Fd;
+
+clock_gettime(CLOCK_MONOTONIC, &Inicio);
+if ( (Pid=fork()) == 0 )
+    {
+	/* Hijo: redirigir y ejecutar */
+	if ( (Fd=open(Salida, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0 )
+		_exit(127);
+	dup2(Fd, STDOUT_FILENO);
+	close(Fd);
+	if ( (Fd=open("/dev/null", O_WRONLY)) >= 0 )
+	    {
+		dup2(Fd, STDERR_FILENO);
+		close(Fd);
+	    }
+	execv(Argumentos[0], Argumentos);
+	_exit(127);
+    }
+if ( (Pid<0) || (wait4(Pid, &Estado, 0, &Uso)!=Pid) )
+	return(-1);
+clock_gettime(CLOCK_MONOTONIC, &Fin);
+
+/* Devolver lo medido */
+Segundos=(Fin.tv_sec-Inicio.tv_sec)+(Fin.tv_nsec-Inicio.tv_nsec)/1e9;
+RSSMaximo=Uso.ru_maxrss;
+return(WIFEXITED(Estado) ? WEXITSTATUS(Estado) : -1);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *								  main									*
+ *																	*
+ * OBJETIVO: Medir un comando del benchmark: uso "medir <repeticiones> <archivo de salida> <ejecutable> [parámetros...]".		*
+ *																	*
+ * ENTRADA: Parámetros de la línea de comandos.												*
+ *																	*
+ * SALIDA: Imprime en una línea la mediana de los segundos, el RSS máximo en KB y el código de salida de la última corrida.		*
+ *																	*
+ * OBSERVACIONES: La salida de la última corrida queda en el archivo para compararla con la del programa de referencia.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int main(int argc, char *argv[])
+{
+std::vector<double>	Tiempos;
+double			Segundos;
+long			RSS, RSSMaximo;
+int			Repeticiones, i, CodSalida;
+
+/* Validar los parámetros */
+if ( (argc<4) || ((Repeticiones=atoi(argv[1]))<1) )
+    {
+	fprintf(stderr, "Uso: %s <repeticiones> <archivo de salida> <ejecutable> [parámetros...]\n", argv[0]);
+	return(1);
+    }
+
+/* Correrlo las veces pedidas */
+RSSMaximo=0;
+CodSalida=-1;
+for (i=0; i<Repeticiones; i++)
+    {
+	Segundos=0;
+	RSS=0;
+	CodSalida=Correr(argv[2], argv+3, Segundos, RSS);
+	Tiempos.push_back(Segundos);
+	if (RSS>RSSMaximo)
+		RSSMaximo=RSS;
+    }
+
+/* Informar la mediana, que no se ve afectada por alguna corrida aislada más lenta */
+std::sort(Tiempos.begin(), Tiempos.end());
+printf("%.6f %ld %d\n", Tiempos[Tiempos.size()/2], RSSMaximo, CodSalida);
+return(0);
+}
\ No newline at end of file
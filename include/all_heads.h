@@ -3,23 +3,55 @@
 
 /* Includes del compilador */
 #include "sys/ioctl.h"
+#include "sys/mman.h"
 #include "stdio.h"
 #include "stdlib.h"
+#include "stdarg.h"
 #include "limits.h"
 #include "unistd.h"
 #include "string.h"
 #include "math.h"
 #include "time.h"
+#include "sys/syscall.h"
+#include "dirent.h"
 #include "iconv.h"
+#include "fnmatch.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include "immintrin.h"
+#endif
 #include <string>
 #include <vector>
+#include <list>
+#include <map>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
 
 /* Includes del proyecto */
+#include "formateador_fechas.h"
 #include "driver_base.h"
+#include "lote_entradas.h"
+#include "pool_hilos.h"
+#include "recorredor_arbol.h"
+#include "extractor_arbol.h"
+#include "fuente_sectores.h"
+#include "fuente_asincronica.h"
+#include "salida.h"
+#include "medidor_comandos.h"
+#include "codificador_hexa.h"
+#include "emisor_registros.h"
 #include "driver_fat.h"
 #include "driver_ext.h"
 #include "driver_ntfs.h"
+#include "registro_drivers.h"
 #include "analizadorfs.h"
+#include "lote_imagenes.h"
 #include "main.h"
 
 #endif
@@ -6,6 +6,12 @@
  *     Constantes	*
  *			*
  ************************/
+/* Tamaño de los tramos en que se lee un archivo para mostrarlo (múltiplo de cualquier ancho de volcado y del bloque del emisor) */
+#define	LECTURA_TAM_BLOQUE		(768*1024)
+
+/* Cantidad de entradas de un directorio que se juntan en el lote antes de mostrarlas */
+#define	DIR_ENTRADAS_POR_LOTE		256
+
 
 /********************************
  *				*
@@ -19,20 +25,44 @@ public:
 	virtual				~TAnalizadorFS();
 	
 	int				Ejecutar(const char *Ruta);
+	void				UsarCacheBloques(__u64 Presupuesto);
+	void				UsarSalida(FILE *Archivo);
+	void				UsarFormato(TFormatoSalida Formato);
+	void				UsarHilos(unsigned NroHilos);
+	void				UsarMetricas(bool Activar);
 
 protected:
 	unsigned			PrintWidth;
-	unsigned			LongitudDiskData;
-	const unsigned char		*DiskData;
+	TSalida				*Salida;
+	TSalida				*Mensajes;
+	TEmisorRegistros		*Emisor;
+	TMedidorComandos		*Medidor;
+	TFuenteSectores			*FuenteSectores;
+	__u64				PresupuestoCache;
+	unsigned			HilosRecorrido;
 	TDriverBase			*DriverFS;
+	TRegistroDrivers		RegistroDrivers;
+	TLoteEntradas			LoteDirectorio;
+	TEntradaDirectorio		EntradaLote;
 	
+	virtual int			AnalizarImagen(const char *Ruta);
 	virtual int 			EjecutarTests();
+	virtual int			DetectarFilesystem(void);
 
 	virtual int			CargarImagen(const char *Ruta);
+	virtual int			MapearImagen(FILE *f, off_t Longitud);
+	virtual int			AbrirImagenConCache(FILE *&f, off_t Longitud);
+	virtual int			LeerImagen(FILE *f);
 	virtual void			BorrarTodoYReinicializar(void);
 	
 	virtual int			MostrarContenidoDirectorio(const char *Path);
+	virtual void			MostrarLoteDirectorio(const char *Path, bool &Encabezado);
 	virtual int			MostrarContenidoArchivo(const char *Path);
+	virtual int			MostrarMapaArchivo(const char *Path);
+	virtual int			MostrarDatosArchivo(const char *Path);
+	virtual int			BuscarEnArbol(const char *Path, const char *Patron);
+	virtual int			MostrarEspacioArbol(const char *Path);
+	virtual int			ExtraerArbol(const char *Path, const char *Destino);
 };
 
 #endif
@@ -0,0 +1,33 @@
+﻿#ifndef	__CODIFICADOR_HEXA__H__
+#define	__CODIFICADOR_HEXA__H__
+
+/************************
+ *			*
+ *        Tipos		*
+ *			*
+ ************************/
+/* Kernel que convierte bytes a su columna hexa ("XX " por byte) y a su columna de caracteres imprimibles */
+typedef	void				(*TCodificarFila)(const unsigned char *Datos, unsigned Longitud, char *Hexa, char *Caracteres);
+
+
+/********************************
+ *				*
+ *   Clase TCodificadorHexa	*
+ *				*
+ ********************************/
+/* Codificación de las filas de un volcado hexa, con kernels vectoriales elegidos según el procesador */
+class TCodificadorHexa
+{
+public:
+	static void			CodificarFila(const unsigned char *Datos, unsigned Longitud, char *Hexa, char *Caracteres);
+
+protected:
+	static TCodificarFila		ElegirKernel(void);
+	static void			CodificarEscalar(const unsigned char *Datos, unsigned Longitud, char *Hexa, char *Caracteres);
+#if defined(__x86_64__) || defined(__i386__)
+	static void			CodificarSSSE3(const unsigned char *Datos, unsigned Longitud, char *Hexa, char *Caracteres);
+	static void			CodificarAVX2(const unsigned char *Datos, unsigned Longitud, char *Hexa, char *Caracteres);
+#endif
+};
+
+#endif
@@ -24,8 +24,15 @@ typedef	unsigned int		__u32;
 typedef	long long		__le64;
 typedef	unsigned long long	__u64;
 
-/* Clase que utiliza los drivers derivados de esta clase */
+/* Clases que utilizan los drivers derivados de esta clase */
 class TAnalizadorFS;
+class TRecorredorArbol;
+class TExtractorArbol;
+
+/* Origen de los datos de la imágen */
+class TFuenteSectores;
+class TSalida;
+struct TRangoLectura;
 
 
 /************************
@@ -111,7 +118,7 @@ typedef	struct
 	/* Datos del superbloque */
 	TipoFilsystem			TipoFilesystem;
 	int				BytesPorSector;
-	int				NumeroDeClusters;
+	__u64				NumeroDeClusters;
 	int				BytesPorCluster;
 
 	class
@@ -124,6 +131,12 @@ typedef	struct
     }	TDatosFS;
 
 
+/* Tamaño de sector que se asume mientras el driver no haya completado DatosFS.BytesPorSector */
+#define	SECTOR_TAM_MINIMO		512
+
+/* Tamaño máximo de cada escritura al exportar un archivo al host */
+#define	EXPORTAR_TAM_TRAMO		(4*1024*1024)
+
 /* Flags de una entrada de directorio */
 #define	fedSOLO_LECTURA			0x00000001
 #define	fedOCULTO			0x00000002
@@ -174,38 +187,130 @@ typedef struct
 	    }				DatosEspecificos;
     }	TEntradaDirectorio;
 
+/* Tramo de un archivo y dónde está en la imágen (los huecos de un archivo disperso no ocupan lugar en la imágen) */
+typedef	struct
+    {
+	__u64				OffsetArchivo;
+	__u64				OffsetImagen;
+	__u64				Longitud;
+	bool				Hueco;
+    }	TExtentArchivo;
+
+/* Archivo o directorio ya ubicado por TDriverBase::Abrir(), para operar sobre él sin volver a resolver la ruta */
+typedef	struct
+    {
+	unsigned			Flags;
+	__u64				Bytes;
+
+	union
+	    {
+		TEntradaFSFAT		FAT;
+		TEntradaFSEXT		EXT;
+		TEntradaFSNTFS		NTFS;
+	    }				DatosEspecificos;
+    }	TManejadorArchivo;
+
+/* Lectura acumulada de la imágen desde que se creó el driver */
+typedef	struct
+    {
+	__u64				Sectores;
+	__u64				Bytes;
+    }	TContadoresDriver;
+
+/* Función a la que llama el driver por cada entrada que decodifica al recorrer un directorio (devuelve false para cortar el recorrido) */
+typedef	std::function<bool(const TEntradaDirectorio &Entrada)>	TVisitanteDirectorio;
+
 
 /********************************
  *				*
  *      Clase TDriverBase	*
  *				*
  ********************************/
+class TSectorFijado;
+
 class TDriverBase
 {
 public:
-					TDriverBase(const unsigned char *DiskData, unsigned LongitudDiskData);
+					TDriverBase(TFuenteSectores *Fuente);
 	virtual				~TDriverBase();
 	
 protected:
 	TDatosFS			DatosFS;
 
 	virtual const unsigned char	*PunteroASector(__u64 NroSector);
+	virtual void			SoltarSector(const unsigned char *Puntero);
+	virtual int			LeerRangos(TRangoLectura *Rangos, unsigned NroRangos);
+	virtual int 			ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas);
+
+	/* Lo mismo que con un manejador, pero resolviendo la ruta en cada llamada */
+	int				AbrirArchivo(const char *Path, TManejadorArchivo &Manejador);
+	int				RecorrerDirectorio(const char *Path, const TVisitanteDirectorio &Visitante);
+	int 				LeerArchivo(const char *Path, unsigned char *&Data, __u64 &DataLen);
+	int 				LeerArchivo(const TManejadorArchivo &Manejador, unsigned char *&Data, __u64 &DataLen);
+	int				LeerRangoArchivo(const char *Path, __u64 Offset, __u64 Longitud, unsigned char *Destino, __u64 &Leidos, __u64 &TamanoArchivo);
+	int				MapearArchivo(const char *Path, std::vector<TExtentArchivo> &Extents);
+	int				Stat(const char *Path, TEntradaDirectorio &Entrada);
+
+	/* Para recorrer un árbol sin resolver la ruta de cada directorio */
+	void				ManejadorEntrada(const TEntradaDirectorio &Entrada, TManejadorArchivo &Manejador);
+	__u64				Identificador(const TManejadorArchivo &Manejador);
+	bool				AdmiteHilos(void);
+	void				LeerContadores(TContadoresDriver &Contadores);
+
+	/* Para copiar un archivo al host sin levantarlo entero a memoria */
+	int				ExportarArchivo(const TManejadorArchivo &Manejador, FILE *Destino);
 	
 	/* Funciones a implementar por el alumno */
 	virtual int			LevantarDatosSuperbloque() = 0;
-	virtual int 			ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas) = 0;
-	virtual int 			LeerArchivo(const char *Path, unsigned char *&Data, unsigned &DataLen) = 0;
+	virtual int			Abrir(const char *Path, TManejadorArchivo &Manejador) = 0;
+	virtual int			RecorrerDirectorio(const TManejadorArchivo &Manejador, const TVisitanteDirectorio &Visitante) = 0;
+	virtual int			LeerRangoArchivo(const TManejadorArchivo &Manejador, __u64 Offset, __u64 Longitud, unsigned char *Destino, __u64 &Leidos) = 0;
+	virtual int			MapearArchivo(const TManejadorArchivo &Manejador, std::vector<TExtentArchivo> &Extents) = 0;
+	virtual int			Stat(const TManejadorArchivo &Manejador, TEntradaDirectorio &Entrada) = 0;
 
 private:
-	unsigned			LongitudDiskData;
-	const unsigned char		*DiskData;
+	TFuenteSectores			*Fuente;
+	TSalida				*Salida;
+	std::atomic<__u64>		SectoresAccedidos;
+	std::atomic<__u64>		BytesCopiados;
+	TFormateadorFechas		FormateadorFechas;
 
 	virtual int			MostrarDatosSuperbloque(void);
-	virtual int			MostrarDatosDirectorio(std::vector<TEntradaDirectorio> &Entradas);
-	virtual void 			PrintBuffer(const unsigned char *Buffer, unsigned BufferLen, unsigned BytesPorLinea);
+	virtual void			MostrarEncabezadoDirectorio(void);
+	virtual void			MostrarEntradaDirectorio(const TEntradaDirectorio &Entrada);
+	virtual void			MostrarFecha(time_t Fecha);
+	virtual void 			PrintBuffer(const unsigned char *Buffer, __u64 BufferLen, unsigned BytesPorLinea, __u64 Base);
 
 	
 	friend				TAnalizadorFS;
+	friend				TRecorredorArbol;
+	friend				TExtractorArbol;
+	friend				TSectorFijado;
+};
+
+
+/********************************
+ *				*
+ *     Clase TSectorFijado	*
+ *				*
+ ********************************/
+/* Puntero a un sector de la imágen que se suelta solo al salir de alcance, para no olvidar SoltarSector() en ningún return */
+class TSectorFijado
+{
+public:
+					TSectorFijado();
+	virtual				~TSectorFijado();
+
+	const unsigned char		*Fijar(TDriverBase *Driver, __u64 NroSector);
+	void				Soltar(void);
+
+protected:
+	TDriverBase			*Driver;
+	const unsigned char		*Puntero;
+
+private:
+					TSectorFijado(const TSectorFijado &);
+	TSectorFijado			&operator=(const TSectorFijado &);
 };
 
 #endif
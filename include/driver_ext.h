@@ -9,6 +9,12 @@
 /* Posibles códigos de error */
 #define	CODERROR_FEATURE_DESCONOCIDO	(CODERROR_ALUMNO	- 101)
 
+/* Cantidad máxima de inodes decodificados que se guardan en memoria */
+#define	EXT_CACHE_INODES		4096
+
+/* Cantidad máxima de búsquedas de nombres (directorio padre + nombre) que se guardan en memoria */
+#define	EXT_CACHE_DENTRIES		8192
+
 /* Valor mínimo */
 #define	min(a, b)	(((a)<(b))?a:b)
 
@@ -49,6 +55,22 @@
 #define EXT4_FEATURE_RO_COMPAT_BIGALLOC		0x0200
 #define EXT4_FEATURE_RO_COMPAT_METADATA_CSUM	0x0400
 
+/* Incompat features que sabemos leer (meta_bg cambia dónde está la GDT, inline_data y compression dónde están los datos) */
+#define	EXT_FEATURE_INCOMPAT_SOPORTADAS		(EXT2_FEATURE_INCOMPAT_FILETYPE | EXT3_FEATURE_INCOMPAT_RECOVER | EXT4_FEATURE_INCOMPAT_EXTENTS |	\
+						 EXT4_FEATURE_INCOMPAT_64BIT | EXT4_FEATURE_INCOMPAT_MMP | EXT4_FEATURE_INCOMPAT_FLEX_BG |	\
+						 EXT4_FEATURE_INCOMPAT_EA_INODE | EXT4_FEATURE_INCOMPAT_BG_USE_META_CSUM |			\
+						 EXT4_FEATURE_INCOMPAT_LARGEDIR)
+
+/* Features que sólo tiene EXT4 (con alguna de ellas el filesystem es EXT4 y no EXT2/EXT3) */
+#define	EXT4_FEATURE_INCOMPAT_PROPIAS		(EXT4_FEATURE_INCOMPAT_EXTENTS | EXT4_FEATURE_INCOMPAT_64BIT | EXT4_FEATURE_INCOMPAT_MMP |	\
+						 EXT4_FEATURE_INCOMPAT_FLEX_BG | EXT4_FEATURE_INCOMPAT_EA_INODE |				\
+						 EXT4_FEATURE_INCOMPAT_BG_USE_META_CSUM | EXT4_FEATURE_INCOMPAT_LARGEDIR |			\
+						 EXT4_FEATURE_INCOMPAT_INLINE_DATA)
+#define	EXT4_FEATURE_RO_COMPAT_PROPIAS		(EXT4_FEATURE_RO_COMPAT_HUGE_FILE | EXT4_FEATURE_RO_COMPAT_GDT_CSUM |				\
+						 EXT4_FEATURE_RO_COMPAT_DIR_NLINK | EXT4_FEATURE_RO_COMPAT_EXTRA_ISIZE |			\
+						 EXT4_FEATURE_RO_COMPAT_QUOTA | EXT4_FEATURE_RO_COMPAT_BIGALLOC |				\
+						 EXT4_FEATURE_RO_COMPAT_METADATA_CSUM)
+
 /* Números de Index Nodes reservados (sacados de ext4.h) */
 #define	EXT_BAD_INO		 1	/* Bad blocks inode */
 #define EXT_ROOT_INO		 2	/* Root inode */
@@ -80,6 +102,20 @@
 #define EXT3_INDEX_FL			0x00001000
 #define EXT4_EXTENTS_FL			0x00080000
 
+/* Árbol de extents (sacado de ext4_extents.h) */
+#define	EXT4_EXT_MAGIC			0xF30A
+#define	EXT4_EXT_INIT_MAX_LEN		32768	/* ee_len mayor que esto es un extent no inicializado (se lee como ceros) */
+#define	EXT4_EXT_MAX_PROFUNDIDAD	5
+
+/* Directorios indexados con HTree (sacados de ext4.h) */
+#define	DX_HASH_LEGACY			0
+#define	DX_HASH_HALF_MD4		1
+#define	DX_HASH_TEA			2
+#define	DX_HASH_SIN_SIGNO		3	/* Se suma a los anteriores si el superbloque tiene EXT2_FLAGS_UNSIGNED_HASH */
+#define	EXT2_FLAGS_UNSIGNED_HASH	0x0002
+#define	EXT_HTREE_MAX_NIVELES		3	/* Raíz y hasta dos niveles de nodos (tres con largedir) */
+#define	EXT_HTREE_MASCARA_BLOQUE	0x0FFFFFFF
+
 
 /************************
  *			*
@@ -234,6 +270,40 @@ typedef struct __attribute__((packed))
 	__le16		ei_unused;
     }	TExtentIndexEXT4;
 
+/* Datos de la raíz de un HTree, después de las entradas "." y ".." del primer bloque del directorio (sacado de ext4.h) */
+typedef struct __attribute__((packed))
+    {
+	__le32		reserved_zero;
+	__u8		hash_version;
+	__u8		info_length;	/* 8 */
+	__u8		indirect_levels;
+	__u8		unused_flags;
+    }	TDxRaizEXT;
+
+/* Entrada de un nodo del HTree: en la primera, en lugar del hash están limit y count (2 bytes cada uno) */
+typedef struct __attribute__((packed))
+    {
+	__le32		hash;
+	__le32		block;		/* Bloque lógico dentro del directorio */
+    }	TDxEntradaEXT;
+
+/* Función a la que llama RecorrerEntradas() por cada entrada usada de un directorio: inode, nombre (sin '\0') y su longitud */
+typedef std::function<bool(unsigned inode_entry, const char *name, unsigned name_len)> TVisitanteEntradasEXT;
+
+/* Inode ya decodificado, guardado en la cache de TDriverEXT */
+typedef struct
+    {
+	unsigned		nro_inode;
+	TINodeEXT		inode;
+    }	TINodeCacheEXT;
+
+/* Resultado de buscar un nombre en un directorio: clave (inode del padre y nombre) e inode hallado (0 si no existe) */
+typedef struct
+    {
+	std::string		clave;
+	unsigned		nro_inode;
+    }	TDentryCacheEXT;
+
 
 
 /********************************
@@ -244,14 +314,55 @@ typedef struct __attribute__((packed))
 class TDriverEXT : public TDriverBase
 {
 public:
-					TDriverEXT(const unsigned char *DiskData, unsigned LongitudDiskData);
+					TDriverEXT(TFuenteSectores *Fuente);
 	virtual				~TDriverEXT();
 
+	static bool			Sondear(const unsigned char *Inicio, unsigned Longitud);
+	static TDriverBase		*Crear(TFuenteSectores *Fuente);
+
 protected:
 	/* Funciones a implementar por el alumno */
 	virtual int			LevantarDatosSuperbloque();
-	virtual int 			ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas);
-	virtual int 			LeerArchivo(const char *Path, unsigned char *&Data, unsigned &DataLen);
+	virtual int			Abrir(const char *Path, TManejadorArchivo &Manejador);
+	virtual int			RecorrerDirectorio(const TManejadorArchivo &Manejador, const TVisitanteDirectorio &Visitante);
+	virtual int			LeerRangoArchivo(const TManejadorArchivo &Manejador, __u64 Offset, __u64 Longitud, unsigned char *Destino, __u64 &Leidos);
+	virtual int			MapearArchivo(const TManejadorArchivo &Manejador, std::vector<TExtentArchivo> &Extents);
+	virtual int			Stat(const TManejadorArchivo &Manejador, TEntradaDirectorio &Entrada);
+
+	/* Cache LRU de inodes decodificados (la usan varios hilos a la vez al recorrer árboles) */
+	std::mutex			cache_mutex;
+	std::list<TINodeCacheEXT>	cache_inodes;
+	std::unordered_map<unsigned, std::list<TINodeCacheEXT>::iterator>	cache_indice;
+
+	/* Cache LRU de nombres ya buscados, incluidos los que no existen */
+	std::mutex			dentries_mutex;
+	std::list<TDentryCacheEXT>	cache_dentries;
+	std::unordered_map<std::string, std::list<TDentryCacheEXT>::iterator>	dentries_indice;
+
+	/* Semilla y tipo de char de los hash de los directorios indexados */
+	unsigned			hash_semilla[4];
+	bool				hash_sin_signo;
+
+	/* Auxiliares */
+	virtual int			LeerINode(unsigned nro_inode, TINodeEXT &inode, int cod_inexistente);
+	virtual int			LeerINodeTabla(unsigned nro_inode, TINodeEXT &inode, int cod_inexistente);
+	virtual void			ArmarEntrada(unsigned nro_inode, const TINodeEXT &inode, TEntradaDirectorio &e);
+	virtual int			BuscarEnDirectorio(unsigned nro_dir, const TINodeEXT &inode_dir, const char *nombre, unsigned long_nombre, unsigned &nro_inode);
+	virtual int			BuscarEnHTree(const TINodeEXT &inode_dir, const char *nombre, unsigned long_nombre, unsigned &nro_inode);
+	virtual unsigned		HashNombre(const char *nombre, unsigned long_nombre, unsigned version);
+	virtual const unsigned char	*PunteroABloqueDirectorio(const TINodeEXT &inode_dir, __u64 bloque, TSectorFijado &fijado);
+	virtual int			ResolverRuta(const char *Path, unsigned &nro_inode, TINodeEXT &inode, int cod_inexistente);
+	virtual int			LeerINodeArchivo(const TManejadorArchivo &Manejador, TINodeEXT &inode_file);
+	virtual int			RecorrerEntradas(const TINodeEXT &inode_dir, const TVisitanteEntradasEXT &visitante);
+	virtual bool			RecorrerBloqueEntradas(const unsigned char *bloque, unsigned longitud, const TVisitanteEntradasEXT &visitante);
+	virtual bool			TieneCopiaSuperbloque(unsigned grupo);
+	virtual int			ArmarExtents(const TINodeEXT &inode_file, __u64 Offset, __u64 Longitud, std::vector<TExtentArchivo> &Extents);
+	virtual int			ArmarExtentsBloques(const TINodeEXT &inode_file, __u64 Offset, __u64 Longitud, std::vector<TExtentArchivo> &Extents);
+	virtual int			ArmarExtentsIndirectos(unsigned bloque, unsigned nivel, __u64 base, __u64 primer_bloque, __u64 ultimo_bloque, __u64 Offset, __u64 Longitud, std::vector<TExtentArchivo> &Extents);
+	virtual int			ArmarExtentsArbol(const unsigned char *nodo, unsigned long_nodo, unsigned profundidad, __u64 primer_bloque, __u64 ultimo_bloque, __u64 Offset, __u64 Longitud, std::vector<TExtentArchivo> &Extents);
+	virtual void			AgregarBloques(std::vector<TExtentArchivo> &Extents, __u64 bloque, __u64 cantidad, __u64 fisico, __u64 Offset, __u64 Longitud);
+	virtual void			AgregarTramo(std::vector<TExtentArchivo> &Extents, __u64 OffsetArchivo, __u64 OffsetImagen, __u64 Longitud, bool Hueco);
+	virtual int			LeerBloques(const TINodeEXT &inode_file, __u64 Offset, __u64 Longitud, unsigned char *Destino);
 	
 };
 
@@ -305,14 +305,20 @@ protected:
 class TDriverNTFS : public TDriverBase
 {
 public:
-					TDriverNTFS(const unsigned char *DiskData, unsigned LongitudDiskData);
+					TDriverNTFS(TFuenteSectores *Fuente);
 	virtual				~TDriverNTFS();
 
+	static bool			Sondear(const unsigned char *Inicio, unsigned Longitud);
+	static TDriverBase		*Crear(TFuenteSectores *Fuente);
+
 protected:
 	/* Funciones a implementar por el alumno */
 	virtual int			LevantarDatosSuperbloque();
-	virtual int 			ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas);
-	virtual int 			LeerArchivo(const char *Path, unsigned char *&Data, unsigned &DataLen);
+	virtual int			Abrir(const char *Path, TManejadorArchivo &Manejador);
+	virtual int			RecorrerDirectorio(const TManejadorArchivo &Manejador, const TVisitanteDirectorio &Visitante);
+	virtual int			LeerRangoArchivo(const TManejadorArchivo &Manejador, __u64 Offset, __u64 Longitud, unsigned char *Destino, __u64 &Leidos);
+	virtual int			MapearArchivo(const TManejadorArchivo &Manejador, std::vector<TExtentArchivo> &Extents);
+	virtual int			Stat(const TManejadorArchivo &Manejador, TEntradaDirectorio &Entrada);
 };
 
 #endif
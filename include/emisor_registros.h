@@ -0,0 +1,129 @@
+﻿#ifndef	__EMISOR_REGISTROS__H__
+#define	__EMISOR_REGISTROS__H__
+
+/************************
+ *			*
+ *     Constantes	*
+ *			*
+ ************************/
+/* Cantidad de bytes de un archivo que van en cada registro de datos (múltiplo de 3 para que el base64 no lleve relleno intermedio) */
+#define	EMISOR_TAM_BLOQUE		(48*1024)
+
+/* Tipos de registro del formato binario */
+#define	regIMAGEN			1
+#define	regSUPERBLOQUE			2
+#define	regENTRADA			3
+#define	regARCHIVO			4
+#define	regDATOS			5
+#define	regERROR			6
+#define	regFIN				7
+#define	regEXTENT			8
+#define	regTOTALES			9
+
+
+/************************
+ *			*
+ *        Tipos		*
+ *			*
+ ************************/
+/* Formatos en que se puede emitir el informe */
+typedef	enum
+    {
+	fmtTEXTO			= 0,
+	fmtJSONL			= 1,
+	fmtBINARIO			= 2
+    }	TFormatoSalida;
+
+
+/********************************
+ *				*
+ *   Clase TEmisorRegistros	*
+ *				*
+ ********************************/
+/* Emite los resultados como registros independientes, a medida que se producen, para que los consuma otro programa */
+class TEmisorRegistros
+{
+public:
+					TEmisorRegistros(TSalida *Salida);
+	virtual				~TEmisorRegistros();
+
+	static TEmisorRegistros		*Crear(TFormatoSalida Formato, TSalida *Salida);
+
+	virtual void			Imagen(const char *Ruta) = 0;
+	virtual void			Superbloque(const TDatosFS &DatosFS) = 0;
+	virtual void			Entrada(const char *Directorio, TipoFilsystem Tipo, const TEntradaDirectorio &Entrada) = 0;
+	virtual void			Archivo(const char *Path, __u64 Longitud) = 0;
+	virtual void			Datos(const char *Path, __u64 Offset, const unsigned char *Datos, __u64 Longitud) = 0;
+	virtual void			Extent(const char *Path, const TExtentArchivo &Extent) = 0;
+	virtual void			Totales(const char *Path, const TTotalesArbol &Totales) = 0;
+	virtual void			Error(const char *Path, int CodError) = 0;
+	virtual void			Fin(int CodError) = 0;
+
+protected:
+	TSalida				*Salida;
+
+	static const char		*NombreFormato(TipoFilsystem Tipo);
+};
+
+
+/********************************
+ *				*
+ *     Clase TEmisorJSONL	*
+ *				*
+ ********************************/
+/* Un objeto JSON por línea (JSON Lines). Los datos de los archivos van en base64 */
+class TEmisorJSONL : public TEmisorRegistros
+{
+public:
+					TEmisorJSONL(TSalida *Salida);
+	virtual				~TEmisorJSONL();
+
+	virtual void			Imagen(const char *Ruta);
+	virtual void			Superbloque(const TDatosFS &DatosFS);
+	virtual void			Entrada(const char *Directorio, TipoFilsystem Tipo, const TEntradaDirectorio &Entrada);
+	virtual void			Archivo(const char *Path, __u64 Longitud);
+	virtual void			Datos(const char *Path, __u64 Offset, const unsigned char *Datos, __u64 Longitud);
+	virtual void			Extent(const char *Path, const TExtentArchivo &Extent);
+	virtual void			Totales(const char *Path, const TTotalesArbol &Totales);
+	virtual void			Error(const char *Path, int CodError);
+	virtual void			Fin(int CodError);
+
+protected:
+	virtual void			Texto(const char *Clave, const char *Valor, size_t Longitud);
+	virtual void			Numero(const char *Clave, __u64 Valor);
+	virtual void			Fecha(const char *Clave, time_t Valor);
+	virtual void			Base64(const unsigned char *Datos, unsigned Longitud);
+};
+
+
+/********************************
+ *				*
+ *    Clase TEmisorBinario	*
+ *				*
+ ********************************/
+/* Registros binarios: tipo (1 byte), longitud del resto (4 bytes) y los campos, todos los enteros en little endian */
+class TEmisorBinario : public TEmisorRegistros
+{
+public:
+					TEmisorBinario(TSalida *Salida);
+	virtual				~TEmisorBinario();
+
+	virtual void			Imagen(const char *Ruta);
+	virtual void			Superbloque(const TDatosFS &DatosFS);
+	virtual void			Entrada(const char *Directorio, TipoFilsystem Tipo, const TEntradaDirectorio &Entrada);
+	virtual void			Archivo(const char *Path, __u64 Longitud);
+	virtual void			Datos(const char *Path, __u64 Offset, const unsigned char *Datos, __u64 Longitud);
+	virtual void			Extent(const char *Path, const TExtentArchivo &Extent);
+	virtual void			Totales(const char *Path, const TTotalesArbol &Totales);
+	virtual void			Error(const char *Path, int CodError);
+	virtual void			Fin(int CodError);
+
+protected:
+	std::string			Registro;
+
+	virtual void			Entero(__u64 Valor, unsigned Bytes);
+	virtual void			Cadena(const char *Valor, size_t Longitud);
+	virtual void			Cerrar(unsigned char Tipo, const unsigned char *Cola, unsigned LongitudCola);
+};
+
+#endif
@@ -0,0 +1,64 @@
+﻿#ifndef	__EXTRACTOR_ARBOL__H__
+#define	__EXTRACTOR_ARBOL__H__
+
+/************************
+ *			*
+ *     Constantes	*
+ *			*
+ ************************/
+/* Directorio de trabajo para las llamadas *at() (sacado de fcntl.h, que no se puede incluir junto con driver_ext.h) */
+#define	EXTRACCION_AT_FDCWD		(-100)
+
+/* Permisos de los directorios que se crean en el host */
+#define	EXTRACCION_MODO_DIRECTORIO	0755
+
+
+/************************
+ *			*
+ *        Tipos		*
+ *			*
+ ************************/
+/* Archivo que no se pudo extraer: su ruta en la imágen y el código de error */
+typedef	struct
+    {
+	std::string			Ruta;
+	int				CodError;
+    }	TFalloExtraccion;
+
+
+/********************************
+ *				*
+ *   Clase TExtractorArbol	*
+ *				*
+ ********************************/
+/* Copia un árbol de directorios de la imágen a un directorio del host, varios archivos a la vez */
+class TExtractorArbol
+{
+public:
+					TExtractorArbol(TDriverBase *Driver, unsigned NroHilos);
+	virtual				~TExtractorArbol();
+
+	int				Extraer(const char *Ruta, const char *Destino, TTotalesArbol &Totales);
+	const std::vector<TFalloExtraccion>	&Fallos(void);
+
+protected:
+	TDriverBase			*Driver;
+	unsigned			NroHilos;
+	TLoteEntradas			Elementos;
+	std::vector<bool>		Repetidas;
+	std::unordered_map<__u64, unsigned>	Copiados;
+	std::vector<int>		ErroresCopia;
+	std::vector<TFalloExtraccion>	ListaFallos;
+	std::string			Raiz;
+	std::mutex			Mutex;
+
+	virtual int			CrearDirectorios(const char *Destino);
+	virtual void			CopiarArchivo(const char *Destino, unsigned Indice);
+	virtual void			EnlazarRepetidos(const char *Destino);
+	virtual void			FijarFechas(const char *Ruta, unsigned Indice);
+	virtual void			RutaHost(const char *Destino, unsigned Indice, std::string &Ruta);
+	virtual void			AgregarFallo(unsigned Indice, int CodError);
+	virtual void			AgregarFallo(const std::string &Relativa, int CodError);
+};
+
+#endif
@@ -0,0 +1,60 @@
+﻿#ifndef	__FORMATEADOR_FECHAS__H__
+#define	__FORMATEADOR_FECHAS__H__
+
+/************************
+ *			*
+ *     Constantes	*
+ *			*
+ ************************/
+/* Largo del texto "dd/mm/aaaa hh:mm" */
+#define	FECHAS_LARGO_TEXTO		16
+
+/* Entradas de la cache de desplazamientos UTC (una por hora) y de textos ya armados (uno por minuto). Potencias de 2 */
+#define	FECHAS_ENTRADAS_HORAS		256
+#define	FECHAS_ENTRADAS_MINUTOS		4096
+
+
+/************************
+ *			*
+ *     Estructuras	*
+ *			*
+ ************************/
+/* Desplazamiento de la hora local respecto de UTC durante una hora (si fue el mismo en toda la hora) */
+typedef	struct
+    {
+	long long			Hora;
+	long				Desplazamiento;
+	bool				Uniforme;
+    }	THoraDesplazamiento;
+
+/* Texto ya armado de un minuto (en hora local) */
+typedef	struct
+    {
+	long long			Minuto;
+	char				Texto[FECHAS_LARGO_TEXTO];
+    }	TMinutoFormateado;
+
+
+/********************************
+ *				*
+ *  Clase TFormateadorFechas	*
+ *				*
+ ********************************/
+/* Convierte fechas a "dd/mm/aaaa hh:mm" en hora local llamando a localtime_r() lo menos posible */
+class TFormateadorFechas
+{
+public:
+					TFormateadorFechas();
+	virtual				~TFormateadorFechas();
+
+	bool				Formatear(time_t Fecha, char *Texto);
+
+protected:
+	THoraDesplazamiento		Horas[FECHAS_ENTRADAS_HORAS];
+	TMinutoFormateado		Minutos[FECHAS_ENTRADAS_MINUTOS];
+
+	virtual bool			ObtenerDesplazamiento(time_t Fecha, long &Desplazamiento);
+	virtual bool			ArmarTexto(long long Minuto, char *Texto);
+};
+
+#endif
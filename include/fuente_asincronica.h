@@ -0,0 +1,146 @@
+﻿#ifndef	__FUENTE_ASINCRONICA__H__
+#define	__FUENTE_ASINCRONICA__H__
+
+/************************
+ *			*
+ *     Constantes	*
+ *			*
+ ************************/
+/* Cantidad de lecturas que puede haber en vuelo a la vez en io_uring */
+#define	URING_ENTRADAS			256
+
+/* Tamaño máximo de cada lectura individual (los rangos más grandes se parten) */
+#define	ASINC_MAX_LECTURA		(1024*1024)
+
+/* Cantidad de hilos del pool de pread() que se usa cuando el kernel no ofrece io_uring */
+#define	ASINC_HILOS_PREAD		8
+
+/* Constantes de io_uring (sacadas de linux/io_uring.h) */
+#define	URING_OP_READ			22
+#define	URING_OFF_SQ_RING		0ULL
+#define	URING_OFF_CQ_RING		0x8000000ULL
+#define	URING_OFF_SQES			0x10000000ULL
+#define	URING_ENTER_GETEVENTS		(1U << 0)
+#define	URING_FEAT_SINGLE_MMAP		(1U << 0)
+
+
+/************************
+ *			*
+ *     Estructuras	*
+ *			*
+ ************************/
+/* Offsets dentro del anillo de envíos (sacado de linux/io_uring.h) */
+typedef	struct
+    {
+	__u32		head;
+	__u32		tail;
+	__u32		ring_mask;
+	__u32		ring_entries;
+	__u32		flags;
+	__u32		dropped;
+	__u32		array;
+	__u32		resv1;
+	__u64		user_addr;
+    }	TUringOffsetsSQ;
+
+/* Offsets dentro del anillo de resultados (sacado de linux/io_uring.h) */
+typedef	struct
+    {
+	__u32		head;
+	__u32		tail;
+	__u32		ring_mask;
+	__u32		ring_entries;
+	__u32		overflow;
+	__u32		cqes;
+	__u32		flags;
+	__u32		resv1;
+	__u64		user_addr;
+    }	TUringOffsetsCQ;
+
+/* Parámetros de io_uring_setup (sacado de linux/io_uring.h) */
+typedef	struct
+    {
+	__u32		sq_entries;
+	__u32		cq_entries;
+	__u32		flags;
+	__u32		sq_thread_cpu;
+	__u32		sq_thread_idle;
+	__u32		features;
+	__u32		wq_fd;
+	__u32		resv[3];
+	TUringOffsetsSQ	sq_off;
+	TUringOffsetsCQ	cq_off;
+    }	TUringParametros;
+
+/* Pedido de E/S (sacado de linux/io_uring.h) */
+typedef	struct __attribute__((packed))
+    {
+	__u8		opcode;		/* type of operation for this sqe */
+	__u8		flags;		/* IOSQE_ flags */
+	__u16		ioprio;		/* ioprio for the request */
+	__le32		fd;		/* file descriptor to do IO on */
+	__u64		off;		/* offset into file */
+	__u64		addr;		/* pointer to buffer or iovecs */
+	__u32		len;		/* buffer size or number of iovecs */
+	__u32		rw_flags;
+	__u64		user_data;	/* data to be passed back at completion time */
+	__u16		buf_index;
+	__u16		personality;
+	__le32		splice_fd_in;
+	__u64		addr3;
+	__u64		pad2;
+    }	TUringSQE;
+
+/* Resultado de un pedido de E/S (sacado de linux/io_uring.h) */
+typedef	struct __attribute__((packed))
+    {
+	__u64		user_data;	/* sqe->data submission passed back */
+	__le32		res;		/* result code for this event */
+	__u32		flags;
+    }	TUringCQE;
+
+
+/********************************************
+ *					    *
+ *  Clase TFuenteSectoresAsincronica	    *
+ *					    *
+ ********************************************/
+/* Imágen leída bajo demanda, que atiende los lotes de rangos con muchas lecturas en vuelo (io_uring o un pool de pread) */
+class TFuenteSectoresAsincronica : public TFuenteSectoresArchivo
+{
+public:
+					TFuenteSectoresAsincronica(FILE *f, __u64 Longitud);
+	virtual				~TFuenteSectoresAsincronica();
+
+	virtual int			LeerRangos(TRangoLectura *Rangos, unsigned NroRangos);
+
+protected:
+	/* Estado de io_uring */
+	int				FdUring;
+	unsigned			Entradas;
+	void				*MapeoSQ;
+	size_t				LongitudMapeoSQ;
+	void				*MapeoCQ;
+	size_t				LongitudMapeoCQ;
+	TUringSQE			*SQEs;
+	size_t				LongitudSQEs;
+	unsigned			*SQHead;
+	unsigned			*SQTail;
+	unsigned			*SQMascara;
+	unsigned			*SQArreglo;
+	unsigned			*CQHead;
+	unsigned			*CQTail;
+	unsigned			*CQMascara;
+	TUringCQE			*CQEs;
+	std::mutex			MutexUring;
+
+	/* Alternativa cuando no hay io_uring */
+	TPoolHilos			*Pool;
+
+	virtual int			IniciarUring(void);
+	virtual void			FinalizarUring(void);
+	virtual int			LeerRangosUring(std::vector<TRangoLectura> &Tramos);
+	virtual int			LeerRangosPool(std::vector<TRangoLectura> &Tramos);
+};
+
+#endif
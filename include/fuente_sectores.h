@@ -0,0 +1,153 @@
+﻿#ifndef	__FUENTE_SECTORES__H__
+#define	__FUENTE_SECTORES__H__
+
+/************************
+ *			*
+ *     Constantes	*
+ *			*
+ ************************/
+/* Tamaño de cada bloque que guarda la cache (múltiplo de cualquier tamaño de cluster soportado) */
+#define	CACHE_TAM_BLOQUE		(64*1024)
+
+/* Cantidad mínima de bloques en la cache (para que la metadata que se usa seguido quepa entera) */
+#define	CACHE_MIN_BLOQUES		256
+
+/* Presupuesto por defecto de la cache, en bytes */
+#define	CACHE_PRESUPUESTO_DEFECTO	(64*1024*1024)
+
+
+/************************
+ *			*
+ *     Estructuras	*
+ *			*
+ ************************/
+/* Rango de la imágen a copiar a un buffer del llamador (para pedidos de lectura en lote) */
+typedef	struct TRangoLectura
+    {
+	__u64				Offset;
+	__u64				Longitud;
+	unsigned char			*Destino;
+    }	TRangoLectura;
+
+
+/********************************
+ *				*
+ *    Clase TFuenteSectores	*
+ *				*
+ ********************************/
+/* Origen de los datos de una imágen de disco. Los drivers acceden a la imágen sólo a través de esta interfaz */
+class TFuenteSectores
+{
+public:
+					TFuenteSectores();
+	virtual				~TFuenteSectores();
+
+	virtual __u64			Longitud(void);
+	virtual const unsigned char	*PunteroARango(__u64 Offset, unsigned Longitud);
+	virtual void			SoltarRango(const unsigned char *Puntero);
+	virtual int			Leer(__u64 Offset, __u64 Longitud, unsigned char *Destino);
+	virtual int			LeerRangos(TRangoLectura *Rangos, unsigned NroRangos);
+	virtual bool			Concurrente(void);
+	virtual bool			EnMemoria(void);
+
+protected:
+	__u64				LongitudImagen;
+};
+
+
+/****************************************
+ *					*
+ *  Clase TFuenteSectoresMemoria	*
+ *					*
+ ****************************************/
+/* Imágen levantada completa a un buffer alocado con malloc() */
+class TFuenteSectoresMemoria : public TFuenteSectores
+{
+public:
+					TFuenteSectoresMemoria(unsigned char *Datos, __u64 Longitud);
+	virtual				~TFuenteSectoresMemoria();
+
+	virtual const unsigned char	*PunteroARango(__u64 Offset, unsigned Longitud);
+	virtual int			Leer(__u64 Offset, __u64 Longitud, unsigned char *Destino);
+	virtual bool			Concurrente(void);
+	virtual bool			EnMemoria(void);
+
+protected:
+	unsigned char			*Datos;
+};
+
+
+/********************************
+ *				*
+ *   Clase TFuenteSectoresMMap	*
+ *				*
+ ********************************/
+/* Imágen mapeada en memoria de sólo lectura, el sistema operativo trae cada página recién cuando se la accede */
+class TFuenteSectoresMMap : public TFuenteSectoresMemoria
+{
+public:
+					TFuenteSectoresMMap(void *Mapeo, __u64 Longitud);
+	virtual				~TFuenteSectoresMMap();
+};
+
+
+/****************************************
+ *					*
+ *  Clase TFuenteSectoresArchivo	*
+ *					*
+ ****************************************/
+/* Imágen leída bajo demanda con pread(), no es direccionable por lo que se usa detrás de una TCacheBloques */
+class TFuenteSectoresArchivo : public TFuenteSectores
+{
+public:
+					TFuenteSectoresArchivo(FILE *f, __u64 Longitud);
+	virtual				~TFuenteSectoresArchivo();
+
+	virtual int			Leer(__u64 Offset, __u64 Longitud, unsigned char *Destino);
+
+protected:
+	FILE				*Archivo;
+};
+
+
+/********************************
+ *				*
+ *      Clase TCacheBloques	*
+ *				*
+ ********************************/
+/* Bloque alineado guardado en la cache */
+typedef	struct
+    {
+	__u64				Inicio;
+	unsigned			Longitud;
+	unsigned char			*Datos;
+	unsigned			Fijaciones;	/* Punteros entregados que todavía no se soltaron */
+	bool				Retirado;	/* Ya no está en el índice, se libera al soltarlo */
+    }	TBloqueCache;
+
+/* Cache LRU de bloques alineados, con presupuesto fijo de memoria, delante de cualquier otra fuente */
+class TCacheBloques : public TFuenteSectores
+{
+public:
+					TCacheBloques(TFuenteSectores *Origen, __u64 Presupuesto);
+	virtual				~TCacheBloques();
+
+	virtual const unsigned char	*PunteroARango(__u64 Offset, unsigned Longitud);
+	virtual void			SoltarRango(const unsigned char *Puntero);
+	virtual int			Leer(__u64 Offset, __u64 Longitud, unsigned char *Destino);
+	virtual int			LeerRangos(TRangoLectura *Rangos, unsigned NroRangos);
+
+protected:
+	TFuenteSectores			*Origen;
+	__u64				Presupuesto;
+	__u64				Ocupado;
+	std::list<TBloqueCache>		Bloques;
+	std::list<TBloqueCache>		Retirados;
+	std::unordered_map<__u64, std::list<TBloqueCache>::iterator>	Indice;
+	std::map<const unsigned char *, std::list<TBloqueCache>::iterator>	PorDatos;
+
+	virtual void			Desalojar(void);
+	virtual std::list<TBloqueCache>::iterator	Liberar(std::list<TBloqueCache> &Lista, std::list<TBloqueCache>::iterator Bloque);
+};
+
+#endif
@@ -0,0 +1,43 @@
+﻿#ifndef	__LOTE_ENTRADAS__H__
+#define	__LOTE_ENTRADAS__H__
+
+/********************************
+ *				*
+ *    Clase TLoteEntradas	*
+ *				*
+ ********************************/
+/* Lote de entradas de directorio guardado en forma compacta: los nombres van seguidos en un único buffer y cada campo fijo en su
+   propio vector. Vaciar() conserva la memoria, así que un lote reutilizado deja de alocar cuando alcanzó su tamaño de trabajo */
+class TLoteEntradas
+{
+public:
+					TLoteEntradas();
+	virtual				~TLoteEntradas();
+
+	void				Vaciar(void);
+	void				Agregar(const TEntradaDirectorio &Entrada);
+	void				Agregar(const TEntradaDirectorio &Entrada, const char *Nombre, unsigned LongitudNombre);
+	unsigned			Cantidad(void) const;
+
+	const char			*Nombre(unsigned Indice) const;
+	unsigned			LongitudNombre(unsigned Indice) const;
+	unsigned			Flags(unsigned Indice) const;
+	__u64				Bytes(unsigned Indice) const;
+	time_t				FechaCreacion(unsigned Indice) const;
+	time_t				FechaUltimoAcceso(unsigned Indice) const;
+	time_t				FechaUltimaModificacion(unsigned Indice) const;
+	void				Entrada(unsigned Indice, TEntradaDirectorio &Entrada) const;
+	void				Manejador(unsigned Indice, TManejadorArchivo &Manejador) const;
+
+protected:
+	std::vector<char>		Arena;
+	std::vector<unsigned>		Inicios;
+	std::vector<unsigned>		ListaFlags;
+	std::vector<__u64>		ListaBytes;
+	std::vector<time_t>		ListaFechasCreacion;
+	std::vector<time_t>		ListaFechasAcceso;
+	std::vector<time_t>		ListaFechasModificacion;
+	std::vector<unsigned char>	ListaEspecificos;
+};
+
+#endif
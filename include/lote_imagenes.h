@@ -0,0 +1,43 @@
+﻿#ifndef	__LOTE_IMAGENES__H__
+#define	__LOTE_IMAGENES__H__
+
+/********************************
+ *				*
+ *    Clase TLoteImagenes	*
+ *				*
+ ********************************/
+/* Analiza muchas imágenes en paralelo, un TAnalizadorFS por hilo, y emite los informes en el orden de la lista */
+class TLoteImagenes
+{
+public:
+					TLoteImagenes();
+	virtual				~TLoteImagenes();
+
+	int				CargarImagenes(const char *Ruta);
+	void				UsarCacheBloques(__u64 Presupuesto);
+	void				UsarHilos(unsigned NroHilos);
+	void				UsarFormato(TFormatoSalida Formato);
+	void				UsarMetricas(bool Activar);
+	int				Ejecutar(void);
+
+protected:
+	std::vector<std::string>	Rutas;
+	std::vector<std::string>	Informes;
+	std::vector<int>		Resultados;
+	std::vector<bool>		Terminados;
+	std::atomic<unsigned>		SiguienteImagen;
+	unsigned			SiguienteAEmitir;
+	std::mutex			MutexEmision;
+	__u64				PresupuestoCache;
+	unsigned			NroHilos;
+	TFormatoSalida			Formato;
+	bool				Metricas;
+
+	virtual int			CargarDirectorio(DIR *Directorio, const char *Ruta);
+	virtual int			CargarLista(const char *Ruta);
+	virtual void			Trabajar(void);
+	virtual int			AnalizarImagen(TAnalizadorFS &Analizador, unsigned Indice);
+	virtual void			Emitir(unsigned Indice);
+};
+
+#endif
@@ -22,6 +22,7 @@
 #define	CODERROR_FILESYSTEM_CORRUPTO		-12
 #define	CODERROR_DIRECTORIO_INEXISTENTE		-13
 #define	CODERROR_RUTA_NO_ABSOLUTA		-14
+#define	CODERROR_ESCRITURA_DISCO		-15
 
 #define	CODERROR_ALUMNO				-1000
 
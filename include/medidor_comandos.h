@@ -0,0 +1,50 @@
+﻿#ifndef	__MEDIDOR_COMANDOS__H__
+#define	__MEDIDOR_COMANDOS__H__
+
+/************************
+ *			*
+ *        Tipos		*
+ *			*
+ ************************/
+/* Lo que costó un comando */
+typedef	struct
+    {
+	__u64				Nanosegundos;
+	__u64				Sectores;
+	__u64				Bytes;
+	__u64				Alocaciones;
+    }	TMedicionComando;
+
+
+/********************************
+ *				*
+ *   Clase TMedidorComandos	*
+ *				*
+ ********************************/
+/* Mide tiempo, sectores accedidos, bytes copiados y alocaciones de cada comando de tests y resume los percentiles por tipo */
+class TMedidorComandos
+{
+public:
+					TMedidorComandos();
+	virtual				~TMedidorComandos();
+
+	void				Vaciar(void);
+	void				Empezar(const TContadoresDriver &Contadores);
+	void				Terminar(const char *Comando, const TContadoresDriver &Contadores, TSalida *Salida);
+	void				MostrarResumen(TSalida *Salida);
+
+	static std::atomic<__u64>	*CuentaDelHilo(void);
+	static void			UsarCuentaEnHilo(std::atomic<__u64> *Cuenta);
+
+protected:
+	struct timespec			Inicio;
+	TContadoresDriver		ContadoresInicio;
+	__u64				AlocacionesInicio;
+	std::atomic<__u64>		Alocaciones;
+	std::vector<std::string>	Comandos;
+	std::unordered_map<std::string, std::vector<TMedicionComando>>	Mediciones;
+
+	virtual __u64			Percentil(std::vector<__u64> &Valores, unsigned Porcentaje);
+};
+
+#endif
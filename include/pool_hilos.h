@@ -0,0 +1,47 @@
+﻿#ifndef	__POOL_HILOS__H__
+#define	__POOL_HILOS__H__
+
+/************************
+ *			*
+ *        Tipos		*
+ *			*
+ ************************/
+/* Tarea a ejecutar en paralelo, recibe el índice de la tarea */
+typedef	std::function<void(unsigned)>	TTareaPool;
+
+
+/********************************
+ *				*
+ *	 Clase TPoolHilos	*
+ *				*
+ ********************************/
+/* Conjunto fijo de hilos que ejecutan en paralelo las tareas 0..N-1 de un lote (el hilo que llama también trabaja) */
+class TPoolHilos
+{
+public:
+					TPoolHilos(unsigned NroHilos);
+	virtual				~TPoolHilos();
+
+	unsigned			NroHilos(void);
+	void				Ejecutar(unsigned NroTareas, const TTareaPool &Tarea);
+
+protected:
+	std::vector<std::thread>	Hilos;
+	std::mutex			Mutex;
+	std::mutex			MutexLote;
+	std::condition_variable		HayLote;
+	std::condition_variable		LoteTerminado;
+	const TTareaPool		*Tarea;
+	std::atomic<__u64>		*CuentaAlocaciones;
+	unsigned			NroTareas;
+	std::atomic<unsigned>		Siguiente;
+	unsigned			Terminadas;
+	unsigned			Activos;
+	unsigned			Generacion;
+	bool				Terminar;
+
+	void				Trabajar(void);
+	void				TomarTareas(const TTareaPool &Tarea, unsigned NroTareas, std::atomic<__u64> *CuentaAlocaciones);
+};
+
+#endif
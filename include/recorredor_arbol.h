@@ -0,0 +1,107 @@
+﻿#ifndef	__RECORREDOR_ARBOL__H__
+#define	__RECORREDOR_ARBOL__H__
+
+/************************
+ *			*
+ *     Constantes	*
+ *			*
+ ************************/
+/* Cantidad de partes del conjunto de objetos ya vistos (cada una con su mutex, para que los hilos no compitan por uno solo) */
+#define	RECORRIDO_PARTES_VISTOS		64
+
+
+/************************
+ *			*
+ *        Tipos		*
+ *			*
+ ************************/
+/* Totales de un subárbol */
+typedef	struct
+    {
+	__u64				Bytes;
+	__u64				Archivos;
+	__u64				Directorios;
+	__u64				Repetidos;
+    }	TTotalesArbol;
+
+/* Filtro estilo find: decide qué entradas se informan (no afecta lo que se recorre ni los totales) */
+typedef	std::function<bool(const char *Directorio, const TEntradaDirectorio &Entrada)>			TPredicadoArbol;
+
+/* Se llama con cada entrada que pasa el filtro (Repetida si es otro nombre de algo ya visto). Devuelve false para cortar el recorrido */
+typedef	std::function<bool(const char *Directorio, const TEntradaDirectorio &Entrada, bool Repetida)>	TVisitanteArbol;
+
+/* Se llama con los totales de cada directorio apenas se terminó de recorrer todo su subárbol (estilo du) */
+typedef	std::function<void(const char *Directorio, const TTotalesArbol &Totales)>			TResumenArbol;
+
+
+/********************************
+ *				*
+ *   Clase TRecorredorArbol	*
+ *				*
+ ********************************/
+/* Directorio pendiente o en curso. Vive hasta el final del recorrido */
+typedef	struct TNodoArbol
+    {
+	std::string			Ruta;
+	TManejadorArchivo		Manejador;
+	struct TNodoArbol		*Padre;
+	std::atomic<unsigned>		Pendientes;
+	std::atomic<__u64>		Bytes;
+	std::atomic<__u64>		Archivos;
+	std::atomic<__u64>		Directorios;
+	std::atomic<__u64>		Repetidos;
+    }	TNodoArbol;
+
+/* Cola de directorios de un hilo: el dueño toma del final y los demás le roban del principio */
+typedef	struct
+    {
+	std::mutex			Mutex;
+	std::deque<TNodoArbol *>	Nodos;
+	std::vector<TNodoArbol *>	Creados;
+    }	TColaRecorrido;
+
+/* Parte del conjunto de objetos ya vistos */
+typedef	struct
+    {
+	std::mutex			Mutex;
+	std::unordered_set<__u64>	Claves;
+    }	TParteVistos;
+
+/* Recorre un árbol de directorios de la imágen repartiendo los subdirectorios entre varios hilos */
+class TRecorredorArbol
+{
+public:
+					TRecorredorArbol(TDriverBase *Driver, unsigned NroHilos);
+	virtual				~TRecorredorArbol();
+
+	void				UsarPredicado(const TPredicadoArbol &Predicado);
+	void				UsarVisitante(const TVisitanteArbol &Visitante);
+	void				UsarResumen(const TResumenArbol &Resumen);
+	int				Recorrer(const char *Ruta, TTotalesArbol &Totales);
+
+	static bool			NombreValido(const std::string &Nombre);
+
+protected:
+	TDriverBase			*Driver;
+	unsigned			NroHilos;
+	TPredicadoArbol			Predicado;
+	TVisitanteArbol			Visitante;
+	TResumenArbol			Resumen;
+	std::mutex			MutexLlamadas;
+	TColaRecorrido			*Colas;
+	TParteVistos			Vistos[RECORRIDO_PARTES_VISTOS];
+	std::atomic<__u64>		NodosPendientes;
+	std::atomic<bool>		Cortar;
+	int				CodError;
+	TTotalesArbol			*Totales;
+
+	virtual void			Trabajar(unsigned Hilo);
+	virtual TNodoArbol		*Tomar(unsigned Hilo);
+	virtual void			Agregar(unsigned Hilo, TNodoArbol *Padre, const char *Ruta, const TManejadorArchivo &Manejador);
+	virtual void			ProcesarDirectorio(unsigned Hilo, TNodoArbol *Nodo);
+	virtual void			Completar(TNodoArbol *Nodo);
+	virtual bool			Visto(const TManejadorArchivo &Manejador);
+	virtual void			Liberar(void);
+};
+
+#endif
@@ -0,0 +1,54 @@
+﻿#ifndef	__REGISTRO_DRIVERS__H__
+#define	__REGISTRO_DRIVERS__H__
+
+/************************
+ *			*
+ *     Constantes	*
+ *			*
+ ************************/
+/* Bytes del comienzo de la imágen que reciben las funciones de sondeo (alcanza para el boot sector y el superbloque EXT) */
+#define	SONDEO_BYTES			4096
+
+
+/************************
+ *			*
+ *        Tipos		*
+ *			*
+ ************************/
+/* Revisa las firmas del comienzo de la imágen, sin alocar nada, y dice si el driver la reconoce */
+typedef	bool				(*TSondearDriver)(const unsigned char *Inicio, unsigned Longitud);
+
+/* Construye el driver sobre una fuente de sectores */
+typedef	TDriverBase			*(*TCrearDriver)(TFuenteSectores *Fuente);
+
+/* Driver registrado */
+typedef	struct
+    {
+	const char			*Nombre;
+	TSondearDriver			Sondear;
+	TCrearDriver			Crear;
+    }	TDriverRegistrado;
+
+
+/********************************
+ *				*
+ *    Clase TRegistroDrivers	*
+ *				*
+ ********************************/
+/* Lista ordenada de los drivers disponibles, con la firma que identifica a cada uno */
+class TRegistroDrivers
+{
+public:
+					TRegistroDrivers();
+	virtual				~TRegistroDrivers();
+
+	void				Registrar(const char *Nombre, TSondearDriver Sondear, TCrearDriver Crear);
+	unsigned			NroDrivers(void);
+	const TDriverRegistrado		&Driver(unsigned Indice);
+	int				LeerInicio(TFuenteSectores *Fuente, unsigned char *Inicio, unsigned &Longitud);
+
+protected:
+	std::vector<TDriverRegistrado>	Drivers;
+};
+
+#endif
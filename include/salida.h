@@ -0,0 +1,52 @@
+﻿#ifndef	__SALIDA__H__
+#define	__SALIDA__H__
+
+/************************
+ *			*
+ *     Constantes	*
+ *			*
+ ************************/
+/* Tamaño del buffer de salida (se vacía al archivo recién cuando se llena o cuando se pide) */
+#define	SALIDA_TAM_BUFFER		(1024*1024)
+
+
+/********************************
+ *				*
+ *	  Clase TSalida		*
+ *				*
+ ********************************/
+/* Buffer de salida con formateo propio, para que listados y volcados no hagan una llamada a stdio por campo */
+class TSalida
+{
+public:
+					TSalida(FILE *Archivo);
+	virtual				~TSalida();
+
+	void				CambiarArchivo(FILE *Archivo);
+	void				Vaciar(void);
+	int				Error(void);
+
+	void				Printf(const char *Formato, ...) __attribute__((format(printf, 2, 3)));
+	void				Cadena(const char *Texto);
+	void				Bytes(const void *Datos, size_t Longitud);
+	void				Repetir(char Caracter, unsigned Veces);
+	void				Decimal(__u64 Valor, unsigned Ancho);
+	void				Hexa(__u64 Valor, unsigned Ancho, bool Mayusculas);
+
+	/* Acceso directo al buffer para los ciclos que arman líneas enteras */
+	char				*Reservar(size_t Longitud)	{if (Usado+Longitud>Tamano) return(AgrandarYReservar(Longitud)); return(Buffer+Usado);};
+	void				Avanzar(size_t Longitud)	{Usado+=Longitud;};
+	void				Caracter(char c)		{if ( (Usado==Tamano) && (!AgrandarYReservar(1)) ) return; Buffer[Usado++]=c;};
+
+protected:
+	FILE				*Archivo;
+	char				*Buffer;
+	size_t				Tamano;
+	size_t				Usado;
+	int				CodError;
+
+	virtual int			Agrandar(size_t Longitud);
+	char				*AgrandarYReservar(size_t Longitud);
+};
+
+#endif
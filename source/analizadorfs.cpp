@@ -31,9 +31,19 @@ TAnalizadorFS::TAnalizadorFS()
 struct winsize WinSize;
 
 /* Inicialziar variables */
-LongitudDiskData=0;
-DiskData=NULL;
+FuenteSectores=NULL;
+PresupuestoCache=0;
+HilosRecorrido=0;
 DriverFS=NULL;
+Salida=new TSalida(stdout);
+Mensajes=Salida;
+Emisor=NULL;
+Medidor=NULL;
+
+/* Registrar los drivers, en el orden en que se prueban */
+RegistroDrivers.Registrar("FAT12/FAT16/FAT32", TDriverFAT::Sondear, TDriverFAT::Crear);
+RegistroDrivers.Registrar("EXT2/EXT3/EXT4", TDriverEXT::Sondear, TDriverEXT::Crear);
+RegistroDrivers.Registrar("NTFS", TDriverNTFS::Sondear, TDriverNTFS::Crear);
 
 /* Levantar el ancho de la pantalla */
 ioctl(STDOUT_FILENO, TIOCGWINSZ, &WinSize);
@@ -63,15 +73,14 @@ else
  ****************************************************************************************************************************************/
 TAnalizadorFS::~TAnalizadorFS()
 {
-/* Liberar el driver del filesystem si está cargado */
-if (DriverFS)
-    {
-	delete(DriverFS);
-	DriverFS=NULL;
-    }
-
 /* Liberar todos los recursos alocados */
 BorrarTodoYReinicializar();
+
+/* Liberar el medidor, el emisor de registros y los buffers de salida (los vacía antes) */
+UsarMetricas(false);
+UsarFormato(fmtTEXTO);
+delete Salida;
+Salida=NULL;
 }
 
 
@@ -90,43 +99,59 @@ int TAnalizadorFS::Ejecutar(const char *Ruta)
 {
 int	CodError;
 
+/* Analizar la imágen, encerrando sus registros entre el de apertura y el de cierre */
+if (Emisor)
+	Emisor->Imagen(Ruta);
+CodError=AnalizarImagen(Ruta);
+if (Emisor)
+	Emisor->Fin(CodError);
+
+/* Todo el informe se arma en el buffer de salida, escribirlo */
+Salida->Vaciar();
+if (Mensajes!=Salida)
+	Mensajes->Vaciar();
+
+/* Si faltó memoria para la salida el informe quedó incompleto */
+if (CodError==CODERROR_NINGUNO)
+	CodError=Salida->Error();
+if ( (CodError==CODERROR_NINGUNO) && (Mensajes!=Salida) )
+	CodError=Mensajes->Error();
+
+/* Salir */
+return(CodError);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TAnalizadorFS :: AnalizarImagen							*
+ *																	*
+ * OBJETIVO: Esta función carga la imágen, busca el driver adecuado, muestra el superbloque y ejecuta todos los tests.			*
+ *																	*
+ * ENTRADA: Ruta: Ruta al archivo binario a cargar.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::AnalizarImagen(const char *Ruta)
+{
+int	CodError;
+
 /* Cargar la imágen de disco */
-printf("Cargando imágen de disco ...\n");
+Mensajes->Printf("Cargando imágen de disco ...\n");
 if ( (CodError=CargarImagen(Ruta)) != CODERROR_NINGUNO)
 	return(CodError);
 
-/* Ver si la imágen es FAT */
-printf("Analizando imágen con driver FAT12/FAT16/FAT32 ...\n");
-DriverFS=new TDriverFAT(DiskData, LongitudDiskData);
-CodError=DriverFS->LevantarDatosSuperbloque();
-if ( (CodError==CODERROR_SUPERBLOQUE_INVALIDO) || (CodError==CODERROR_FILESYSTEM_DESCONOCIDO) )
-    {
-	/* No es FAT, ver si es EXT */
-	printf("ERROR: La imágen no es FAT12/FAT16/FAT32.\n");
-	delete DriverFS;
-
-	printf("Analizando imágen con driver EXT2/EXT3/EXT4 ...\n");
-	DriverFS=new TDriverEXT(DiskData, LongitudDiskData);
-	CodError=DriverFS->LevantarDatosSuperbloque();
-	if ( (CodError==CODERROR_SUPERBLOQUE_INVALIDO) || (CodError==CODERROR_FILESYSTEM_DESCONOCIDO) )
-	    {
-		/* No es FAT, ver si es EXT */
-		printf("ERROR: La imágen no es EXT2/EXT3/EXT4.\n");
-		delete DriverFS;
-
-		printf("Analizando imágen con driver NTFS ...\n");
-		DriverFS=new TDriverNTFS(DiskData, LongitudDiskData);
-		CodError=DriverFS->LevantarDatosSuperbloque();
-		if ( (CodError==CODERROR_SUPERBLOQUE_INVALIDO) || (CodError==CODERROR_FILESYSTEM_DESCONOCIDO) )
-			printf("ERROR: La imágen no es NTFS.\n");
-	    }
-    }
-if (CodError!=CODERROR_NINGUNO)
+/* Ver qué driver reconoce la imágen */
+if ( (CodError=DetectarFilesystem()) != CODERROR_NINGUNO)
 	return(CodError);
-printf("ÉXITO: Imágen válida.\n");
+Mensajes->Printf("ÉXITO: Imágen válida.\n");
 
 /* Mostrar los datos del Filesystem */
-DriverFS->MostrarDatosSuperbloque();
+if (Emisor)
+	Emisor->Superbloque(DriverFS->DatosFS);
+else
+	DriverFS->MostrarDatosSuperbloque();
 
 /* Ejecutar los tests */
 if ( (CodError=EjecutarTests()) != CODERROR_NINGUNO)
@@ -137,6 +162,155 @@ return(CODERROR_NINGUNO);
 }
 
 
+/****************************************************************************************************************************************
+ *																	*
+ *						   TAnalizadorFS :: DetectarFilesystem							*
+ *																	*
+ * OBJETIVO: Esta función determina el driver que corresponde a la imágen cargada y levanta con él el superbloque.			*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: El comienzo de la imágen se lee una sola vez y se le pasa a la función de sondeo de cada driver. Sólo se		*
+ *		  construye (y se levanta el superbloque completo con) el driver cuya firma coincide.					*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::DetectarFilesystem(void)
+{
+unsigned char	Inicio[SONDEO_BYTES];
+unsigned	Longitud, i;
+int		CodError;
+
+/* Levantar el comienzo de la imágen */
+if ( (CodError=RegistroDrivers.LeerInicio(FuenteSectores, Inicio, Longitud)) != CODERROR_NINGUNO)
+	return(CodError);
+
+/* Probar los drivers en orden */
+for(i=0;i<RegistroDrivers.NroDrivers();i++)
+    {
+	const TDriverRegistrado &Driver=RegistroDrivers.Driver(i);
+
+	/* Si la firma coincide, levantar el superbloque completo */
+	Mensajes->Printf("Analizando imágen con driver %s ...\n", Driver.Nombre);
+	if (Driver.Sondear(Inicio, Longitud))
+	    {
+		DriverFS=Driver.Crear(FuenteSectores);
+		DriverFS->Salida=Salida;
+		CodError=DriverFS->LevantarDatosSuperbloque();
+		if ( (CodError!=CODERROR_SUPERBLOQUE_INVALIDO) && (CodError!=CODERROR_FILESYSTEM_DESCONOCIDO) )
+			return(CodError);
+		delete DriverFS;
+		DriverFS=NULL;
+	    }
+	Mensajes->Printf("ERROR: La imágen no es %s.\n", Driver.Nombre);
+    }
+
+/* Ningún driver la reconoce */
+return(CODERROR_FILESYSTEM_DESCONOCIDO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TAnalizadorFS :: UsarCacheBloques							*
+ *																	*
+ * OBJETIVO: Esta función indica que las próximas imágenes no se mapeen sino que se lean bajo demanda a través de una cache de bloques.	*
+ *																	*
+ * ENTRADA: Presupuesto: Cantidad máxima de memoria, en bytes, a usar para la cache (0 vuelve a mapear las imágenes).			*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TAnalizadorFS::UsarCacheBloques(__u64 Presupuesto)
+{
+PresupuestoCache=Presupuesto;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TAnalizadorFS :: UsarHilos							*
+ *																	*
+ * OBJETIVO: Esta función indica cuántos hilos usar para recorrer árboles de directorios (comandos FIND y DU).				*
+ *																	*
+ * ENTRADA: NroHilos: Cantidad de hilos (0 usa uno por núcleo).										*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TAnalizadorFS::UsarHilos(unsigned NroHilos)
+{
+HilosRecorrido=NroHilos;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TAnalizadorFS :: UsarMetricas							*
+ *																	*
+ * OBJETIVO: Esta función activa o desactiva la medición de cada comando de tests (tiempo, sectores, bytes copiados y alocaciones).	*
+ *																	*
+ * ENTRADA: Activar: true para medir y mostrar al final de cada imágen un resumen con percentiles por tipo de comando.			*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TAnalizadorFS::UsarMetricas(bool Activar)
+{
+if ( (Activar) && (!Medidor) )
+	Medidor=new TMedidorComandos();
+else if ( (!Activar) && (Medidor) )
+    {
+	delete Medidor;
+	Medidor=NULL;
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TAnalizadorFS :: UsarSalida							*
+ *																	*
+ * OBJETIVO: Esta función vacía lo pendiente e indica dónde escribir el informe de las próximas imágenes (por defecto stdout).		*
+ *																	*
+ * ENTRADA: Archivo: Archivo abierto para escritura (sigue siendo propiedad del llamador).						*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TAnalizadorFS::UsarSalida(FILE *Archivo)
+{
+Salida->CambiarArchivo(Archivo);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TAnalizadorFS :: UsarFormato							*
+ *																	*
+ * OBJETIVO: Esta función elige el formato del informe de las próximas imágenes: texto (por defecto), JSON Lines o binario.		*
+ *																	*
+ * ENTRADA: Formato: Formato a usar.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: En los formatos de registros la salida lleva sólo registros, por lo que los mensajes de avance van a stderr.		*
+ *																	*
+ ****************************************************************************************************************************************/
+void TAnalizadorFS::UsarFormato(TFormatoSalida Formato)
+{
+/* Liberar el emisor y el buffer de mensajes anteriores */
+delete Emisor;
+if (Mensajes!=Salida)
+	delete Mensajes;
+
+/* Crear los del formato pedido */
+Emisor=TEmisorRegistros::Crear(Formato, Salida);
+Mensajes=Emisor ? new TSalida(stderr) : Salida;
+}
+
+
 /****************************************************************************************************************************************
  *																	*
  *						      TAnalizadorFS :: EjecutarTests							*
@@ -150,11 +324,12 @@ return(CODERROR_NINGUNO);
  ****************************************************************************************************************************************/
 int TAnalizadorFS::EjecutarTests()
 {
-int	CodError = CODERROR_NINGUNO;
-char	aux[1024];
-char	Delimiters[] = " \t";
-char	*p;
-FILE	*f;
+int			CodError = CODERROR_NINGUNO;
+char			aux[1024];
+char			Delimiters[] = " \t";
+char			*p, *q, *Comando;
+FILE			*f;
+TContadoresDriver	Contadores;
 
 /* Armar el nombre del archivo de comandos */
 sprintf(aux, "%s_tests.txt", __progname_full);
@@ -176,7 +351,15 @@ while ( (CodError==CODERROR_NINGUNO) && (fgets(aux, sizeof(aux), f)) )
 		continue;
 
 	/* Obtener el comando */
-	p=strtok(aux, Delimiters);
+	p=Comando=strtok(aux, Delimiters);
+
+	/* Si se pidieron métricas, tomar los valores iniciales */
+	if (Medidor)
+	    {
+		DriverFS->LeerContadores(Contadores);
+		Medidor->Empezar(Contadores);
+	    }
+
 	if (!strcasecmp(p, "dir"))
 	    {
 		/* Quieren ejecutar un DIR */
@@ -201,16 +384,91 @@ while ( (CodError==CODERROR_NINGUNO) && (fgets(aux, sizeof(aux), f)) )
 		/* Listar el contenido del directorio */
 		CodError=MostrarContenidoArchivo(p);
 	    }
+	else if (!strcasecmp(p, "map"))
+	    {
+		/* Quieren ejecutar un MAP */
+
+		/* Primero debería venir la ruta completa al archivo */
+		p=strtok(NULL, Delimiters);
+		if (!p)
+			return(CODERROR_COMANDO_CON_ERRORES);
+
+		/* Mostrar dónde está el archivo dentro de la imágen */
+		CodError=MostrarMapaArchivo(p);
+	    }
+	else if (!strcasecmp(p, "stat"))
+	    {
+		/* Quieren ejecutar un STAT */
+
+		/* Primero debería venir la ruta completa al archivo o directorio */
+		p=strtok(NULL, Delimiters);
+		if (!p)
+			return(CODERROR_COMANDO_CON_ERRORES);
+
+		/* Mostrar su entrada de directorio */
+		CodError=MostrarDatosArchivo(p);
+	    }
+	else if (!strcasecmp(p, "find"))
+	    {
+		/* Quieren ejecutar un FIND */
+
+		/* Primero debería venir el directorio y opcionalmente un patrón para los nombres */
+		p=strtok(NULL, Delimiters);
+		if (!p)
+			return(CODERROR_COMANDO_CON_ERRORES);
+
+		/* Listar todo el árbol que cumpla con el patrón */
+		CodError=BuscarEnArbol(p, strtok(NULL, Delimiters));
+	    }
+	else if (!strcasecmp(p, "du"))
+	    {
+		/* Quieren ejecutar un DU */
+
+		/* Primero debería venir el directorio */
+		p=strtok(NULL, Delimiters);
+		if (!p)
+			return(CODERROR_COMANDO_CON_ERRORES);
+
+		/* Mostrar lo que ocupa cada directorio del árbol */
+		CodError=MostrarEspacioArbol(p);
+	    }
+	else if (!strcasecmp(p, "extract"))
+	    {
+		/* Quieren ejecutar un EXTRACT */
+
+		/* Primero debería venir el directorio de la imágen y después el del host */
+		p=strtok(NULL, Delimiters);
+		q=strtok(NULL, Delimiters);
+		if ( (!p) || (!q) )
+			return(CODERROR_COMANDO_CON_ERRORES);
+
+		/* Copiar el árbol al host */
+		CodError=ExtraerArbol(p, q);
+	    }
 	else
 	    {
 		/* Comando desconocido */
 		return(CODERROR_COMANDO_DESCONOCIDO);
 	    }
+
+	/* Registrar lo que costó */
+	if (Medidor)
+	    {
+		DriverFS->LeerContadores(Contadores);
+		Medidor->Terminar(Comando, Contadores, Mensajes);
+	    }
     }
 
 /* Cerrar el archivo de comandos */
 fclose(f);
 
+/* Resumir las métricas de esta imágen */
+if (Medidor)
+    {
+	Medidor->MostrarResumen(Mensajes);
+	Medidor->Vaciar();
+    }
+
 /* Salir indicando éxito */
 return(CODERROR_NINGUNO);
 }
@@ -229,8 +487,9 @@ return(CODERROR_NINGUNO);
  ****************************************************************************************************************************************/
 int TAnalizadorFS::CargarImagen(const char *Ruta)
 {
-int		CodError = CODERROR_NINGUNO;
+int		CodError;
 FILE		*f;
+off_t		Longitud;
 
 /* Voy a cargar una nueva imágen, borrar todo */
 BorrarTodoYReinicializar();
@@ -239,49 +498,34 @@ BorrarTodoYReinicializar();
 if ( (f=fopen(Ruta, "rb")) == NULL )
     {
 	/* No puedo abrirlo, salir */
-	CodError = CODERROR_ARCHIVO_INEXISTENTE;
+	return(CODERROR_ARCHIVO_INEXISTENTE);
     }
+
+/* Si se puede posicionar se mapea (o se lee bajo demanda si se pidió cache), caso contrario (pipes, etc) se lee entero a memoria */
+Longitud=lseek(fileno(f), 0, SEEK_END);
+if ( (Longitud>0) && (PresupuestoCache>0) )
+	CodError=AbrirImagenConCache(f, Longitud);
+else if (Longitud>0)
+	CodError=MapearImagen(f, Longitud);
 else
-    {
-	/* Determinar el tamaño */
-	fseek(f, 0, SEEK_END);
-	LongitudDiskData=ftell(f);
-	fseek(f, 0, SEEK_SET);
-	
-	/* Validar la longitud del archivo */
-	if ( (LongitudDiskData%512) != 0 )
-	    {
-		/* No puede no ser múltiplo de sector */
-		CodError = CODERROR_ARCHIVO_INVALIDO;
-	    }
-	else
-	    {
-		/* Alocar memoria para almacenarlo */
-		if ( (DiskData=(const unsigned char *)malloc(LongitudDiskData)) == NULL )
-		    {
-			/* No hay suficiente memoria */
-			CodError = CODERROR_FALTA_MEMORIA;
-		    }
-		else
-		    {
-			/* Levantar el archivo a memoria */
-			if ( fread((void *)DiskData, 1, LongitudDiskData, f) != LongitudDiskData )
-			    {
-				/* Error al levantar el archivo */
-				CodError = CODERROR_LECTURA_DISCO;
-			    }
-		    }
-	    }
+	CodError=LeerImagen(f);
 
-	/* Cerrar el archivo de entrada */
+/* Cerrar el archivo de entrada si no quedó en uso (el mapeo sigue siendo válido) */
+if (f)
 	fclose(f);
+
+/* Validar la longitud del archivo */
+if ( (CodError==CODERROR_NINGUNO) && ((FuenteSectores->Longitud()%512) != 0) )
+    {
+	/* No puede no ser múltiplo de sector */
+	CodError = CODERROR_ARCHIVO_INVALIDO;
     }
 
 /* Ver si hubo errores */
 if (CodError==CODERROR_NINGUNO)
     {
 	/* Se cargó sin errores */
-	printf("Se cargaron %d bytes de %s sin errores.\n", LongitudDiskData, Ruta);
+	Mensajes->Printf("Se cargaron %llu bytes de %s sin errores.\n", FuenteSectores->Longitud(), Ruta);
     }
 else
     {
@@ -294,6 +538,139 @@ return(CodError);
 }
 
 
+/****************************************************************************************************************************************
+ *																	*
+ *						      TAnalizadorFS :: MapearImagen							*
+ *																	*
+ * OBJETIVO: Esta función mapea en memoria (sólo lectura) una imágen de disco contenida en un archivo regular. No se lee nada del	*
+ *	     disco en este momento, el sistema operativo trae cada página recién cuando un driver la accede vía PunteroASector.		*
+ *																	*
+ * ENTRADA: f: Archivo abierto.														*
+ *	    Longitud: Tamaño, en bytes, del archivo.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Si el mapeo no es posible se recurre a leer el archivo completo con LeerImagen().					*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::MapearImagen(FILE *f, off_t Longitud)
+{
+void	*p;
+
+/* Validar que el tamaño sea direccionable en este proceso */
+if ( (Longitud<=0) || ((unsigned long long)Longitud>SIZE_MAX) )
+	return(CODERROR_ARCHIVO_INVALIDO);
+
+/* Mapear el archivo completo */
+p=mmap(NULL, (size_t)Longitud, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+if (p==MAP_FAILED)
+    {
+	/* El filesystem no lo permite, levantarlo a memoria desde el principio */
+	fseek(f, 0, SEEK_SET);
+	return(LeerImagen(f));
+    }
+
+/* Acceder a la imágen a través del mapeo */
+FuenteSectores=new TFuenteSectoresMMap(p, (__u64)Longitud);
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TAnalizadorFS :: AbrirImagenConCache							*
+ *																	*
+ * OBJETIVO: Esta función prepara la lectura bajo demanda de la imágen con pread(), detrás de una cache LRU de bloques alineados con	*
+ *	     un presupuesto fijo de memoria. Permite analizar imágenes mucho más grandes que la memoria disponible.			*
+ *																	*
+ * ENTRADA: f: Archivo abierto.														*
+ *	    Longitud: Tamaño, en bytes, del archivo.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   f: NULL, el archivo pasa a ser propiedad de la fuente de sectores.								*
+ *																	*
+ * OBSERVACIONES: Los lotes de rangos que piden los drivers no pasan por la cache, se leen con io_uring (o un pool de pread()).		*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::AbrirImagenConCache(FILE *&f, off_t Longitud)
+{
+/* Armar la fuente que lee del archivo y la cache delante de ella */
+FuenteSectores=new TCacheBloques(new TFuenteSectoresAsincronica(f, (__u64)Longitud), PresupuestoCache);
+f=NULL;
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TAnalizadorFS :: LeerImagen							*
+ *																	*
+ * OBJETIVO: Esta función levanta a memoria dinámica la imágen de disco leyéndola secuencialmente hasta el fin de archivo. Sirve	*
+ *	     para entradas que no se pueden mapear ni posicionar (pipes, sockets, dispositivos de caracteres).				*
+ *																	*
+ * ENTRADA: f: Archivo abierto.														*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::LeerImagen(FILE *f)
+{
+int		CodError = CODERROR_NINGUNO;
+size_t		Capacidad, Longitud, Leidos;
+unsigned char	*Buffer, *p;
+
+/* Levantar el archivo a memoria, agrandando el buffer a medida que llegan datos */
+Buffer=NULL;
+Capacidad=0;
+Longitud=0;
+do
+    {
+	/* Ver si hay que agrandar el buffer */
+	if (Longitud==Capacidad)
+	    {
+		Capacidad=Capacidad ? 2*Capacidad : 1024*1024;
+		if ( (p=(unsigned char *)realloc(Buffer, Capacidad)) == NULL )
+		    {
+			/* No hay suficiente memoria */
+			CodError = CODERROR_FALTA_MEMORIA;
+			break;
+		    }
+		Buffer=p;
+	    }
+
+	/* Leer lo que entre */
+	Leidos=fread(Buffer+Longitud, 1, Capacidad-Longitud, f);
+	Longitud+=Leidos;
+    }
+while (Leidos>0);
+
+/* Ver si terminó por un error de lectura */
+if ( (CodError==CODERROR_NINGUNO) && (ferror(f)) )
+	CodError = CODERROR_LECTURA_DISCO;
+
+/* Validar que se haya leído algo */
+if ( (CodError==CODERROR_NINGUNO) && (Longitud==0) )
+	CodError = CODERROR_ARCHIVO_INVALIDO;
+
+/* Ver si hubo errores */
+if (CodError!=CODERROR_NINGUNO)
+    {
+	free(Buffer);
+	return(CodError);
+    }
+
+/* Acceder a la imágen a través del buffer leído */
+FuenteSectores=new TFuenteSectoresMemoria(Buffer, (__u64)Longitud);
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
 /****************************************************************************************************************************************
  *																	*
  *						 TAnalizadorFS :: BorrarTodoYReinicializar						*
@@ -308,13 +685,19 @@ return(CodError);
  ****************************************************************************************************************************************/
 void TAnalizadorFS::BorrarTodoYReinicializar(void)
 {
+/* Liberar el driver antes que la imágen, porque la referencia (en lote se reusa el analizador para cada imágen) */
+if (DriverFS)
+    {
+	delete(DriverFS);
+	DriverFS=NULL;
+    }
+
 /* Ver si hay imágen cargada */
-if (DiskData)
+if (FuenteSectores)
     {
-	/* Sí, liberarla */
-	free((void *)DiskData);
-	LongitudDiskData=0;
-	DiskData=NULL;
+	/* Sí, liberarla (cada fuente sabe cómo) */
+	delete FuenteSectores;
+	FuenteSectores=NULL;
     }
 }
 
@@ -332,28 +715,40 @@ if (DiskData)
  ****************************************************************************************************************************************/
 int TAnalizadorFS::MostrarContenidoDirectorio(const char *Path)
 {
-int				CodError;
-std::vector<TEntradaDirectorio> Entradas;
+int	CodError;
+bool	Encabezado;
 
 /* Imprimir lo que voy a hacer */
-printf("Leyendo directorio '%s' ...\n", Path);
+Mensajes->Printf("Leyendo directorio '%s' ...\n", Path);
 
-/* Buscar el contenido del directorio */
-CodError=DriverFS->ListarDirectorio(Path, Entradas);
-if ( (CodError!=CODERROR_NINGUNO) && (CodError!=CODERROR_DIRECTORIO_INEXISTENTE) )
-	return(CodError);
+/* Recorrer el directorio juntando las entradas en el lote, que se muestra cada vez que se llena (el encabezado va con la primera) */
+Encabezado=false;
+LoteDirectorio.Vaciar();
+CodError=DriverFS->RecorrerDirectorio(Path, [&](const TEntradaDirectorio &Entrada)
+    {
+	LoteDirectorio.Agregar(Entrada);
+	if (LoteDirectorio.Cantidad()>=DIR_ENTRADAS_POR_LOTE)
+		MostrarLoteDirectorio(Path, Encabezado);
+	return(true);
+    });
+
+/* Mostrar lo que quedó en el lote, también si el recorrido se cortó por un error */
+MostrarLoteDirectorio(Path, Encabezado);
 if (CodError==CODERROR_NINGUNO)
     {
-	/* Lo tengo, mostrarlo por pantalla */
-	DriverFS->MostrarDatosDirectorio(Entradas);
+	/* Un directorio vacío también lleva el encabezado */
+	if ( (!Emisor) && (!Encabezado) )
+		DriverFS->MostrarEncabezadoDirectorio();
     }
 else
     {
 	/* Si el problema es que el directorio no existe no reportar error, simplemente imprimir que no existe */
-	if (CodError==CODERROR_DIRECTORIO_INEXISTENTE)
-		printf("\tError, el directorio NO EXISTE!\n");
-	else
+	if (CodError!=CODERROR_DIRECTORIO_INEXISTENTE)
 		return(CodError);
+	if (Emisor)
+		Emisor->Error(Path, CodError);
+	else
+		Salida->Printf("\tError, el directorio NO EXISTE!\n");
     }
 
 /* Salir indicando éxito */
@@ -361,6 +756,47 @@ return(CODERROR_NINGUNO);
 }
 
 
+/****************************************************************************************************************************************
+ *																	*
+ *						 TAnalizadorFS :: MostrarLoteDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función muestra las entradas juntadas en el lote del directorio y lo vacía.						*
+ *																	*
+ * ENTRADA: Path: Ruta al directorio al que pertenecen las entradas.									*
+ *	    Encabezado: Si ya se mostró el encabezado del listado.									*
+ *																	*
+ * SALIDA: Encabezado: true si se mostró el encabezado (con la primera entrada en formato texto).					*
+ *																	*
+ * OBSERVACIONES: El lote y la entrada en que se rearma cada una se reutilizan entre llamadas, así que una vez que alcanzaron su	*
+ *		  tamaño de trabajo listar un directorio no aloca memoria.								*
+ *																	*
+ ****************************************************************************************************************************************/
+void TAnalizadorFS::MostrarLoteDirectorio(const char *Path, bool &Encabezado)
+{
+unsigned	i;
+
+/* Mostrar cada entrada del lote */
+for(i=0;i<LoteDirectorio.Cantidad();i++)
+    {
+	LoteDirectorio.Entrada(i, EntradaLote);
+	if (Emisor)
+	    {
+		Emisor->Entrada(Path, DriverFS->DatosFS.TipoFilesystem, EntradaLote);
+		continue;
+	    }
+	if (!Encabezado)
+	    {
+		DriverFS->MostrarEncabezadoDirectorio();
+		Encabezado=true;
+	    }
+	DriverFS->MostrarEntradaDirectorio(EntradaLote);
+    }
+
+/* Dejar el lote listo para las próximas entradas */
+LoteDirectorio.Vaciar();
+}
+
+
 /****************************************************************************************************************************************
  *																	*
  *					      TAnalizadorFS :: MostrarContenidoArchivo							*
@@ -371,33 +807,354 @@ return(CODERROR_NINGUNO);
  *																	*
  * SALIDA: En el nombre de la función el código de error.										*
  *																	*
+ * OBSERVACIONES: El archivo se lee y se muestra de a tramos de LECTURA_TAM_BLOQUE bytes, así que la memoria usada no depende de su	*
+ *		  tamaño. La ruta se resuelve una sola vez y los tramos se leen con el manejador.					*
+ *																	*
  ****************************************************************************************************************************************/
 int TAnalizadorFS::MostrarContenidoArchivo(const char *Path)
 {
-int		CodError;
-unsigned	DataLen;
-unsigned char	*Data;
+TManejadorArchivo	Manejador;
+int			CodError;
+__u64			Offset, Leidos;
+unsigned char		*Buffer;
 
 /* Imprimir lo que voy a hacer */
-printf("Leyendo archivo '%s' ...\n", Path);
+Mensajes->Printf("Leyendo archivo '%s' ...\n", Path);
 
-/* Buscar el contenido del archivo */
-CodError=DriverFS->LeerArchivo(Path, Data, DataLen);
-if ( (CodError!=CODERROR_NINGUNO) && (CodError!=CODERROR_ARCHIVO_INEXISTENTE) )
+/* Ubicar el archivo, que además dice cuánto mide */
+CodError=DriverFS->AbrirArchivo(Path, Manejador);
+if (CodError==CODERROR_ARCHIVO_INEXISTENTE)
+    {
+	/* Si el problema es que el archivo no existe no reportar error, simplemente imprimir que no existe */
+	if (Emisor)
+		Emisor->Error(Path, CodError);
+	else
+		Salida->Printf("\tError, el archivo NO EXISTE!\n");
+	return(CODERROR_NINGUNO);
+    }
+if (CodError!=CODERROR_NINGUNO)
 	return(CodError);
 
-if (CodError==CODERROR_NINGUNO)
+/* Lo tengo, mostrar el tamaño */
+if (Emisor)
+	Emisor->Archivo(Path, Manejador.Bytes);
+else
+	Salida->Printf("\tLeído, %llu bytes\n", Manejador.Bytes);
+
+/* Alocar el buffer para un tramo */
+if ( (Buffer=(unsigned char *)malloc(LECTURA_TAM_BLOQUE)) == NULL )
+	return(CODERROR_FALTA_MEMORIA);
+
+/* Leer cada tramo y mostrarlo por pantalla (o emitirlo en registros) */
+Offset=0;
+while ( (CodError=DriverFS->LeerRangoArchivo(Manejador, Offset, LECTURA_TAM_BLOQUE, Buffer, Leidos)) == CODERROR_NINGUNO )
     {
-	/* Lo tengo, mostrarlo por pantalla */
-	printf("\tLeído, %u bytes\n", DataLen);
-	DriverFS->PrintBuffer(Data, DataLen, PrintWidth);
-	free(Data);
+	if (!Leidos)
+		break;
+	if (Emisor)
+		Emisor->Datos(Path, Offset, Buffer, Leidos);
+	else
+		DriverFS->PrintBuffer(Buffer, Leidos, PrintWidth, Offset);
+	Offset+=Leidos;
     }
-else
+
+/* Salir */
+free(Buffer);
+return(CodError);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TAnalizadorFS :: MostrarMapaArchivo							*
+ *																	*
+ * OBJETIVO: Esta función usa el driver cargado para mostrar en qué offsets de la imágen está cada tramo de un archivo.			*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo cuyo mapa mostrar.											*
+ *																	*
+ * SALIDA: En el nombre de la función el código de error.										*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::MostrarMapaArchivo(const char *Path)
+{
+std::vector<TExtentArchivo>	Extents;
+int				CodError;
+unsigned			i;
+
+/* Imprimir lo que voy a hacer */
+Mensajes->Printf("Mapeando archivo '%s' ...\n", Path);
+
+/* Buscar el mapa del archivo */
+CodError=DriverFS->MapearArchivo(Path, Extents);
+if (CodError==CODERROR_ARCHIVO_INEXISTENTE)
     {
 	/* Si el problema es que el archivo no existe no reportar error, simplemente imprimir que no existe */
-	printf("\tError, el archivo NO EXISTE!\n");
+	if (Emisor)
+		Emisor->Error(Path, CodError);
+	else
+		Salida->Printf("\tError, el archivo NO EXISTE!\n");
+	return(CODERROR_NINGUNO);
+    }
+if (CodError!=CODERROR_NINGUNO)
+	return(CodError);
+
+/* Emitir un registro por tramo */
+if (Emisor)
+    {
+	for(i=0;i<Extents.size();i++)
+		Emisor->Extent(Path, Extents[i]);
+	return(CODERROR_NINGUNO);
+    }
+
+/* O mostrarlos por pantalla */
+Salida->Printf("\t%u tramos\n", (unsigned)Extents.size());
+Salida->Printf("\t  Offset Archivo    Offset Imágen        Longitud\n");
+Salida->Printf("\t---------------- ---------------- ----------------\n");
+for(i=0;i<Extents.size();i++)
+    {
+	if (Extents[i].Hueco)
+		Salida->Printf("\t%16llu %16s %16llu\n", Extents[i].OffsetArchivo, "(hueco)", Extents[i].Longitud);
+	else
+		Salida->Printf("\t%16llu %16llu %16llu\n", Extents[i].OffsetArchivo, Extents[i].OffsetImagen, Extents[i].Longitud);
+    }
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TAnalizadorFS :: MostrarDatosArchivo							*
+ *																	*
+ * OBJETIVO: Esta función usa el driver cargado para mostrar la entrada de directorio de un archivo o directorio.			*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo o directorio.												*
+ *																	*
+ * SALIDA: En el nombre de la función el código de error.										*
+ *																	*
+ * OBSERVACIONES: No lista el directorio padre: el driver sólo levanta la entrada pedida.						*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::MostrarDatosArchivo(const char *Path)
+{
+TEntradaDirectorio	Entrada;
+TString			Directorio;
+int			CodError;
+
+/* Imprimir lo que voy a hacer */
+Mensajes->Printf("Consultando '%s' ...\n", Path);
+
+/* Buscar la entrada */
+CodError=DriverFS->Stat(Path, Entrada);
+if (CodError==CODERROR_ARCHIVO_INEXISTENTE)
+    {
+	/* Si el problema es que no existe no reportar error, simplemente imprimir que no existe */
+	if (Emisor)
+		Emisor->Error(Path, CodError);
+	else
+		Salida->Printf("\tError, el archivo NO EXISTE!\n");
+	return(CODERROR_NINGUNO);
+    }
+if (CodError!=CODERROR_NINGUNO)
+	return(CodError);
+
+/* Mostrarla como una línea de DIR */
+if (!Emisor)
+    {
+	DriverFS->MostrarEncabezadoDirectorio();
+	DriverFS->MostrarEntradaDirectorio(Entrada);
+	return(CODERROR_NINGUNO);
+    }
+
+/* O emitirla como entrada de su directorio padre */
+Directorio.assign(Path);
+while ( (Directorio.size()>1) && (Directorio[Directorio.size()-1]=='/') )
+	Directorio.erase(Directorio.size()-1);
+Directorio.erase(Directorio.find_last_of('/')+1);
+if (Directorio.size()>1)
+	Directorio.erase(Directorio.size()-1);
+Emisor->Entrada(Directorio.c_str(), DriverFS->DatosFS.TipoFilesystem, Entrada);
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TAnalizadorFS :: BuscarEnArbol							*
+ *																	*
+ * OBJETIVO: Esta función usa el driver cargado para listar recursivamente un directorio, estilo find.					*
+ *																	*
+ * ENTRADA: Path: Ruta al directorio raíz de la búsqueda.										*
+ *	    Patrón: Patrón de shell (fnmatch) que tienen que cumplir los nombres, o NULL para listar todo.				*
+ *																	*
+ * SALIDA: En el nombre de la función el código de error.										*
+ *																	*
+ * OBSERVACIONES: Las rutas salen a medida que las encuentran los hilos del recorrido, así que el orden varía entre corridas.		*
+ *		  Los directorios terminan en '/' y los nombres que llevan a algo ya visto se marcan como repetidos.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::BuscarEnArbol(const char *Path, const char *Patron)
+{
+TRecorredorArbol	Recorredor(DriverFS, HilosRecorrido);
+TTotalesArbol		Totales;
+__u64			Encontrados;
+int			CodError;
+
+/* Imprimir lo que voy a hacer */
+Mensajes->Printf("Buscando en '%s' ...\n", Path);
+
+/* Filtrar por nombre */
+if (Patron)
+	Recorredor.UsarPredicado([Patron](const char *, const TEntradaDirectorio &Entrada)
+	    {
+		return(fnmatch(Patron, Entrada.Nombre.c_str(), 0)==0);
+	    });
+
+/* Mostrar (o emitir) cada entrada apenas aparece */
+Encontrados=0;
+Recorredor.UsarVisitante([&](const char *Directorio, const TEntradaDirectorio &Entrada, bool Repetida)
+    {
+	Encontrados++;
+	if (Emisor)
+		Emisor->Entrada(Directorio, DriverFS->DatosFS.TipoFilesystem, Entrada);
+	else
+		Salida->Printf("\t%s%s%s%s%s\n", Directorio, Directorio[1] ? "/" : "", Entrada.Nombre.c_str(),
+			       Entrada.Flags&fedDIRECTORIO ? "/" : "", Repetida ? "  (repetido)" : "");
+	return(true);
+    });
+
+/* Recorrer el árbol */
+CodError=Recorredor.Recorrer(Path, Totales);
+if (CodError==CODERROR_DIRECTORIO_INEXISTENTE)
+    {
+	/* Si el problema es que el directorio no existe no reportar error, simplemente imprimir que no existe */
+	if (Emisor)
+		Emisor->Error(Path, CodError);
+	else
+		Salida->Printf("\tError, el directorio NO EXISTE!\n");
+	return(CODERROR_NINGUNO);
+    }
+if (CodError!=CODERROR_NINGUNO)
+	return(CodError);
+
+/* Cerrar con la cantidad encontrada */
+if (!Emisor)
+	Salida->Printf("\t%llu encontrados\n", Encontrados);
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TAnalizadorFS :: MostrarEspacioArbol							*
+ *																	*
+ * OBJETIVO: Esta función usa el driver cargado para mostrar cuánto ocupa cada directorio de un árbol, estilo du.			*
+ *																	*
+ * ENTRADA: Path: Ruta al directorio raíz.												*
+ *																	*
+ * SALIDA: En el nombre de la función el código de error.										*
+ *																	*
+ * OBSERVACIONES: Cada directorio sale apenas se terminó de recorrer su subárbol, después de todos sus subdirectorios. Los bytes	*
+ *		  son los tamaños de los archivos, contando una sola vez los que tienen varios nombres.					*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::MostrarEspacioArbol(const char *Path)
+{
+TRecorredorArbol	Recorredor(DriverFS, HilosRecorrido);
+TTotalesArbol		Totales;
+int			CodError;
+
+/* Imprimir lo que voy a hacer */
+Mensajes->Printf("Calculando espacio de '%s' ...\n", Path);
+
+/* Mostrar (o emitir) los totales de cada directorio */
+Recorredor.UsarResumen([&](const char *Directorio, const TTotalesArbol &Totales)
+    {
+	if (Emisor)
+		Emisor->Totales(Directorio, Totales);
+	else
+		Salida->Printf("\t%16llu %s\n", Totales.Bytes, Directorio);
+    });
+
+/* Recorrer el árbol */
+CodError=Recorredor.Recorrer(Path, Totales);
+if (CodError==CODERROR_DIRECTORIO_INEXISTENTE)
+    {
+	/* Si el problema es que el directorio no existe no reportar error, simplemente imprimir que no existe */
+	if (Emisor)
+		Emisor->Error(Path, CodError);
+	else
+		Salida->Printf("\tError, el directorio NO EXISTE!\n");
+	return(CODERROR_NINGUNO);
     }
+if (CodError!=CODERROR_NINGUNO)
+	return(CodError);
+
+/* Cerrar con los totales */
+if (!Emisor)
+	Salida->Printf("\t%llu bytes en %llu archivos y %llu directorios (%llu nombres repetidos)\n",
+		       Totales.Bytes, Totales.Archivos, Totales.Directorios, Totales.Repetidos);
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TAnalizadorFS :: ExtraerArbol							*
+ *																	*
+ * OBJETIVO: Esta función usa el driver cargado para copiar recursivamente un directorio de la imágen a un directorio del host.		*
+ *																	*
+ * ENTRADA: Path: Ruta al directorio de la imágen.											*
+ *	    Destino: Directorio del host (se crea si no existe).									*
+ *																	*
+ * SALIDA: En el nombre de la función el código de error.										*
+ *																	*
+ ****************************************************************************************************************************************/
+int TAnalizadorFS::ExtraerArbol(const char *Path, const char *Destino)
+{
+TExtractorArbol		Extractor(DriverFS, HilosRecorrido);
+TTotalesArbol		Totales;
+int			CodError;
+
+/* Imprimir lo que voy a hacer */
+Mensajes->Printf("Extrayendo '%s' a '%s' ...\n", Path, Destino);
+
+/* Copiar el árbol */
+CodError=Extractor.Extraer(Path, Destino, Totales);
+if ( (CodError==CODERROR_DIRECTORIO_INEXISTENTE) || (CodError==CODERROR_ESCRITURA_DISCO) )
+    {
+	/* Si el problema es que el directorio no existe o no se puede escribir el destino no reportar error, sólo informarlo */
+	if (Emisor)
+		Emisor->Error(Path, CodError);
+	else if (CodError==CODERROR_DIRECTORIO_INEXISTENTE)
+		Salida->Printf("\tError, el directorio NO EXISTE!\n");
+	else
+		Salida->Printf("\tError, no se pudo escribir en '%s'!\n", Destino);
+	return(CODERROR_NINGUNO);
+    }
+if (CodError!=CODERROR_NINGUNO)
+	return(CodError);
+
+/* Informar lo copiado */
+if (Emisor)
+	Emisor->Totales(Path, Totales);
+else
+	Salida->Printf("\t%llu bytes en %llu archivos y %llu directorios (%llu nombres repetidos)\n",
+		       Totales.Bytes, Totales.Archivos, Totales.Directorios, Totales.Repetidos);
+
+/* Informar los archivos que no se pudieron copiar (el resto quedó extraído igual) */
+for (const TFalloExtraccion &Fallo : Extractor.Fallos())
+	if (Emisor)
+		Emisor->Error(Fallo.Ruta.c_str(), Fallo.CodError);
+	else
+		Salida->Printf("\tError, no se pudo extraer '%s' (código %d)!\n", Fallo.Ruta.c_str(), Fallo.CodError);
 
 /* Salir indicando éxito */
 return(CODERROR_NINGUNO);
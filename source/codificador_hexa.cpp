@@ -0,0 +1,217 @@
+﻿#include "all_heads.h"
+
+
+/************************
+ *			*
+ *     Constantes	*
+ *			*
+ ************************/
+static const char	DigitosHexa[] = "0123456789ABCDEF";
+
+/* Distribución de los pares de dígitos ("XY" por byte) en las tres salidas de 16 caracteres ("XX " por byte) que genera cada
+   bloque de 16 bytes. -1 deja el lugar en cero para después poner el espacio */
+#define	HEXA_MASCARA_0		0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10
+#define	HEXA_MASCARA_1A		11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1
+#define	HEXA_MASCARA_1B		-1, -1, -1, -1, -1, -1, -1, -1, 0, 1, -1, 2, 3, -1, 4, 5
+#define	HEXA_MASCARA_2		-1, 6, 7, -1, 8, 9, -1, 10, 11, -1, 12, 13, -1, 14, 15, -1
+#define	HEXA_ESPACIOS_0		0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0
+#define	HEXA_ESPACIOS_1		0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0
+#define	HEXA_ESPACIOS_2		' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' '
+#define	HEXA_DIGITOS		'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+
+
+/********************************
+ *				*
+ *   Clase TCodificadorHexa	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *						    TCodificadorHexa :: CodificarFila							*
+ *																	*
+ * OBJETIVO: Esta función convierte un bloque de bytes en su columna hexa y su columna de caracteres de un volcado.			*
+ *																	*
+ * ENTRADA: Datos: Bytes a convertir.													*
+ *	    Longitud: Cantidad de bytes.												*
+ *	    Hexa: Buffer de al menos 3*Longitud caracteres, donde se deja "XX " por cada byte.						*
+ *	    Caracteres: Buffer de al menos Longitud caracteres, donde se deja cada byte si es imprimible (>=' ') o '.' si no.		*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: El kernel (AVX2, SSSE3 o escalar) se elige una sola vez según lo que soporte el procesador. Todos generan		*
+ *		  exactamente el mismo texto.												*
+ *																	*
+ ****************************************************************************************************************************************/
+void TCodificadorHexa::CodificarFila(const unsigned char *Datos, unsigned Longitud, char *Hexa, char *Caracteres)
+{
+static const TCodificarFila	Kernel = ElegirKernel();
+
+Kernel(Datos, Longitud, Hexa, Caracteres);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TCodificadorHexa :: ElegirKernel							*
+ *																	*
+ * OBJETIVO: Esta función elige el kernel más rápido que soporta el procesador.								*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función el kernel elegido.										*
+ *																	*
+ ****************************************************************************************************************************************/
+TCodificarFila TCodificadorHexa::ElegirKernel(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+__builtin_cpu_init();
+if (__builtin_cpu_supports("avx2"))
+	return(CodificarAVX2);
+if (__builtin_cpu_supports("ssse3"))
+	return(CodificarSSSE3);
+#endif
+return(CodificarEscalar);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TCodificadorHexa :: CodificarEscalar							*
+ *																	*
+ * OBJETIVO: Esta función es el kernel escalar, para procesadores sin extensiones vectoriales y las colas de los otros kernels.		*
+ *																	*
+ * ENTRADA: Datos: Bytes a convertir.													*
+ *	    Longitud: Cantidad de bytes.												*
+ *	    Hexa: Buffer de al menos 3*Longitud caracteres.										*
+ *	    Caracteres: Buffer de al menos Longitud caracteres.										*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TCodificadorHexa::CodificarEscalar(const unsigned char *Datos, unsigned Longitud, char *Hexa, char *Caracteres)
+{
+unsigned	i;
+
+for(i=0;i<Longitud;i++)
+    {
+	*Hexa++=DigitosHexa[Datos[i] >> 4];
+	*Hexa++=DigitosHexa[Datos[i] & 0xF];
+	*Hexa++=' ';
+	*Caracteres++=(Datos[i]>=' ') ? (char)Datos[i] : '.';
+    }
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+/****************************************************************************************************************************************
+ *																	*
+ *						   TCodificadorHexa :: CodificarSSSE3							*
+ *																	*
+ * OBJETIVO: Esta función es el kernel de 16 bytes por iteración (SSSE3: pshufb busca los dígitos y ubica los espacios).		*
+ *																	*
+ * ENTRADA: Datos: Bytes a convertir.													*
+ *	    Longitud: Cantidad de bytes.												*
+ *	    Hexa: Buffer de al menos 3*Longitud caracteres.										*
+ *	    Caracteres: Buffer de al menos Longitud caracteres.										*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+__attribute__((target("ssse3"))) void TCodificadorHexa::CodificarSSSE3(const unsigned char *Datos, unsigned Longitud, char *Hexa, char *Caracteres)
+{
+const __m128i	Digitos    = _mm_setr_epi8(HEXA_DIGITOS);
+const __m128i	Nibble     = _mm_set1_epi8(0x0F);
+const __m128i	Espacio    = _mm_set1_epi8(' ');
+const __m128i	Punto      = _mm_set1_epi8('.');
+const __m128i	Mascara0   = _mm_setr_epi8(HEXA_MASCARA_0);
+const __m128i	Mascara1A  = _mm_setr_epi8(HEXA_MASCARA_1A);
+const __m128i	Mascara1B  = _mm_setr_epi8(HEXA_MASCARA_1B);
+const __m128i	Mascara2   = _mm_setr_epi8(HEXA_MASCARA_2);
+const __m128i	Espacios0  = _mm_setr_epi8(HEXA_ESPACIOS_0);
+const __m128i	Espacios1  = _mm_setr_epi8(HEXA_ESPACIOS_1);
+const __m128i	Espacios2  = _mm_setr_epi8(HEXA_ESPACIOS_2);
+__m128i		x, Altos, Bajos, Pares0, Pares1, Imprimible;
+
+for(;Longitud>=16;Longitud-=16, Datos+=16, Hexa+=48, Caracteres+=16)
+    {
+	/* Dígito de cada nibble por tabla */
+	x=_mm_loadu_si128((const __m128i *)Datos);
+	Altos=_mm_shuffle_epi8(Digitos, _mm_and_si128(_mm_srli_epi16(x, 4), Nibble));
+	Bajos=_mm_shuffle_epi8(Digitos, _mm_and_si128(x, Nibble));
+
+	/* Pares "XY" de los bytes 0..7 y 8..15 */
+	Pares0=_mm_unpacklo_epi8(Altos, Bajos);
+	Pares1=_mm_unpackhi_epi8(Altos, Bajos);
+
+	/* Repartirlos en tres salidas de 16 caracteres intercalando los espacios */
+	_mm_storeu_si128((__m128i *)(Hexa+ 0), _mm_or_si128(_mm_shuffle_epi8(Pares0, Mascara0), Espacios0));
+	_mm_storeu_si128((__m128i *)(Hexa+16), _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(Pares0, Mascara1A), _mm_shuffle_epi8(Pares1, Mascara1B)), Espacios1));
+	_mm_storeu_si128((__m128i *)(Hexa+32), _mm_or_si128(_mm_shuffle_epi8(Pares1, Mascara2), Espacios2));
+
+	/* Columna de caracteres: los bytes >= ' ' (sin signo) quedan, el resto pasa a '.' */
+	Imprimible=_mm_cmpeq_epi8(_mm_max_epu8(x, Espacio), x);
+	_mm_storeu_si128((__m128i *)Caracteres, _mm_or_si128(_mm_and_si128(Imprimible, x), _mm_andnot_si128(Imprimible, Punto)));
+    }
+
+/* Cola */
+CodificarEscalar(Datos, Longitud, Hexa, Caracteres);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TCodificadorHexa :: CodificarAVX2							*
+ *																	*
+ * OBJETIVO: Esta función es el kernel de 32 bytes por iteración (AVX2), cada mitad de 128 bits trabaja como el kernel SSSE3.		*
+ *																	*
+ * ENTRADA: Datos: Bytes a convertir.													*
+ *	    Longitud: Cantidad de bytes.												*
+ *	    Hexa: Buffer de al menos 3*Longitud caracteres.										*
+ *	    Caracteres: Buffer de al menos Longitud caracteres.										*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+__attribute__((target("avx2"))) void TCodificadorHexa::CodificarAVX2(const unsigned char *Datos, unsigned Longitud, char *Hexa, char *Caracteres)
+{
+const __m256i	Digitos    = _mm256_setr_epi8(HEXA_DIGITOS, HEXA_DIGITOS);
+const __m256i	Nibble     = _mm256_set1_epi8(0x0F);
+const __m256i	Espacio    = _mm256_set1_epi8(' ');
+const __m256i	Punto      = _mm256_set1_epi8('.');
+const __m256i	Mascara0   = _mm256_setr_epi8(HEXA_MASCARA_0, HEXA_MASCARA_0);
+const __m256i	Mascara1A  = _mm256_setr_epi8(HEXA_MASCARA_1A, HEXA_MASCARA_1A);
+const __m256i	Mascara1B  = _mm256_setr_epi8(HEXA_MASCARA_1B, HEXA_MASCARA_1B);
+const __m256i	Mascara2   = _mm256_setr_epi8(HEXA_MASCARA_2, HEXA_MASCARA_2);
+const __m256i	Espacios0  = _mm256_setr_epi8(HEXA_ESPACIOS_0, HEXA_ESPACIOS_0);
+const __m256i	Espacios1  = _mm256_setr_epi8(HEXA_ESPACIOS_1, HEXA_ESPACIOS_1);
+const __m256i	Espacios2  = _mm256_setr_epi8(HEXA_ESPACIOS_2, HEXA_ESPACIOS_2);
+__m256i		x, Altos, Bajos, Pares0, Pares1, Salida0, Salida1, Salida2, Imprimible;
+
+for(;Longitud>=32;Longitud-=32, Datos+=32, Hexa+=96, Caracteres+=32)
+    {
+	/* Dígito de cada nibble por tabla */
+	x=_mm256_loadu_si256((const __m256i *)Datos);
+	Altos=_mm256_shuffle_epi8(Digitos, _mm256_and_si256(_mm256_srli_epi16(x, 4), Nibble));
+	Bajos=_mm256_shuffle_epi8(Digitos, _mm256_and_si256(x, Nibble));
+
+	/* Pares "XY", cada mitad de 128 bits con sus 16 bytes */
+	Pares0=_mm256_unpacklo_epi8(Altos, Bajos);
+	Pares1=_mm256_unpackhi_epi8(Altos, Bajos);
+
+	/* Las tres salidas de cada mitad: la mitad baja son los caracteres 0..47 y la alta los 48..95 */
+	Salida0=_mm256_or_si256(_mm256_shuffle_epi8(Pares0, Mascara0), Espacios0);
+	Salida1=_mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(Pares0, Mascara1A), _mm256_shuffle_epi8(Pares1, Mascara1B)), Espacios1);
+	Salida2=_mm256_or_si256(_mm256_shuffle_epi8(Pares1, Mascara2), Espacios2);
+	_mm256_storeu_si256((__m256i *)(Hexa+ 0), _mm256_permute2x128_si256(Salida0, Salida1, 0x20));
+	_mm256_storeu_si256((__m256i *)(Hexa+32), _mm256_permute2x128_si256(Salida2, Salida0, 0x30));
+	_mm256_storeu_si256((__m256i *)(Hexa+64), _mm256_permute2x128_si256(Salida1, Salida2, 0x31));
+
+	/* Columna de caracteres */
+	Imprimible=_mm256_cmpeq_epi8(_mm256_max_epu8(x, Espacio), x);
+	_mm256_storeu_si256((__m256i *)Caracteres, _mm256_blendv_epi8(Punto, x, Imprimible));
+    }
+
+/* Lo que quede se hace de a 16 o escalar */
+CodificarSSSE3(Datos, Longitud, Hexa, Caracteres);
+}
+#endif
\ No newline at end of file
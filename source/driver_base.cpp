@@ -13,20 +13,21 @@
  *																	*
  * OBJETIVO: Inicializar la clase recién creada.											*
  *																	*
- * ENTRADA: DiskData: Puntero a un bloque de memoria con la imágen del disco a analizar.						*
- *	    LongitudDiskData: Tamaño, en bytes, de la imágen a analizar.								*
+ * ENTRADA: Fuente: Origen de los datos de la imágen del disco a analizar.								*
  *																	*
  * SALIDA: Nada.															*
  *																	*
  ****************************************************************************************************************************************/
-TDriverBase::TDriverBase(const unsigned char *DiskData, unsigned LongitudDiskData)
+TDriverBase::TDriverBase(TFuenteSectores *Fuente)
 {
 /* Tomar los valores recibidos */
-TDriverBase::DiskData=DiskData;
-TDriverBase::LongitudDiskData=LongitudDiskData;
+TDriverBase::Fuente=Fuente;
 
 /* Inicialziar variables */
 memset(&DatosFS, 0, sizeof(DatosFS));
+Salida=NULL;
+SectoresAccedidos=0;
+BytesCopiados=0;
 }
 
 
@@ -54,27 +55,547 @@ TDriverBase::~TDriverBase()
  *																	*
  * ENTRADA: NroSector: Número de sector (el primero es el sector es el 0).								*
  *																	*
- * SALIDA: En el nombre de la función el puntero a los datos del sector.								*
+ * SALIDA: En el nombre de la función el puntero a los datos del sector, o NULL si el sector no está en la imágen. A partir de él	*
+ *	   hay un cluster completo contiguo en memoria (o lo que quede de la imágen, si es menos).					*
  *																	*
- * OBSERVACIONES: IMPORTANTE: Esta función sólo puede usarse para acceder al sector 0 hasta tanto se inicialice la variable 		*
- *			      DatosFS.BytesPorSector.											*
+ * OBSERVACIONES: Mientras no se inicialice DatosFS.BytesPorSector se toman sectores de SECTOR_TAM_MINIMO bytes, así que antes de	*
+ *		  eso sólo tiene sentido pedir el sector 0.										*
+ *		  El puntero es válido hasta soltarlo con SoltarSector(), y hay que soltarlo siempre (también en los caminos de		*
+ *		  error): mientras tanto la fuente no puede reusar esa memoria (la cache no desaloja el bloque). Para no olvidarlo	*
+ *		  conviene pedirlo con TSectorFijado, que lo suelta al salir de su alcance o al fijar otro sector.			*
  *																	*
  ****************************************************************************************************************************************/
 const unsigned char *TDriverBase::PunteroASector(__u64 NroSector)
 {
+__u64	Offset, Contiguos, BytesSector;
+
 /* Ver si tengo imágen cargada */
-if (!DiskData)
+if (!Fuente)
 	return(NULL);
 
+/* Mientras no se conozca el tamaño de sector se usa el mínimo */
+BytesSector=(DatosFS.BytesPorSector) ? DatosFS.BytesPorSector : SECTOR_TAM_MINIMO;
+
 /* Ver si el sector existe */
-if ( ((NroSector+1)*DatosFS.BytesPorSector) >= LongitudDiskData )
+Offset=NroSector*BytesSector;
+if ( (Offset>Fuente->Longitud()) || (BytesSector>(Fuente->Longitud()-Offset)) )
     {
 	/* No, la imágen cargada no tiene tantos sectores */
 	return(NULL);
     }
 
-/* Retornar el puntero solicitado */
-return(DiskData+NroSector*DatosFS.BytesPorSector);
+/* Los drivers leen un cluster entero a partir del sector, pedir ese rango contiguo */
+Contiguos=(DatosFS.BytesPorCluster>BytesSector) ? DatosFS.BytesPorCluster : BytesSector;
+if (Contiguos>(Fuente->Longitud()-Offset))
+	Contiguos=Fuente->Longitud()-Offset;
+if (!Contiguos)
+	return(NULL);
+
+/* Retornar el puntero solicitado (contando los sectores que quedan a la vista del driver) */
+SectoresAccedidos.fetch_add(Contiguos/BytesSector, std::memory_order_relaxed);
+return(Fuente->PunteroARango(Offset, (unsigned)Contiguos));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverBase :: SoltarSector							*
+ *																	*
+ * OBJETIVO: Esta función avisa a la fuente que ya no se usa un puntero devuelto por PunteroASector().					*
+ *																	*
+ * ENTRADA: Puntero: Puntero devuelto por PunteroASector() (NULL no hace nada).								*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverBase::SoltarSector(const unsigned char *Puntero)
+{
+if ( (Fuente) && (Puntero) )
+	Fuente->SoltarRango(Puntero);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TDriverBase :: LeerRangos							*
+ *																	*
+ * OBJETIVO: Esta función copia varios rangos de la imágen a buffers del llamador con un solo pedido a la fuente de sectores.		*
+ *																	*
+ * ENTRADA: Rangos: Rangos a leer (offsets en bytes desde el comienzo de la imágen), cada uno con su buffer de destino.			*
+ *	    NroRangos: Cantidad de elementos de Rangos.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Conviene para levantar archivos: la fuente puede tener todas las lecturas en vuelo a la vez.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::LeerRangos(TRangoLectura *Rangos, unsigned NroRangos)
+{
+unsigned	i;
+
+/* Ver si tengo imágen cargada */
+if (!Fuente)
+	return(CODERROR_LECTURA_DISCO);
+
+/* Contar lo que se copia */
+for (i=0; i<NroRangos; i++)
+	BytesCopiados.fetch_add(Rangos[i].Longitud, std::memory_order_relaxed);
+
+/* Delegar en la fuente */
+return(Fuente->LeerRangos(Rangos, NroRangos));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverBase :: ListarDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función enumera las entradas en un directorio y retorna un arreglo de elementos, uno por cada entrada.		*
+ *																	*
+ * ENTRADA: Path: Path al directorio enumerar (cadena de nombres de directorio separados por '/').					*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Entradas: Arreglo con cada una de las entradas.										*
+ *																	*
+ * OBSERVACIONES: Junta lo que va entregando RecorrerDirectorio(), para quien necesite todas las entradas a la vez.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas)
+{
+/* Recorrer el directorio guardando una copia de cada entrada */
+Entradas.clear();
+return(RecorrerDirectorio(Path, [&](const TEntradaDirectorio &Entrada)
+    {
+	Entradas.push_back(Entrada);
+	return(true);
+    }));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverBase :: AbrirArchivo							*
+ *																	*
+ * OBJETIVO: Esta función ubica un archivo dada su ruta, rechazando los directorios.							*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo.													*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Manejador: Manejador del archivo.												*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::AbrirArchivo(const char *Path, TManejadorArchivo &Manejador)
+{
+int	CodError;
+
+/* Ubicar el archivo */
+if ( (CodError=Abrir(Path, Manejador)) != CODERROR_NINGUNO )
+	return(CodError);
+
+/* Los directorios no se pueden leer como archivos */
+if (Manejador.Flags&fedDIRECTORIO)
+	return(CODERROR_ARCHIVO_INEXISTENTE);
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverBase :: RecorrerDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función recorre las entradas de un directorio dada su ruta (ver la versión que recibe un manejador).			*
+ *																	*
+ * ENTRADA: Path: Path al directorio a recorrer (cadena de nombres de directorio separados por '/').					*
+ *	    Visitante: Función a llamar por cada entrada (si devuelve false se deja de recorrer).					*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::RecorrerDirectorio(const char *Path, const TVisitanteDirectorio &Visitante)
+{
+TManejadorArchivo	Manejador;
+int			CodError;
+
+/* Ubicar el directorio */
+CodError=Abrir(Path, Manejador);
+if (CodError==CODERROR_ARCHIVO_INEXISTENTE)
+	return(CODERROR_DIRECTORIO_INEXISTENTE);
+if (CodError!=CODERROR_NINGUNO)
+	return(CodError);
+if (!(Manejador.Flags&fedDIRECTORIO))
+	return(CODERROR_DIRECTORIO_INEXISTENTE);
+
+/* Recorrerlo */
+return(RecorrerDirectorio(Manejador, Visitante));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverBase :: LeerArchivo							*
+ *																	*
+ * OBJETIVO: Esta función levanta de la imágen un archivo dada su ruta.									*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo a levantar.												*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Data: Buffer alocado con malloc() con los datos del archivo.									*
+ *	   DataLen: Tamaño en bytes del buffer devuelto.										*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::LeerArchivo(const char *Path, unsigned char *&Data, __u64 &DataLen)
+{
+TManejadorArchivo	Manejador;
+int			CodError;
+
+/* Ubicar el archivo y levantarlo */
+Data=NULL;
+DataLen=0;
+if ( (CodError=AbrirArchivo(Path, Manejador)) != CODERROR_NINGUNO )
+	return(CodError);
+return(LeerArchivo(Manejador, Data, DataLen));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverBase :: LeerArchivo							*
+ *																	*
+ * OBJETIVO: Esta función levanta de la imágen un archivo ya abierto.									*
+ *																	*
+ * ENTRADA: Manejador: Manejador del archivo a levantar.										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Data: Buffer alocado con malloc() con los datos del archivo.									*
+ *	   DataLen: Tamaño en bytes del buffer devuelto.										*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::LeerArchivo(const TManejadorArchivo &Manejador, unsigned char *&Data, __u64 &DataLen)
+{
+__u64	Leidos;
+int	CodError;
+
+/* Inicializar */
+Data=NULL;
+DataLen=0;
+if (!Manejador.Bytes)
+	return(CODERROR_NINGUNO);
+
+/* El archivo tiene que ser direccionable en este proceso */
+if (Manejador.Bytes>(__u64)SIZE_MAX)
+	return(CODERROR_ARCHIVO_INVALIDO);
+if ( (Data=(unsigned char *)malloc((size_t)Manejador.Bytes)) == NULL )
+	return(CODERROR_FALTA_MEMORIA);
+
+/* Leer el archivo entero */
+if ( (CodError=LeerRangoArchivo(Manejador, 0, Manejador.Bytes, Data, Leidos)) != CODERROR_NINGUNO )
+    {
+	free(Data);
+	Data=NULL;
+	return(CodError);
+    }
+DataLen=Leidos;
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverBase :: LeerRangoArchivo							*
+ *																	*
+ * OBJETIVO: Esta función lee de la imágen una parte de un archivo dada su ruta, en un buffer del llamador.				*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo a leer.												*
+ *	    Offset: Posición dentro del archivo del primer byte a leer.									*
+ *	    Longitud: Cantidad de bytes a leer.												*
+ *	    Destino: Buffer de al menos Longitud bytes.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Leidos: Cantidad de bytes copiados a Destino (menos que Longitud si el rango pasa el fin del archivo).			*
+ *	   TamanoArchivo: Tamaño en bytes del archivo.											*
+ *																	*
+ * OBSERVACIONES: Para leer un archivo por partes conviene abrirlo una vez y usar la versión que recibe el manejador.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::LeerRangoArchivo(const char *Path, __u64 Offset, __u64 Longitud, unsigned char *Destino, __u64 &Leidos, __u64 &TamanoArchivo)
+{
+TManejadorArchivo	Manejador;
+int			CodError;
+
+/* Ubicar el archivo y leer el rango */
+Leidos=0;
+TamanoArchivo=0;
+if ( (CodError=AbrirArchivo(Path, Manejador)) != CODERROR_NINGUNO )
+	return(CodError);
+TamanoArchivo=Manejador.Bytes;
+return(LeerRangoArchivo(Manejador, Offset, Longitud, Destino, Leidos));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverBase :: MapearArchivo							*
+ *																	*
+ * OBJETIVO: Esta función devuelve dónde está cada tramo de un archivo dentro de la imágen dada su ruta, sin leer sus datos.		*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo a mapear.												*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Extents: Tramos del archivo en orden, cubriéndolo entero (los huecos marcados como tales).					*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::MapearArchivo(const char *Path, std::vector<TExtentArchivo> &Extents)
+{
+TManejadorArchivo	Manejador;
+int			CodError;
+
+/* Ubicar el archivo y mapearlo */
+Extents.clear();
+if ( (CodError=AbrirArchivo(Path, Manejador)) != CODERROR_NINGUNO )
+	return(CodError);
+return(MapearArchivo(Manejador, Extents));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							   TDriverBase :: Stat								*
+ *																	*
+ * OBJETIVO: Esta función levanta la entrada de directorio de un archivo o directorio dada su ruta, sin listar su directorio padre.	*
+ *																	*
+ * ENTRADA: Path: Ruta absoluta al archivo o directorio.										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Entrada: Datos de la entrada, con el último componente de la ruta como nombre ("/" para la raíz).				*
+ *																	*
+ * OBSERVACIONES: La búsqueda corta en la primer entrada que coincide con cada componente de la ruta.					*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::Stat(const char *Path, TEntradaDirectorio &Entrada)
+{
+TManejadorArchivo	Manejador;
+const char		*Inicio, *Fin;
+int			CodError;
+
+/* Ubicar el archivo y levantar sus datos */
+if ( (CodError=Abrir(Path, Manejador)) != CODERROR_NINGUNO )
+	return(CodError);
+if ( (CodError=Stat(Manejador, Entrada)) != CODERROR_NINGUNO )
+	return(CodError);
+
+/* El nombre es el último componente de la ruta (ignorando las '/' finales) */
+Fin=Path+strlen(Path);
+while ( (Fin>Path+1) && (Fin[-1]=='/') )
+	Fin--;
+Inicio=Fin;
+while ( (Inicio>Path) && (Inicio[-1]!='/') )
+	Inicio--;
+if (Inicio==Fin)
+	Entrada.Nombre.assign("/");
+else
+	Entrada.Nombre.assign(Inicio, Fin-Inicio);
+
+/* Salir */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverBase :: ManejadorEntrada							*
+ *																	*
+ * OBJETIVO: Esta función arma el manejador de un archivo o directorio a partir de su entrada de directorio.				*
+ *																	*
+ * ENTRADA: Entrada: Entrada devuelta por RecorrerDirectorio().										*
+ *																	*
+ * SALIDA: Manejador: Manejador equivalente al que devolvería Abrir() con su ruta.							*
+ *																	*
+ * OBSERVACIONES: Las entradas y los manejadores guardan los mismos datos específicos de cada filesystem.				*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverBase::ManejadorEntrada(const TEntradaDirectorio &Entrada, TManejadorArchivo &Manejador)
+{
+memset(&Manejador, 0, sizeof(Manejador));
+Manejador.Flags=Entrada.Flags;
+Manejador.Bytes=Entrada.Bytes;
+memcpy(&Manejador.DatosEspecificos, &Entrada.DatosEspecificos, sizeof(Manejador.DatosEspecificos));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverBase :: Identificador							*
+ *																	*
+ * OBJETIVO: Esta función devuelve un número que identifica al objeto del filesystem al que apunta un manejador.			*
+ *																	*
+ * ENTRADA: Manejador: Manejador del archivo o directorio.										*
+ *																	*
+ * SALIDA: En el nombre de la función el identificador (número de inode, índice en la MFT o primer cluster), 0 si no tiene.		*
+ *																	*
+ * OBSERVACIONES: Dos rutas con el mismo identificador son el mismo objeto (hard links, o un ciclo si es un directorio).		*
+ *																	*
+ ****************************************************************************************************************************************/
+__u64 TDriverBase::Identificador(const TManejadorArchivo &Manejador)
+{
+switch (DatosFS.TipoFilesystem)
+    {
+	case tfsFAT12:
+	case tfsFAT16:
+	case tfsFAT32:
+		return(Manejador.DatosEspecificos.FAT.PrimerCluster);
+	case tfsEXT2:
+	case tfsEXT3:
+	case tfsEXT4:
+		return(Manejador.DatosEspecificos.EXT.INode);
+	case tfsNTFS:
+		return(Manejador.DatosEspecificos.NTFS.IndiceMFT);
+	default:
+		return(0);
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverBase :: AdmiteHilos							*
+ *																	*
+ * OBJETIVO: Esta función indica si se puede llamar al driver desde varios hilos a la vez.						*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función true si la fuente de la imágen admite lecturas concurrentes.					*
+ *																	*
+ * OBSERVACIONES: El estado que los drivers comparten entre llamadas (como las caches de inodes y de nombres de EXT) está protegido	*
+ *		  por sus propios mutex, así que depende sólo de la fuente.								*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TDriverBase::AdmiteHilos(void)
+{
+return( (Fuente) && (Fuente->Concurrente()) );
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverBase :: LeerContadores							*
+ *																	*
+ * OBJETIVO: Esta función retorna cuánto se leyó de la imágen desde que se creó el driver.						*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Contadores: Sectores que se accedieron con PunteroASector() y bytes copiados en bloque (LeerRangos() y exportaciones).	*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverBase::LeerContadores(TContadoresDriver &Contadores)
+{
+Contadores.Sectores=SectoresAccedidos.load(std::memory_order_relaxed);
+Contadores.Bytes=BytesCopiados.load(std::memory_order_relaxed);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverBase :: ExportarArchivo							*
+ *																	*
+ * OBJETIVO: Esta función copia el contenido de un archivo de la imágen a un archivo del host.						*
+ *																	*
+ * ENTRADA: Manejador: Archivo obtenido con Abrir().											*
+ *	    Destino: Archivo del host abierto para escritura (queda con el tamaño del archivo de la imágen).				*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Cada tramo se escribe con pwrite() directamente desde la imágen cuando está en memoria (EnMemoria()), sin copias	*
+ *		  intermedias. Con las demás fuentes cada tramo se lee con Leer() a un buffer acotado que se reusa. Los huecos no se	*
+ *		  escriben, así que el archivo queda disperso también en el host. Si el driver no sabe ubicar los tramos se lee con	*
+ *		  LeerRangoArchivo() al mismo buffer.											*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverBase::ExportarArchivo(const TManejadorArchivo &Manejador, FILE *Destino)
+{
+std::vector<TExtentArchivo>	Extents;
+std::vector<unsigned char>	Buffer;
+const unsigned char		*Datos;
+__u64				Offset, Hecho, Tramo, Leidos;
+unsigned			i;
+int				Fd, CodError;
+ssize_t				Escritos;
+
+/* Ver si tengo imágen cargada */
+if (!Fuente)
+	return(CODERROR_LECTURA_DISCO);
+
+/* Dejar el destino con su tamaño final */
+Fd=fileno(Destino);
+if (ftruncate(Fd, (off_t)Manejador.Bytes) != 0)
+	return(CODERROR_ESCRITURA_DISCO);
+if (!Manejador.Bytes)
+	return(CODERROR_NINGUNO);
+
+/* Ubicar los datos en la imágen */
+CodError=MapearArchivo(Manejador, Extents);
+if (CodError==CODERROR_NO_IMPLEMENTADO)
+    {
+	/* El driver no sabe dar los tramos, copiar de a pedazos leídos */
+	Buffer.resize(EXPORTAR_TAM_TRAMO);
+	for (Hecho=0; Hecho<Manejador.Bytes; Hecho+=Leidos)
+	    {
+		Tramo=Manejador.Bytes-Hecho;
+		if (Tramo>EXPORTAR_TAM_TRAMO)
+			Tramo=EXPORTAR_TAM_TRAMO;
+		if ( (CodError=LeerRangoArchivo(Manejador, Hecho, Tramo, Buffer.data(), Leidos)) != CODERROR_NINGUNO )
+			return(CodError);
+		if (!Leidos)
+			break;
+		if (pwrite(Fd, Buffer.data(), (size_t)Leidos, (off_t)Hecho) != (ssize_t)Leidos)
+			return(CODERROR_ESCRITURA_DISCO);
+	    }
+	return(CODERROR_NINGUNO);
+    }
+if (CodError!=CODERROR_NINGUNO)
+	return(CodError);
+
+/* Escribir cada tramo de a pedazos acotados */
+for (i=0; i<Extents.size(); i++)
+    {
+	/* Los huecos ya son ceros en el destino */
+	if (Extents[i].Hueco)
+		continue;
+
+	for (Hecho=0; Hecho<Extents[i].Longitud; Hecho+=Tramo)
+	    {
+		Tramo=Extents[i].Longitud-Hecho;
+		if (Tramo>EXPORTAR_TAM_TRAMO)
+			Tramo=EXPORTAR_TAM_TRAMO;
+		Offset=Extents[i].OffsetImagen+Hecho;
+
+		/* Las imágenes en memoria se escriben desde la misma imágen, las demás se leen al buffer (la cache levantaría el tramo a sus bloques) */
+		if (Fuente->EnMemoria())
+		    {
+			if ( (Datos=Fuente->PunteroARango(Offset, (unsigned)Tramo)) == NULL )
+				return(CODERROR_LECTURA_DISCO);
+		    }
+		else
+		    {
+			Buffer.resize(EXPORTAR_TAM_TRAMO);
+			if (Fuente->Leer(Offset, Tramo, Buffer.data()) != CODERROR_NINGUNO)
+				return(CODERROR_LECTURA_DISCO);
+			Datos=Buffer.data();
+		    }
+		Escritos=pwrite(Fd, Datos, (size_t)Tramo, (off_t)(Extents[i].OffsetArchivo+Hecho));
+		if (Datos!=Buffer.data())
+			Fuente->SoltarRango(Datos);
+		if (Escritos != (ssize_t)Tramo)
+			return(CODERROR_ESCRITURA_DISCO);
+		BytesCopiados.fetch_add(Tramo, std::memory_order_relaxed);
+	    }
+    }
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
 }
 
 
@@ -97,35 +618,35 @@ int TDriverBase::MostrarDatosSuperbloque(void)
 unsigned	i;
 
 /* Mostrar los datos que tenga */
-printf("Datos del superbloque:\n");
+Salida->Printf("Datos del superbloque:\n");
 
 /* Tipo de Filesystem */
 switch (DatosFS.TipoFilesystem)
     {
 	case tfsFAT12:
-		printf("\tFormato                 : FAT12\n");
+		Salida->Printf("\tFormato                 : FAT12\n");
 		break;
 	case tfsFAT16:
-		printf("\tFormato                 : FAT16\n");
+		Salida->Printf("\tFormato                 : FAT16\n");
 		break;
 	case tfsFAT32:
-		printf("\tFormato                 : FAT32\n");
+		Salida->Printf("\tFormato                 : FAT32\n");
 		break;
 	case tfsEXT2:
-		printf("\tFormato                 : EXT2\n");
+		Salida->Printf("\tFormato                 : EXT2\n");
 		break;
 	case tfsEXT3:
-		printf("\tFormato                 : EXT3\n");
+		Salida->Printf("\tFormato                 : EXT3\n");
 		break;
 	case tfsEXT4:
-		printf("\tFormato                 : EXT4\n");
+		Salida->Printf("\tFormato                 : EXT4\n");
 		break;
     }
 
 /* Mostrar los valores comunes a todos los Filesystems */
-printf("\tBytes/Sector            : %d\n", DatosFS.BytesPorSector);
-printf("\tBytes/Cluster           : %d\n", DatosFS.BytesPorCluster);
-printf("\tNro Clusters            : %d\n", DatosFS.NumeroDeClusters);
+Salida->Printf("\tBytes/Sector            : %d\n", DatosFS.BytesPorSector);
+Salida->Printf("\tBytes/Cluster           : %d\n", DatosFS.BytesPorCluster);
+Salida->Printf("\tNro Clusters            : %llu\n", DatosFS.NumeroDeClusters);
 
 /* Mostrar los valores propios de cada Filesystem */
 switch (DatosFS.TipoFilesystem)
@@ -133,50 +654,50 @@ switch (DatosFS.TipoFilesystem)
 	case tfsFAT12:
 	case tfsFAT16:
 	case tfsFAT32:
-		printf("\tNro Sectores            : %d\n", DatosFS.DatosEspecificos.FAT.TotalSectores);
-		printf("\tNro Sectores Ocultos    : %d\n", DatosFS.DatosEspecificos.FAT.SectoresOcultos);
-		printf("\tNro Sectores Reservados : %d\n", DatosFS.DatosEspecificos.FAT.SectoresReservados);
-		printf("\tNro copias FAT          : %d\n", DatosFS.DatosEspecificos.FAT.CopiasFAT);
-		printf("\tNro entradas RootDir    : %d\n", DatosFS.DatosEspecificos.FAT.EntradasRootDir);
-		printf("\tSectores/Cluster        : %d\n", DatosFS.DatosEspecificos.FAT.SectoresPorCluster);
-		printf("\tSectores/FAT            : %d\n", DatosFS.DatosEspecificos.FAT.SectoresPorFAT);
-		printf("\tNro Clusters RootDir    : %d\n", DatosFS.DatosEspecificos.FAT.ClustersRootDir);
-		printf("\t1er Cluster RootDir     : %d\n", DatosFS.DatosEspecificos.FAT.PrimerClusterRootDir);
+		Salida->Printf("\tNro Sectores            : %d\n", DatosFS.DatosEspecificos.FAT.TotalSectores);
+		Salida->Printf("\tNro Sectores Ocultos    : %d\n", DatosFS.DatosEspecificos.FAT.SectoresOcultos);
+		Salida->Printf("\tNro Sectores Reservados : %d\n", DatosFS.DatosEspecificos.FAT.SectoresReservados);
+		Salida->Printf("\tNro copias FAT          : %d\n", DatosFS.DatosEspecificos.FAT.CopiasFAT);
+		Salida->Printf("\tNro entradas RootDir    : %d\n", DatosFS.DatosEspecificos.FAT.EntradasRootDir);
+		Salida->Printf("\tSectores/Cluster        : %d\n", DatosFS.DatosEspecificos.FAT.SectoresPorCluster);
+		Salida->Printf("\tSectores/FAT            : %d\n", DatosFS.DatosEspecificos.FAT.SectoresPorFAT);
+		Salida->Printf("\tNro Clusters RootDir    : %d\n", DatosFS.DatosEspecificos.FAT.ClustersRootDir);
+		Salida->Printf("\t1er Cluster RootDir     : %d\n", DatosFS.DatosEspecificos.FAT.PrimerClusterRootDir);
 		break;
 	case tfsEXT2:
 	case tfsEXT3:
 	case tfsEXT4:
-		printf("\tCaract. Compatibles     : %04X\n", DatosFS.DatosEspecificos.EXT.CaracteristicasCompatibles);
-		printf("\tCaract. Incompatibles   : %04X\n", DatosFS.DatosEspecificos.EXT.CaracteristicasIncompatibles);
-		printf("\tCaract. Sólo Lectura    : %04X\n", DatosFS.DatosEspecificos.EXT.CaracteristicasSoloLectura);
-		printf("\tClusters/Grupo          : %d\n", DatosFS.DatosEspecificos.EXT.ClustersPorGrupo);
-		printf("\tINodes/Grupo            : %d\n", DatosFS.DatosEspecificos.EXT.INodesPorGrupo);
-		printf("\tBytes/INode             : %d\n", DatosFS.DatosEspecificos.EXT.BytesPorINode);
-		printf("\tNro INodes              : %d\n", DatosFS.DatosEspecificos.EXT.NumeroDeINodes);
-		printf("\tNro Grupos              : %d\n", DatosFS.DatosEspecificos.EXT.NroGrupos);
-		printf("\tPeríodo Agrupado Flex   : %d\n", DatosFS.DatosEspecificos.EXT.PeriodoAgrupadoFlex);
-		printf("\tNro Clust. reserv. GDT  : %d\n", DatosFS.DatosEspecificos.EXT.ClustersReservadosGDT);
-		printf("\tCluster Bitmap INodes   : ");
+		Salida->Printf("\tCaract. Compatibles     : %04X\n", DatosFS.DatosEspecificos.EXT.CaracteristicasCompatibles);
+		Salida->Printf("\tCaract. Incompatibles   : %04X\n", DatosFS.DatosEspecificos.EXT.CaracteristicasIncompatibles);
+		Salida->Printf("\tCaract. Sólo Lectura    : %04X\n", DatosFS.DatosEspecificos.EXT.CaracteristicasSoloLectura);
+		Salida->Printf("\tClusters/Grupo          : %d\n", DatosFS.DatosEspecificos.EXT.ClustersPorGrupo);
+		Salida->Printf("\tINodes/Grupo            : %d\n", DatosFS.DatosEspecificos.EXT.INodesPorGrupo);
+		Salida->Printf("\tBytes/INode             : %d\n", DatosFS.DatosEspecificos.EXT.BytesPorINode);
+		Salida->Printf("\tNro INodes              : %d\n", DatosFS.DatosEspecificos.EXT.NumeroDeINodes);
+		Salida->Printf("\tNro Grupos              : %d\n", DatosFS.DatosEspecificos.EXT.NroGrupos);
+		Salida->Printf("\tPeríodo Agrupado Flex   : %d\n", DatosFS.DatosEspecificos.EXT.PeriodoAgrupadoFlex);
+		Salida->Printf("\tNro Clust. reserv. GDT  : %d\n", DatosFS.DatosEspecificos.EXT.ClustersReservadosGDT);
+		Salida->Printf("\tCluster Bitmap INodes   : ");
 		for(i=0;i<DatosFS.DatosEspecificos.EXT.NroGrupos;i++)
-			printf("%llu%s", DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterBitmapINodes, i!=(DatosFS.DatosEspecificos.EXT.NroGrupos-1)? ", ":"\n");
-		printf("\tCluster Tabla INodes    : ");
+			Salida->Printf("%llu%s", DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterBitmapINodes, i!=(DatosFS.DatosEspecificos.EXT.NroGrupos-1)? ", ":"\n");
+		Salida->Printf("\tCluster Tabla INodes    : ");
 		for(i=0;i<DatosFS.DatosEspecificos.EXT.NroGrupos;i++)
-			printf("%llu%s", DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterTablaINodes, i!=(DatosFS.DatosEspecificos.EXT.NroGrupos-1)? ", ":"\n");
-		printf("\tCluster Bitmap Bloques  : ");
+			Salida->Printf("%llu%s", DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterTablaINodes, i!=(DatosFS.DatosEspecificos.EXT.NroGrupos-1)? ", ":"\n");
+		Salida->Printf("\tCluster Bitmap Bloques  : ");
 		for(i=0;i<DatosFS.DatosEspecificos.EXT.NroGrupos;i++)
-			printf("%llu%s", DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterBitmapBloques, i!=(DatosFS.DatosEspecificos.EXT.NroGrupos-1)? ", ":"\n");
-		printf("\tCluster Tabla Bloques   : ");
+			Salida->Printf("%llu%s", DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterBitmapBloques, i!=(DatosFS.DatosEspecificos.EXT.NroGrupos-1)? ", ":"\n");
+		Salida->Printf("\tCluster Tabla Bloques   : ");
 		for(i=0;i<DatosFS.DatosEspecificos.EXT.NroGrupos;i++)
-			printf("%llu%s", DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterTablaBloques, i!=(DatosFS.DatosEspecificos.EXT.NroGrupos-1)? ", ":"\n");
+			Salida->Printf("%llu%s", DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterTablaBloques, i!=(DatosFS.DatosEspecificos.EXT.NroGrupos-1)? ", ":"\n");
 		break;
 	case tfsNTFS:
-		printf("\tOffset Part en Sectores : %d\n", DatosFS.DatosEspecificos.NTFS.OffsetParticionEnSectores);
-		printf("\tNro Sectores            : %lld\n", DatosFS.DatosEspecificos.NTFS.TotalSectores);
-		printf("\tSectores/Cluster        : %d\n", DatosFS.DatosEspecificos.NTFS.SectoresPorCluster);
-		printf("\tBytes/FileRecordSegment : %d\n", DatosFS.DatosEspecificos.NTFS.BytesPorFileRecordSegment);
-		printf("\tBytes/IndexBuffer       : %d\n", DatosFS.DatosEspecificos.NTFS.BytesPorIndexBuffer);
-		printf("\tNro Cluster $MFT        : %llu\n", DatosFS.DatosEspecificos.NTFS.ClusterMFT);
-		printf("\tNro Cluster $MFT Mirror : %llu\n", DatosFS.DatosEspecificos.NTFS.ClusterMFTMirror);
+		Salida->Printf("\tOffset Part en Sectores : %d\n", DatosFS.DatosEspecificos.NTFS.OffsetParticionEnSectores);
+		Salida->Printf("\tNro Sectores            : %lld\n", DatosFS.DatosEspecificos.NTFS.TotalSectores);
+		Salida->Printf("\tSectores/Cluster        : %d\n", DatosFS.DatosEspecificos.NTFS.SectoresPorCluster);
+		Salida->Printf("\tBytes/FileRecordSegment : %d\n", DatosFS.DatosEspecificos.NTFS.BytesPorFileRecordSegment);
+		Salida->Printf("\tBytes/IndexBuffer       : %d\n", DatosFS.DatosEspecificos.NTFS.BytesPorIndexBuffer);
+		Salida->Printf("\tNro Cluster $MFT        : %llu\n", DatosFS.DatosEspecificos.NTFS.ClusterMFT);
+		Salida->Printf("\tNro Cluster $MFT Mirror : %llu\n", DatosFS.DatosEspecificos.NTFS.ClusterMFTMirror);
 		break;
     }
 
@@ -187,151 +708,171 @@ return(CODERROR_NINGUNO);
 
 /****************************************************************************************************************************************
  *																	*
- *						     TDriverBase :: MostrarDatosDirectorio						*
+ *					       TDriverBase :: MostrarEncabezadoDirectorio						*
  *																	*
- * OBJETIVO: Esta función muestra en contenido de un directorio.									*
+ * OBJETIVO: Esta función muestra el encabezado de la tabla con el contenido de un directorio.						*
  *																	*
- * ENTRADA: Entradas: Arreglo de estructuras con las entradas (archivos/directorios/etc) a mostrar.					*
+ * ENTRADA: Nada.															*
  *																	*
- * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ * SALIDA: Nada.															*
  *																	*
  ****************************************************************************************************************************************/
-int TDriverBase::MostrarDatosDirectorio(std::vector<TEntradaDirectorio> &Entradas)
+void TDriverBase::MostrarEncabezadoDirectorio(void)
 {
-char	aux[65];
-int	i;
-tm	*LocalTime;
-
 /* Primer fila del encabezado */
-printf(" Fecha Creación   Fecha Ult Acceso  Fecha Ult Modif                                Nombre                                 Flags     Tamaño  ");
+Salida->Printf(" Fecha Creación   Fecha Ult Acceso  Fecha Ult Modif                                Nombre                                 Flags     Tamaño  ");
 switch(DatosFS.TipoFilesystem)
     {
 	case tfsFAT12:
 	case tfsFAT16:
 	case tfsFAT32:
-		printf("   1º Clu  ");
+		Salida->Printf("   1º Clu  ");
 		break;
 	case tfsEXT2:
 	case tfsEXT3:
 	case tfsEXT4:
-		printf("    INode   ");
+		Salida->Printf("    INode   ");
 		break;
 	case tfsNTFS:
-		printf("   Índice MFT     Sec ");
+		Salida->Printf("   Índice MFT     Sec ");
 		break;
     }
-printf("\n");
+Salida->Printf("\n");
 
 /* Segunda fila del encabezado */
-printf("----------------- ----------------- ----------------- ---------------------------------------------------------------- ----------- ----------");
+Salida->Printf("----------------- ----------------- ----------------- ---------------------------------------------------------------- ----------- ----------");
 switch(DatosFS.TipoFilesystem)
     {
 	case tfsFAT12:
 	case tfsFAT16:
 	case tfsFAT32:
-		printf(" ----------");
+		Salida->Printf(" ----------");
 		break;
 	case tfsEXT2:
 	case tfsEXT3:
 	case tfsEXT4:
-		printf(" -----------");
+		Salida->Printf(" -----------");
 		break;
 	case tfsNTFS:
-		printf(" --------------- ----");
+		Salida->Printf(" --------------- ----");
 		break;
     }
-printf("\n");
+Salida->Printf("\n");
+}
+
 
-/* Para cada entrada de directorio a mostrar */
-for(i=0;i<Entradas.size();i++)
+/****************************************************************************************************************************************
+ *																	*
+ *						 TDriverBase :: MostrarEntradaDirectorio						*
+ *																	*
+ * OBJETIVO: Esta función muestra la línea de una entrada de directorio (debajo del encabezado de MostrarEncabezadoDirectorio()).	*
+ *																	*
+ * ENTRADA: Entrada: Entrada (archivo/directorio/etc) a mostrar.									*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverBase::MostrarEntradaDirectorio(const TEntradaDirectorio &Entrada)
+{
+size_t	Longitud;
+char	*p;
+
+/* Mostrar las fechas de creación, último acceso y última modificación */
+MostrarFecha(Entrada.FechaCreacion);
+MostrarFecha(Entrada.FechaUltimoAcceso);
+MostrarFecha(Entrada.FechaUltimaModificacion);
+
+/* Mostrar el nombre (a lo sumo 64 caracteres, alineado a derecha) */
+Longitud=strnlen(Entrada.Nombre.c_str(), 64);
+Salida->Repetir(' ', 64-Longitud);
+Salida->Bytes(Entrada.Nombre.c_str(), Longitud);
+
+/* Imprimir los flags (si no hay lugar en la salida, el error queda pendiente en ella) */
+if ( (p=Salida->Reservar(12)) == NULL )
+	return;
+p[ 0]=' ';
+p[ 1]=Entrada.Flags&fedSOLO_LECTURA     ? 'R' : ' ';
+p[ 2]=Entrada.Flags&fedOCULTO           ? 'H' : ' ';
+p[ 3]=Entrada.Flags&fedSISTEMA          ? 'S' : ' ';
+p[ 4]=Entrada.Flags&fedETIQUETA_VOLUMEN ? 'V' : ' ';
+p[ 5]=Entrada.Flags&fedDIRECTORIO       ? 'D' : ' ';
+p[ 6]=Entrada.Flags&fedARCHIVAR         ? 'A' : ' ';
+p[ 7]=Entrada.Flags&fedACCESO_DIRECTO   ? 'L' : ' ';
+p[ 8]=Entrada.Flags&fedCOMPRIMIDO       ? 'C' : ' ';
+p[ 9]=Entrada.Flags&fedENCRIPTADO       ? 'E' : ' ';
+p[10]=Entrada.Flags&fedDISPERSO         ? 'P' : ' ';
+p[11]=' ';
+Salida->Avanzar(12);
+
+/* Colocar el tamaño */
+Salida->Caracter(' ');
+Salida->Decimal(Entrada.Bytes, 10);
+
+/* Mostrar columnas FS dependientes */
+switch(DatosFS.TipoFilesystem)
     {
-	/* Mostrar la fecha de creación */
-	if (!Entradas[i].FechaCreacion)
-	    {
-		/* No tengo esa fecha, dejarla en blanco */
-		printf("                  ");
-	    }
-	else
-	    {
-		/* Convertir el valor a HMS */
-		LocalTime=localtime(&Entradas[i].FechaCreacion);
-		printf("%02d/%02d/%04d %02d:%02d  ", LocalTime->tm_mday, 1+LocalTime->tm_mon, 1900+LocalTime->tm_year, LocalTime->tm_hour, LocalTime->tm_min);
-	    }
+	case tfsFAT12:
+	case tfsFAT16:
+	case tfsFAT32:
+		/* Colocar el primer cluster */
+		Salida->Caracter(' ');
+		Salida->Decimal(Entrada.DatosEspecificos.FAT.PrimerCluster, 10);
+		break;
+	case tfsEXT2:
+	case tfsEXT3:
+	case tfsEXT4:
+		Salida->Caracter(' ');
+		Salida->Decimal(Entrada.DatosEspecificos.EXT.INode, 11);
+		break;
+	case tfsNTFS:
+		Salida->Caracter(' ');
+		Salida->Decimal(Entrada.DatosEspecificos.NTFS.IndiceMFT, 15);
+		Salida->Caracter(' ');
+		Salida->Hexa(Entrada.DatosEspecificos.NTFS.NroSecuencia, 4, true);
+    }
 
-	/* Mostrar la fecha de último acceso */
-	if (!Entradas[i].FechaUltimoAcceso)
-	    {
-		/* No tengo esa fecha, dejarla en blanco */
-		printf("                  ");
-	    }
-	else
-	    {
-		/* Convertir el valor a HMS */
-		LocalTime=localtime(&Entradas[i].FechaUltimoAcceso);
-		printf("%02d/%02d/%04d %02d:%02d  ", LocalTime->tm_mday, 1+LocalTime->tm_mon, 1900+LocalTime->tm_year, LocalTime->tm_hour, LocalTime->tm_min);
-	    }
-	
-	/* Mostrar la fecha de última modificación */
-	if (!Entradas[i].FechaUltimaModificacion)
-	    {
-		/* No tengo esa fecha, dejarla en blanco */
-		printf("                  ");
-	    }
-	else
-	    {
-		/* Convertir el valor a HMS */
-		LocalTime=localtime(&Entradas[i].FechaUltimaModificacion);
-		printf("%02d/%02d/%04d %02d:%02d  ", LocalTime->tm_mday, 1+LocalTime->tm_mon, 1900+LocalTime->tm_year, LocalTime->tm_hour, LocalTime->tm_min);
-	    }
+/* Cerrar la línea */
+Salida->Caracter('\n');
+}
 
-	/* Mostrar el nombre */
-	strncpy(aux, Entradas[i].Nombre.c_str(), 64);
-	aux[64]='\0';
-	printf("%64s", aux);
-	
-	/* Imprimir los flags */
-	printf(" ");
-	printf("%c", Entradas[i].Flags&fedSOLO_LECTURA     ? 'R' : ' ');
-	printf("%c", Entradas[i].Flags&fedOCULTO           ? 'H' : ' ');
-	printf("%c", Entradas[i].Flags&fedSISTEMA          ? 'S' : ' ');
-	printf("%c", Entradas[i].Flags&fedETIQUETA_VOLUMEN ? 'V' : ' ');
-	printf("%c", Entradas[i].Flags&fedDIRECTORIO       ? 'D' : ' ');
-	printf("%c", Entradas[i].Flags&fedARCHIVAR         ? 'A' : ' ');
-	printf("%c", Entradas[i].Flags&fedACCESO_DIRECTO   ? 'L' : ' ');
-	printf("%c", Entradas[i].Flags&fedCOMPRIMIDO       ? 'C' : ' ');
-	printf("%c", Entradas[i].Flags&fedENCRIPTADO       ? 'E' : ' ');
-	printf("%c", Entradas[i].Flags&fedDISPERSO         ? 'P' : ' ');
-	printf(" ");
-
-
-	/* Colocar el tamaño */
-	printf(" %10llu", Entradas[i].Bytes);
-
-	/* Mostrar columnas FS dependientes */
-	switch(DatosFS.TipoFilesystem)
-	    {
-		case tfsFAT12:
-		case tfsFAT16:
-		case tfsFAT32:
-			/* Colocar el primer cluster */
-			printf(" %10u", Entradas[i].DatosEspecificos.FAT.PrimerCluster);
-			break;
-		case tfsEXT2:
-		case tfsEXT3:
-		case tfsEXT4:
-			printf(" %11u", Entradas[i].DatosEspecificos.EXT.INode);
-			break;
-		case tfsNTFS:
-			printf(" %15llu", Entradas[i].DatosEspecificos.NTFS.IndiceMFT);
-			printf(" %04X", Entradas[i].DatosEspecificos.NTFS.NroSecuencia);
-	    }
 
-	/* Cerrar la línea */
-	printf("\n");
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverBase :: MostrarFecha							*
+ *																	*
+ * OBJETIVO: Esta función muestra una fecha de una entrada de directorio como "dd/mm/aaaa hh:mm  " (en hora local).			*
+ *																	*
+ * ENTRADA: Fecha: Fecha a mostrar (0 si la entrada no la tiene, en cuyo caso el campo queda en blanco).				*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverBase::MostrarFecha(time_t Fecha)
+{
+tm	Tiempo;
+char	*p;
+
+/* No tengo esa fecha, dejarla en blanco */
+if (!Fecha)
+    {
+	Salida->Repetir(' ', 18);
+	return;
     }
 
-/* Salir */
-return(CODERROR_NINGUNO);
+/* Armar el campo con el formateador (que cachea el desplazamiento UTC y el texto de cada minuto) */
+if ( (p=Salida->Reservar(18)) == NULL )
+	return;
+if (FormateadorFechas.Formatear(Fecha, p))
+    {
+	p[16]=' ';
+	p[17]=' ';
+	Salida->Avanzar(18);
+	return;
+    }
+
+/* Años de más de 4 dígitos no entran en el campo fijo, dejárselos a printf */
+localtime_r(&Fecha, &Tiempo);
+Salida->Printf("%02d/%02d/%04d %02d:%02d  ", Tiempo.tm_mday, 1+Tiempo.tm_mon, 1900+Tiempo.tm_year, Tiempo.tm_hour, Tiempo.tm_min);
 }
 
 
@@ -343,48 +884,45 @@ return(CODERROR_NINGUNO);
  *																	*
  *  ENTRADA: Buffer: Puntero al bloque binario.												*
  *	     BufferLen: Longitud del bloque a imprimir.											*
+ *	     BytesPorLinea: Cantidad de bytes por línea.										*
+ *	     Base: Offset a mostrar para el primer byte del bloque (para imprimir un archivo por partes).				*
  *																	*
  *  SALIDA: Nada.															*
  *																	*
  ****************************************************************************************************************************************/
-void TDriverBase::PrintBuffer(const unsigned char *Buffer, unsigned BufferLen, unsigned BytesPorLinea)
+void TDriverBase::PrintBuffer(const unsigned char *Buffer, __u64 BufferLen, unsigned BytesPorLinea, __u64 Base)
 {
-int	i, j;
+__u64		i;
+unsigned	n;
+char		*p;
 
 /* Inicializar la salida */
 i=0;
 while (i<BufferLen)
     {
 	/* Indentar la línea */
-	printf("    %08x    ", i);
+	Salida->Repetir(' ', 4);
+	Salida->Hexa(Base+i, 8, false);
+	Salida->Repetir(' ', 4);
 
-	/* Tomar un bloque de BytesPorLinea caracteres e imprimirlo como hexa */
-	for(j=i;j<(i+BytesPorLinea);j++)
-	    {
-		if (j<BufferLen)
-			printf("%02X ", Buffer[j]);
-		else
-			printf("   ");
-	    }
+	/* Reservar lugar para el resto de la línea: hexa, caracteres y fin de línea */
+	if ( (p=Salida->Reservar(4*BytesPorLinea+1)) == NULL )
+		return;
+
+	/* Tomar un bloque de BytesPorLinea caracteres y armar las columnas hexa y de caracteres de una pasada */
+	n=(unsigned)min((__u64)BytesPorLinea, BufferLen-i);
+	TCodificadorHexa::CodificarFila(Buffer+i, n, p, p+3*BytesPorLinea);
 
-	/* Tomar el mismo bloque e imprimirlo como caracteres */
-	for(j=i;j<(i+BytesPorLinea);j++)
+	/* Completar con espacios la última línea si quedó corta */
+	if (n<BytesPorLinea)
 	    {
-		if (j<BufferLen)
-		    {
-			if ( (Buffer[j]>=' ')||((Buffer[j]<0)) )
-				printf("%c", Buffer[j]);
-			else
-				printf(".");
-		    }
-		else
-		    {
-			printf(" ");
-		    }
+		memset(p+3*n, ' ', 3*(BytesPorLinea-n));
+		memset(p+3*BytesPorLinea+n, ' ', BytesPorLinea-n);
 	    }
 
 	/* Cerrar la línea */
-	printf("\n");
+	p[4*BytesPorLinea]='\n';
+	Salida->Avanzar(4*BytesPorLinea+1);
 
 	/* Pasar al siguiente bloque */
 	i+=BytesPorLinea;
@@ -392,10 +930,83 @@ while (i<BufferLen)
 }
 
 
+/********************************
+ *				*
+ *     Clase TSectorFijado	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *						     TSectorFijado :: TSectorFijado							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TSectorFijado::TSectorFijado()
+{
+/* Inicializar variables */
+Driver=NULL;
+Puntero=NULL;
+}
 
 
+/****************************************************************************************************************************************
+ *																	*
+ *						     TSectorFijado :: ~TSectorFijado							*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TSectorFijado::~TSectorFijado()
+{
+Soltar();
+}
 
 
+/****************************************************************************************************************************************
+ *																	*
+ *							 TSectorFijado :: Fijar								*
+ *																	*
+ * OBJETIVO: Esta función pide un sector al driver y lo mantiene fijado hasta Soltar(), el próximo Fijar() o la destrucción.		*
+ *																	*
+ * ENTRADA: Driver: Driver al que pedirle el sector.											*
+ *	    NroSector: Número de sector, como en TDriverBase::PunteroASector().								*
+ *																	*
+ * SALIDA: En el nombre de la función el puntero a los datos del sector, o NULL si no se pudo obtener.					*
+ *																	*
+ ****************************************************************************************************************************************/
+const unsigned char *TSectorFijado::Fijar(TDriverBase *Driver, __u64 NroSector)
+{
+/* Soltar el anterior antes de pedir el nuevo */
+Soltar();
+TSectorFijado::Driver=Driver;
+Puntero=Driver->PunteroASector(NroSector);
+return(Puntero);
+}
 
 
-
+/****************************************************************************************************************************************
+ *																	*
+ *							 TSectorFijado :: Soltar							*
+ *																	*
+ * OBJETIVO: Esta función suelta el sector fijado, si hay uno.										*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TSectorFijado::Soltar(void)
+{
+if (Puntero)
+	Driver->SoltarSector(Puntero);
+Puntero=NULL;
+}
\ No newline at end of file
@@ -1,6 +1,125 @@
 ﻿#include "all_heads.h"
 
 
+/************************
+ *			*
+ *     Funciones	*
+ *			*
+ ************************/
+/* Arma los bloques de entrada de half-MD4 y TEA con los bytes del nombre, rellenando con su longitud (str2hashbuf de ext4) */
+static void ArmarBloqueHash(const char *nombre, int long_nombre, unsigned *bloque, int palabras, bool sin_signo)
+{
+	unsigned relleno = (unsigned)long_nombre | ((unsigned)long_nombre << 8);
+	relleno |= relleno << 16;
+
+	unsigned valor = relleno;
+	if (long_nombre > palabras * 4)
+		long_nombre = palabras * 4;
+	for (int i = 0; i < long_nombre; i++)
+	{
+		int c = sin_signo ? (int)(unsigned char)nombre[i] : (int)(signed char)nombre[i];
+		valor = (unsigned)c + (valor << 8);
+		if ((i % 4) == 3)
+		{
+			*bloque++ = valor;
+			valor = relleno;
+			palabras--;
+		}
+	}
+	if (--palabras >= 0)
+		*bloque++ = valor;
+	while (--palabras >= 0)
+		*bloque++ = relleno;
+}
+
+/* Hash "legacy" de los primeros directorios indexados (dx_hack_hash de ext4) */
+static unsigned HashLegacy(const char *nombre, int long_nombre, bool sin_signo)
+{
+	unsigned hash, hash0 = 0x12a3fe2d, hash1 = 0x37abe8f9;
+
+	while (long_nombre--)
+	{
+		int c = sin_signo ? (int)(unsigned char)*nombre++ : (int)(signed char)*nombre++;
+		hash = hash1 + (hash0 ^ (unsigned)(c * 7152373));
+		if (hash & 0x80000000)
+			hash -= 0x7fffffff;
+		hash1 = hash0;
+		hash0 = hash;
+	}
+	return hash0 << 1;
+}
+
+/* Una vuelta de half-MD4 sobre 32 bytes del nombre */
+static void TransformarMitadMD4(unsigned estado[4], const unsigned entrada[8])
+{
+	unsigned a = estado[0], b = estado[1], c = estado[2], d = estado[3];
+
+	#define ROL32(x, s)			(((x) << (s)) | ((x) >> (32 - (s))))
+	#define F(x, y, z)			((z) ^ ((x) & ((y) ^ (z))))
+	#define G(x, y, z)			(((x) & (y)) + (((x) ^ (y)) & (z)))
+	#define H(x, y, z)			((x) ^ (y) ^ (z))
+	#define RONDA(f, a, b, c, d, x, s)	(a += f(b, c, d) + (x), a = ROL32(a, s))
+	#define K2				013240474631U
+	#define K3				015666365641U
+
+	RONDA(F, a, b, c, d, entrada[0],  3);
+	RONDA(F, d, a, b, c, entrada[1],  7);
+	RONDA(F, c, d, a, b, entrada[2], 11);
+	RONDA(F, b, c, d, a, entrada[3], 19);
+	RONDA(F, a, b, c, d, entrada[4],  3);
+	RONDA(F, d, a, b, c, entrada[5],  7);
+	RONDA(F, c, d, a, b, entrada[6], 11);
+	RONDA(F, b, c, d, a, entrada[7], 19);
+
+	RONDA(G, a, b, c, d, entrada[1] + K2,  3);
+	RONDA(G, d, a, b, c, entrada[3] + K2,  5);
+	RONDA(G, c, d, a, b, entrada[5] + K2,  9);
+	RONDA(G, b, c, d, a, entrada[7] + K2, 13);
+	RONDA(G, a, b, c, d, entrada[0] + K2,  3);
+	RONDA(G, d, a, b, c, entrada[2] + K2,  5);
+	RONDA(G, c, d, a, b, entrada[4] + K2,  9);
+	RONDA(G, b, c, d, a, entrada[6] + K2, 13);
+
+	RONDA(H, a, b, c, d, entrada[3] + K3,  3);
+	RONDA(H, d, a, b, c, entrada[7] + K3,  9);
+	RONDA(H, c, d, a, b, entrada[2] + K3, 11);
+	RONDA(H, b, c, d, a, entrada[6] + K3, 15);
+	RONDA(H, a, b, c, d, entrada[1] + K3,  3);
+	RONDA(H, d, a, b, c, entrada[5] + K3,  9);
+	RONDA(H, c, d, a, b, entrada[0] + K3, 11);
+	RONDA(H, b, c, d, a, entrada[4] + K3, 15);
+
+	#undef ROL32
+	#undef F
+	#undef G
+	#undef H
+	#undef RONDA
+	#undef K2
+	#undef K3
+
+	estado[0] += a;
+	estado[1] += b;
+	estado[2] += c;
+	estado[3] += d;
+}
+
+/* Una vuelta de TEA sobre 16 bytes del nombre */
+static void TransformarTEA(unsigned estado[4], const unsigned entrada[4])
+{
+	unsigned suma = 0;
+	unsigned b0 = estado[0], b1 = estado[1];
+
+	for (int n = 0; n < 16; n++)
+	{
+		suma += 0x9E3779B9;
+		b0 += ((b1 << 4) + entrada[0]) ^ (b1 + suma) ^ ((b1 >> 5) + entrada[1]);
+		b1 += ((b0 << 4) + entrada[2]) ^ (b0 + suma) ^ ((b0 >> 5) + entrada[3]);
+	}
+	estado[0] += b0;
+	estado[1] += b1;
+}
+
+
 /********************************
  *				*
  *	 Clase TDriverEXT	*
@@ -12,14 +131,15 @@
  *																	*
  * OBJETIVO: Inicializar la clase recién creada.											*
  *																	*
- * ENTRADA: DiskData: Puntero a un bloque de memoria con la imágen del disco a analizar.						*
- *	    LongitudDiskData: Tamaño, en bytes, de la imágen a analizar.								*
+ * ENTRADA: Fuente: Origen de los datos de la imágen del disco a analizar.								*
  *																	*
  * SALIDA: Nada.															*
  *																	*
  ****************************************************************************************************************************************/
-TDriverEXT::TDriverEXT(const unsigned char *DiskData, unsigned LongitudDiskData) : TDriverBase(DiskData, LongitudDiskData)
+TDriverEXT::TDriverEXT(TFuenteSectores *Fuente) : TDriverBase(Fuente)
 {
+	memset(hash_semilla, 0, sizeof(hash_semilla));
+	hash_sin_signo = false;
 }
 
 
@@ -38,6 +158,44 @@ TDriverEXT::~TDriverEXT()
 {
 }
 
+
+/****************************************************************************************************************************************
+ *																	*
+ *							  TDriverEXT :: Sondear								*
+ *																	*
+ * OBJETIVO: Esta función revisa si la imágen tiene la firma del superbloque EXT, sin levantar los descriptores de grupo.		*
+ *																	*
+ * ENTRADA: Inicio: Primeros bytes de la imágen.											*
+ *	    Longitud: Cantidad de bytes en Inicio.											*
+ *																	*
+ * SALIDA: En el nombre de la función true si la imágen puede ser EXT2/EXT3/EXT4.							*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TDriverEXT::Sondear(const unsigned char *Inicio, unsigned Longitud)
+{
+	/* El superbloque empieza en el byte 1024, la firma 0xEF53 está en su offset 0x38 */
+	if (Longitud < 1024 + 0x3A)
+		return false;
+	return (Inicio[1024 + 0x38] | (Inicio[1024 + 0x39] << 8)) == 0xEF53;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							   TDriverEXT :: Crear								*
+ *																	*
+ * OBJETIVO: Esta función construye el driver (para el registro de drivers).								*
+ *																	*
+ * ENTRADA: Fuente: Origen de los datos de la imágen del disco a analizar.								*
+ *																	*
+ * SALIDA: En el nombre de la función el driver creado.											*
+ *																	*
+ ****************************************************************************************************************************************/
+TDriverBase *TDriverEXT::Crear(TFuenteSectores *Fuente)
+{
+return(new TDriverEXT(Fuente));
+}
+
 /****************************************************************************************************************************************
  *																	*
  *						   TDriverEXT :: LevantarDatosSuperbloque						*
@@ -57,7 +215,8 @@ int TDriverEXT::LevantarDatosSuperbloque()
 	DatosFS.BytesPorSector = 512;
 
 	/* El superbloque está a 1024 bytes desde el inicio (sector lógico 2) */
-	const unsigned char *sb = PunteroASector(2);
+	TSectorFijado sb_fijado;
+	const unsigned char *sb = sb_fijado.Fijar(this, 2);
 	if (!sb)
 		return CODERROR_SUPERBLOQUE_INVALIDO;
 
@@ -72,6 +231,7 @@ int TDriverEXT::LevantarDatosSuperbloque()
 	/* Leer campos básicos EXT2 del superbloque: */
 	unsigned s_inodes_count      = RD32(0x00);
 	unsigned s_blocks_count_lo   = RD32(0x04);
+	unsigned s_first_data_block  = RD32(0x14);
 	unsigned s_log_block_size    = RD32(0x18);
 	unsigned s_blocks_per_group  = RD32(0x20);
 	unsigned s_inodes_per_group  = RD32(0x28);
@@ -79,39 +239,67 @@ int TDriverEXT::LevantarDatosSuperbloque()
 	unsigned s_feat_compat       = RD32(0x5C);
 	unsigned s_feat_incompat     = RD32(0x60);
 	unsigned s_feat_ro_compat    = RD32(0x64);
-    unsigned s_r_blocks_count    = RD16(0xCE);
+	unsigned s_r_blocks_count    = RD16(0xCE);
+
+	/* Campos de EXT4 (sólo valen si está la feature correspondiente) */
+	unsigned s_desc_size         = RD16(0xFE);
+	unsigned s_blocks_count_hi   = RD32(0x150);
+	unsigned s_log_groups_per_flex = sb[0x174];
+
+	/* Semilla de los hash de los directorios indexados y si se calculan con char sin signo */
+	for (int i = 0; i < 4; i++)
+		hash_semilla[i] = RD32(0xEC + 4 * i);
+	hash_sin_signo = (RD32(0x160) & EXT2_FLAGS_UNSIGNED_HASH) != 0;
+
+	/* No sabemos leer filesystems con features incompatibles que no conocemos */
+	if (s_feat_incompat & ~EXT_FEATURE_INCOMPAT_SOPORTADAS)
+		return CODERROR_FEATURE_DESCONOCIDO;
+
+	/* El tipo sale de las features: EXT4 si usa alguna propia, EXT3 si tiene journal, sino EXT2 */
+	if ((s_feat_incompat & EXT4_FEATURE_INCOMPAT_PROPIAS) || (s_feat_ro_compat & EXT4_FEATURE_RO_COMPAT_PROPIAS))
+		DatosFS.TipoFilesystem = tfsEXT4;
+	else if (s_feat_compat & EXT3_FEATURE_COMPAT_HAS_JOURNAL)
+		DatosFS.TipoFilesystem = tfsEXT3;
+	else
+		DatosFS.TipoFilesystem = tfsEXT2;
 
 	/* BlockSize = 1024 << s_log_block_size */
-	DatosFS.TipoFilesystem               = tfsEXT2;
+	bool bits64 = (s_feat_incompat & EXT4_FEATURE_INCOMPAT_64BIT) != 0;
 	DatosFS.BytesPorCluster              = 1024u << s_log_block_size;
 	DatosFS.NumeroDeClusters             = s_blocks_count_lo;
+	if (bits64)
+		DatosFS.NumeroDeClusters |= ((unsigned long long)s_blocks_count_hi) << 32;
 
 	/* Campos específicos */
 	DatosFS.DatosEspecificos.EXT.CaracteristicasCompatibles   = (int)s_feat_compat;
 	DatosFS.DatosEspecificos.EXT.CaracteristicasIncompatibles = (int)s_feat_incompat;
 	DatosFS.DatosEspecificos.EXT.CaracteristicasSoloLectura   = (int)s_feat_ro_compat;
 	DatosFS.DatosEspecificos.EXT.NumeroDeINodes               = (int)s_inodes_count;
-    DatosFS.DatosEspecificos.EXT.ClustersReservadosGDT        = (int)s_r_blocks_count;
+	DatosFS.DatosEspecificos.EXT.ClustersReservadosGDT        = (int)s_r_blocks_count;
 	DatosFS.DatosEspecificos.EXT.ClustersPorGrupo             = (int)s_blocks_per_group;
 	DatosFS.DatosEspecificos.EXT.INodesPorGrupo               = (int)s_inodes_per_group;
 	DatosFS.DatosEspecificos.EXT.BytesPorINode                = (int)s_inode_size;
-	DatosFS.DatosEspecificos.EXT.PeriodoAgrupadoFlex = 0;
+	DatosFS.DatosEspecificos.EXT.PeriodoAgrupadoFlex = (s_feat_incompat & EXT4_FEATURE_INCOMPAT_FLEX_BG) ? (1 << s_log_groups_per_flex) : 0;
 
-	/* Derivados: número de grupos */
-	if (DatosFS.DatosEspecificos.EXT.ClustersPorGrupo == 0)
+	/* Derivados: número de grupos (el último puede estar incompleto) */
+	if (DatosFS.DatosEspecificos.EXT.ClustersPorGrupo == 0 || DatosFS.DatosEspecificos.EXT.INodesPorGrupo == 0)
 		return CODERROR_SUPERBLOQUE_INVALIDO;
 
-	DatosFS.DatosEspecificos.EXT.NroGrupos = DatosFS.NumeroDeClusters / DatosFS.DatosEspecificos.EXT.ClustersPorGrupo;
+	DatosFS.DatosEspecificos.EXT.NroGrupos = (int)((DatosFS.NumeroDeClusters - s_first_data_block + s_blocks_per_group - 1) / s_blocks_per_group);
 
-	/* Leer la Tabla de Descriptores de Grupo (GDT) con TEntradaDescGrupoEXT23 y completar DatosGrupo */
+	/* Leer la Tabla de Descriptores de Grupo (GDT) y completar DatosGrupo */
 	{
-		unsigned desc_size = sizeof(TEntradaDescGrupoEXT23);
+		/* Con 64 bits cada descriptor mide s_desc_size y tiene la parte alta de los números de bloque */
+		unsigned desc_size = bits64 ? s_desc_size : sizeof(TEntradaDescGrupoEXT23);
+		if (desc_size < sizeof(TEntradaDescGrupoEXT23) || desc_size > DatosFS.BytesPorCluster)
+			return CODERROR_SUPERBLOQUE_INVALIDO;
 		unsigned sectors_per_cluster = DatosFS.BytesPorCluster / DatosFS.BytesPorSector;
 
-		/* GDT comienza en el bloque 2 si el tamaño de bloque es 1024, sino en el bloque 1 */
-		unsigned gd_start_block = (DatosFS.BytesPorCluster == 1024) ? 2 : 1;
+		/* GDT comienza en el bloque que sigue al del superbloque (el 2 si el tamaño de bloque es 1024, sino el 1) */
+		unsigned gd_start_block = s_first_data_block + 1;
 
 		unsigned desc_per_block = DatosFS.BytesPorCluster / desc_size;
+		unsigned gdt_blocks = (DatosFS.DatosEspecificos.EXT.NroGrupos + desc_per_block - 1) / desc_per_block;
 
 		/* Preparar vector */
 		DatosFS.DatosEspecificos.EXT.DatosGrupo.clear();
@@ -120,9 +308,10 @@ int TDriverEXT::LevantarDatosSuperbloque()
 		for (int i = 0; i < DatosFS.DatosEspecificos.EXT.NroGrupos; i++)
 		{
 			unsigned block_index = gd_start_block + (i / desc_per_block);
-			unsigned sector = block_index * sectors_per_cluster;
+			__u64 sector = (__u64)block_index * sectors_per_cluster;
 
-			const unsigned char *pblock = PunteroASector(sector);
+			TSectorFijado pblock_fijado;
+			const unsigned char *pblock = pblock_fijado.Fijar(this, sector);
 			if (!pblock)
 				return CODERROR_SUPERBLOQUE_INVALIDO;
 
@@ -132,26 +321,46 @@ int TDriverEXT::LevantarDatosSuperbloque()
 			/* Lectura little endian desde p */
 			#define RD32P(o) ((unsigned int)(p[(o)] | (p[(o)+1] << 8) | (p[(o)+2] << 16) | (p[(o)+3] << 24)))
 
-			unsigned block_bitmap = RD32P(0);
-			unsigned inode_bitmap = RD32P(4);
-			unsigned inode_table  = RD32P(8);
-
-			DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterBitmapINodes = (unsigned long long)inode_bitmap;
-			DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterBitmapBloques = (unsigned long long)block_bitmap;
-			DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterTablaINodes = (unsigned long long)inode_table;
-
-			/* Calcular el primer bloque de datos del grupo, que está justo después de la tabla de inodos */
+			unsigned long long block_bitmap = RD32P(0);
+			unsigned long long inode_bitmap = RD32P(4);
+			unsigned long long inode_table  = RD32P(8);
+			if (bits64 && desc_size >= sizeof(TEntradaDescGrupoEXT4))
 			{
-				unsigned long long inodes_per_group = (unsigned long long)DatosFS.DatosEspecificos.EXT.INodesPorGrupo;
-				unsigned long long bytes_per_inode = (unsigned long long)DatosFS.DatosEspecificos.EXT.BytesPorINode;
-				unsigned long long bytes_per_cluster = (unsigned long long)DatosFS.BytesPorCluster;
-
-				unsigned long long inode_table_blocks = (inodes_per_group * bytes_per_inode + bytes_per_cluster - 1) / bytes_per_cluster;
-				DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterTablaBloques = (unsigned long long)inode_table + inode_table_blocks;
+				block_bitmap |= ((unsigned long long)RD32P(0x20)) << 32;
+				inode_bitmap |= ((unsigned long long)RD32P(0x24)) << 32;
+				inode_table  |= ((unsigned long long)RD32P(0x28)) << 32;
 			}
 
+			DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterBitmapINodes = inode_bitmap;
+			DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterBitmapBloques = block_bitmap;
+			DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterTablaINodes = inode_table;
+
 			#undef RD32P
 		}
+
+		/* El primer bloque de datos de cada grupo es el que sigue a los metadatos que caen en él: la copia del superbloque y de
+		   la GDT (si el grupo la tiene) y los bitmaps y tablas de inodes, que con flex_bg pueden ser de otros grupos */
+		unsigned long long inode_table_blocks = ((unsigned long long)s_inodes_per_group * s_inode_size + DatosFS.BytesPorCluster - 1) / DatosFS.BytesPorCluster;
+		for (int i = 0; i < DatosFS.DatosEspecificos.EXT.NroGrupos; i++)
+		{
+			unsigned long long inicio = s_first_data_block + (unsigned long long)i * s_blocks_per_group;
+			unsigned long long fin = inicio + s_blocks_per_group;
+			unsigned long long primero = inicio;
+			if (TieneCopiaSuperbloque(i))
+				primero += 1 + gdt_blocks + s_r_blocks_count;
+
+			for (int j = 0; j < DatosFS.DatosEspecificos.EXT.NroGrupos; j++)
+			{
+				const TDatosGrupoFSEXT &g = DatosFS.DatosEspecificos.EXT.DatosGrupo[j];
+				if (g.ClusterBitmapBloques >= inicio && g.ClusterBitmapBloques < fin)
+					primero = std::max(primero, g.ClusterBitmapBloques + 1);
+				if (g.ClusterBitmapINodes >= inicio && g.ClusterBitmapINodes < fin)
+					primero = std::max(primero, g.ClusterBitmapINodes + 1);
+				if (g.ClusterTablaINodes >= inicio && g.ClusterTablaINodes < fin)
+					primero = std::max(primero, g.ClusterTablaINodes + inode_table_blocks);
+			}
+			DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterTablaBloques = primero;
+		}
 	}
 
 	return CODERROR_NINGUNO;
@@ -159,625 +368,1171 @@ int TDriverEXT::LevantarDatosSuperbloque()
 
 /****************************************************************************************************************************************
  *																	*
- *						  TDriverEXT :: ListarDirectorio							*
+ *						   TDriverEXT :: TieneCopiaSuperbloque							*
  *																	*
- * OBJETIVO: Esta función enumera las entradas en un directorio y retorna un arreglo de elementos, uno por cada entrada.		*
+ * OBJETIVO: Esta función indica si un grupo empieza con una copia del superbloque y de la GDT.						*
  *																	*
- * ENTRADA: Path: Path al directorio enumerar (cadena de nombres de directorio separados por '/').					*
+ * ENTRADA: grupo: Número de grupo.													*
  *																	*
- * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
- *	   Entradas: Arreglo con cada una de las entradas.										*
+ * SALIDA: En el nombre de la función true si el grupo tiene la copia.									*
+ *																	*
+ * OBSERVACIONES: Con sparse_super sólo la tienen los grupos 0, 1 y las potencias de 3, 5 y 7. Con sparse_super2 sólo el 0 y los	*
+ *		  (hasta dos) grupos que indica el superbloque.										*
  *																	*
  ****************************************************************************************************************************************/
-int TDriverEXT::ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas)
+bool TDriverEXT::TieneCopiaSuperbloque(unsigned grupo)
 {
-	Entradas.clear();
+	if (grupo == 0)
+		return true;
 
-	if (!Path)
-		return CODERROR_PARAMETROS_INVALIDOS;
+	if (DatosFS.DatosEspecificos.EXT.CaracteristicasCompatibles & EXT4_FEATURE_COMPAT_SPARSE_SUPER2)
+	{
+		TSectorFijado sb_fijado;
+		const unsigned char *sb = sb_fijado.Fijar(this, 2);
+		if (!sb)
+			return false;
+		return grupo == RD32(0x24C) || grupo == RD32(0x250);
+	}
 
-	if (Path[0] != '/')
-		return CODERROR_RUTA_NO_ABSOLUTA;
+	if (!(DatosFS.DatosEspecificos.EXT.CaracteristicasSoloLectura & EXT2_FEATURE_RO_COMPAT_SPARSE_SUPER))
+		return true;
 
-	if (DatosFS.TipoFilesystem != tfsEXT2)
-		return CODERROR_FILESYSTEM_DESCONOCIDO;
+	if (grupo == 1)
+		return true;
+	for (unsigned base = 3; base <= 7; base += 2)
+	{
+		unsigned long long potencia = base;
+		while (potencia < grupo)
+			potencia *= base;
+		if (potencia == grupo)
+			return true;
+	}
+	return false;
+}
 
-	unsigned sectores_por_cluster = DatosFS.BytesPorCluster / DatosFS.BytesPorSector;
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverEXT :: RecorrerDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función recorre las entradas de un directorio y llama al visitante con cada una a medida que la decodifica.		*
+ *																	*
+ * ENTRADA: Manejador: Manejador del directorio a recorrer.										*
+ *	    Visitante: Función a llamar por cada entrada (si devuelve false se deja de recorrer).					*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::RecorrerDirectorio(const TManejadorArchivo &Manejador, const TVisitanteDirectorio &Visitante)
+{
+	/* Levantar el inode del directorio (la ruta ya se resolvió al abrirlo) */
+	TINodeEXT inode_dir;
+	int cod = LeerINode(Manejador.DatosEspecificos.EXT.INode, inode_dir, CODERROR_DIRECTORIO_INEXISTENTE);
+	if (cod != CODERROR_NINGUNO)
+		return cod;
 
-	unsigned inodes_por_grupo = (unsigned)DatosFS.DatosEspecificos.EXT.INodesPorGrupo;
-	unsigned bytes_por_inode = (unsigned)DatosFS.DatosEspecificos.EXT.BytesPorINode;
-	unsigned nro_grupos = (unsigned)DatosFS.DatosEspecificos.EXT.NroGrupos;
+	if (!S_ISDIR(inode_dir.i_mode))
+		return CODERROR_DIRECTORIO_INEXISTENTE;
 
-	/* Resolver la ruta componente a componente, empezando en la raiz (inode 2) */
-	unsigned current_inode = EXT_ROOT_INO; /* 2 */
-	std::string ruta(Path);
+	/* La misma entrada se reusa para todo el directorio (el nombre no vuelve a pedir memoria) */
+	TEntradaDirectorio e = TEntradaDirectorio();
 
-	if (ruta != "/")
+	return RecorrerEntradas(inode_dir, [&](unsigned inode_entry, const char *name, unsigned name_len)
 	{
-		size_t pos = 1; /* Saltar la primer / */
-		while (pos < ruta.size())
-		{
-			size_t next = ruta.find('/', pos);
-			std::string componente = (next==std::string::npos) ? ruta.substr(pos) : ruta.substr(pos, next-pos);
-			if (componente.empty())
-			{
-				pos = (next==std::string::npos)? ruta.size() : next+1;
-				continue;
-			}
+		/* Leer inode de la entrada para obtener tamaño/tiempos/modo (si no se puede se saltea la entrada) */
+		TINodeEXT inode_e;
+		if (LeerINode(inode_entry, inode_e, CODERROR_ARCHIVO_INEXISTENTE) != CODERROR_NINGUNO)
+			return true;
 
-			/* Leer inode del directorio actual */
-			if (current_inode == 0 || current_inode > (unsigned)DatosFS.DatosEspecificos.EXT.NumeroDeINodes)
-				return CODERROR_DIRECTORIO_INEXISTENTE;
+		/* Construir entrada */
+		e.Nombre.assign(name, name_len);
+		ArmarEntrada(inode_entry, inode_e, e);
 
-			unsigned grupo = (current_inode - 1) / inodes_por_grupo;
-			if (grupo >= nro_grupos)
-				return CODERROR_DIRECTORIO_INEXISTENTE;
+		return Visitante(e);
+	});
+}
 
-			unsigned long long tabla_inodos = DatosFS.DatosEspecificos.EXT.DatosGrupo[grupo].ClusterTablaINodes;
-			unsigned index_in_group = (current_inode - 1) % inodes_por_grupo;
-			unsigned offset_in_table = index_in_group * bytes_por_inode;
+/****************************************************************************************************************************************
+ *																	*
+ *							   TDriverEXT :: Abrir								*
+ *																	*
+ * OBJETIVO: Esta función ubica un archivo o directorio dada su ruta y devuelve un manejador para operar sobre él.			*
+ *																	*
+ * ENTRADA: Path: Ruta absoluta al archivo o directorio.										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Manejador: Número de inode, tamaño y si es un directorio.									*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::Abrir(const char *Path, TManejadorArchivo &Manejador)
+{
+	memset(&Manejador, 0, sizeof(Manejador));
 
-			unsigned block_offset = offset_in_table / DatosFS.BytesPorCluster;
-			unsigned offset_in_block = offset_in_table % DatosFS.BytesPorCluster;
+	/* Resolver la ruta una sola vez */
+	unsigned nro_inode;
+	TINodeEXT inode;
+	int cod = ResolverRuta(Path, nro_inode, inode, CODERROR_ARCHIVO_INEXISTENTE);
+	if (cod != CODERROR_NINGUNO)
+		return cod;
 
-			unsigned block = (unsigned)(tabla_inodos + block_offset);
-			const unsigned char *pblock = PunteroASector((__u64)block * sectores_por_cluster);
-			if (!pblock)
-				return CODERROR_LECTURA_DISCO;
+	Manejador.Bytes = (unsigned long long)inode.i_size_lo;
+	Manejador.Bytes |= ((unsigned long long)inode.i_size_high) << 32;
+	if (S_ISDIR(inode.i_mode))
+		Manejador.Flags |= fedDIRECTORIO;
+	Manejador.DatosEspecificos.EXT.INode = nro_inode;
 
-			TINodeEXT inode_dir;
-			memset(&inode_dir, 0, sizeof(inode_dir));
+	return CODERROR_NINGUNO;
+}
 
-			/* Copiar el inode */
-			if (offset_in_block + bytes_por_inode <= (unsigned)DatosFS.BytesPorCluster)
-			{
-				memcpy(&inode_dir, pblock + offset_in_block, (bytes_por_inode < sizeof(TINodeEXT)) ? bytes_por_inode : sizeof(TINodeEXT));
-			}
-			else
-			{
-				/* Leer en dos partes */
-				unsigned first_chunk = (unsigned)DatosFS.BytesPorCluster - offset_in_block;
-				unsigned to_copy = (bytes_por_inode < sizeof(TINodeEXT)) ? bytes_por_inode : sizeof(TINodeEXT);
-				unsigned copied = 0;
-				if (first_chunk > 0)
-				{
-					unsigned c = (first_chunk < to_copy) ? first_chunk : to_copy;
-					memcpy(&((unsigned char*)&inode_dir)[0], pblock + offset_in_block, c);
-					copied += c;
-				}
-				if (copied < to_copy)
-				{
-					/* leer siguiente bloque de la tabla de inodos */
-					const unsigned char *pblock2 = PunteroASector((__u64)(block + 1) * sectores_por_cluster);
-					if (!pblock2)
-						return CODERROR_LECTURA_DISCO;
-					memcpy(&((unsigned char*)&inode_dir)[copied], pblock2, to_copy - copied);
-				}
-			}
+/****************************************************************************************************************************************
+ *																	*
+ *							   TDriverEXT :: Stat								*
+ *																	*
+ * OBJETIVO: Esta función levanta los datos de un archivo o directorio ya abierto como si fuera su entrada de directorio.		*
+ *																	*
+ * ENTRADA: Manejador: Manejador del archivo o directorio.										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Entrada: Datos de la entrada (el nombre queda vacío, el inode no lo tiene).							*
+ *																	*
+ * OBSERVACIONES: Sólo se lee el inode del archivo.											*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::Stat(const TManejadorArchivo &Manejador, TEntradaDirectorio &Entrada)
+{
+	TINodeEXT inode;
+	int cod = LeerINode(Manejador.DatosEspecificos.EXT.INode, inode, CODERROR_ARCHIVO_INEXISTENTE);
+	if (cod != CODERROR_NINGUNO)
+		return cod;
 
-			/* Verificar que sea directorio */
-			if (!S_ISDIR(inode_dir.i_mode))
-				return CODERROR_DIRECTORIO_INEXISTENTE;
+	Entrada.Nombre.clear();
+	ArmarEntrada(Manejador.DatosEspecificos.EXT.INode, inode, Entrada);
+	return CODERROR_NINGUNO;
+}
 
-			/* Buscar el componente dentro de las entradas del directorio */
-			bool found = false;
-			for (int bi = 0; bi < 12 && !found; bi++)
-			{
-				unsigned data_block = (unsigned)inode_dir.i_block[bi];
-				if (data_block == 0)
-					continue;
-
-				const unsigned char *db = PunteroASector((__u64)data_block * sectores_por_cluster);
-				if (!db)
-					return CODERROR_LECTURA_DISCO;
-
-				unsigned off = 0;
-				while (off < (unsigned)DatosFS.BytesPorCluster)
-				{
-					const unsigned char *entry = db + off;
-					unsigned inode_entry = entry[0] | (entry[1] << 8) | (entry[2] << 16) | (entry[3] << 24);
-					unsigned rec_len = entry[4] | (entry[5] << 8);
-					unsigned name_len = entry[6];
-
-					if (rec_len == 0)
-						break;
-
-					if (inode_entry != 0 && name_len > 0 && name_len < rec_len)
-					{
-						std::string name((const char *)(entry + 8), name_len);
-						if (name == componente)
-						{
-							current_inode = inode_entry;
-							found = true;
-							break;
-						}
-					}
-
-					off += rec_len;
-				}
-			}
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverEXT :: LeerRangoArchivo							*
+ *																	*
+ * OBJETIVO: Esta función lee de la imágen una parte de un archivo ya abierto, en un buffer del llamador.				*
+ *																	*
+ * ENTRADA: Manejador: Manejador del archivo a leer.												*
+ *	    Offset: Posición dentro del archivo del primer byte a leer.									*
+ *	    Longitud: Cantidad de bytes a leer.												*
+ *	    Destino: Buffer de al menos Longitud bytes.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Leidos: Cantidad de bytes copiados a Destino (menos que Longitud si el rango pasa el fin del archivo).			*
+ *																	*
+ * OBSERVACIONES: Sólo se recorre el mapa de bloques del rango pedido.									*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::LeerRangoArchivo(const TManejadorArchivo &Manejador, __u64 Offset, __u64 Longitud, unsigned char *Destino, __u64 &Leidos)
+{
+	Leidos = 0;
 
-			if (!found)
-				return CODERROR_DIRECTORIO_INEXISTENTE;
+	/* Levantar el inode del archivo */
+	TINodeEXT inode_file;
+	int cod = LeerINodeArchivo(Manejador, inode_file);
+	if (cod != CODERROR_NINGUNO)
+		return cod;
 
-			pos = (next==std::string::npos)? ruta.size() : next+1;
-		}
-	}
+	unsigned long long size = (unsigned long long)inode_file.i_size_lo;
+	size |= ((unsigned long long)inode_file.i_size_high) << 32;
 
-	/* Ahora current_inode es el inodo del directorio a listar, lo leemos y listamos sus entradas */
-	if (current_inode == 0 || current_inode > (unsigned)DatosFS.DatosEspecificos.EXT.NumeroDeINodes)
-		return CODERROR_DIRECTORIO_INEXISTENTE;
+	/* Recortar el rango al fin del archivo */
+	if (Offset >= size)
+		return CODERROR_NINGUNO;
+	Longitud = min(Longitud, size - Offset);
+	if (Longitud == 0)
+		return CODERROR_NINGUNO;
 
-	unsigned grupo_root = (current_inode - 1) / inodes_por_grupo;
-	if (grupo_root >= nro_grupos)
-		return CODERROR_DIRECTORIO_INEXISTENTE;
+	cod = LeerBloques(inode_file, Offset, Longitud, Destino);
+	if (cod != CODERROR_NINGUNO)
+		return cod;
 
-	unsigned long long tabla_inodos_root = DatosFS.DatosEspecificos.EXT.DatosGrupo[grupo_root].ClusterTablaINodes;
-	unsigned index_in_group_root = (current_inode - 1) % inodes_por_grupo;
-	unsigned offset_in_table_root = index_in_group_root * bytes_por_inode;
-	unsigned block_offset_root = offset_in_table_root / DatosFS.BytesPorCluster;
-	unsigned offset_in_block_root = offset_in_table_root % DatosFS.BytesPorCluster;
-	unsigned block_root = (unsigned)(tabla_inodos_root + block_offset_root);
+	Leidos = Longitud;
+	return CODERROR_NINGUNO;
+}
 
-	const unsigned char *pblock_root = PunteroASector((__u64)block_root * sectores_por_cluster);
-	if (!pblock_root)
-		return CODERROR_LECTURA_DISCO;
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverEXT :: MapearArchivo							*
+ *																	*
+ * OBJETIVO: Esta función devuelve dónde está cada tramo de un archivo dentro de la imágen, sin leer sus datos.				*
+ *																	*
+ * ENTRADA: Manejador: Manejador del archivo a mapear.												*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Extents: Tramos del archivo en orden, cubriéndolo entero (los huecos marcados como tales).					*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::MapearArchivo(const TManejadorArchivo &Manejador, std::vector<TExtentArchivo> &Extents)
+{
+	Extents.clear();
 
-	TINodeEXT inode_dir_root;
-	memset(&inode_dir_root, 0, sizeof(inode_dir_root));
-	if (offset_in_block_root + bytes_por_inode <= (unsigned)DatosFS.BytesPorCluster)
-	{
-		memcpy(&inode_dir_root, pblock_root + offset_in_block_root, (bytes_por_inode < sizeof(TINodeEXT)) ? bytes_por_inode : sizeof(TINodeEXT));
-	}
-	else
+	/* Levantar el inode del archivo */
+	TINodeEXT inode_file;
+	int cod = LeerINodeArchivo(Manejador, inode_file);
+	if (cod != CODERROR_NINGUNO)
+		return cod;
+
+	unsigned long long size = (unsigned long long)inode_file.i_size_lo;
+	size |= ((unsigned long long)inode_file.i_size_high) << 32;
+
+	return ArmarExtents(inode_file, 0, size, Extents);
+}
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TDriverEXT :: LeerINode							*
+ *																	*
+ * OBJETIVO: Esta función obtiene un inode, de la cache si se leyó hace poco o de la tabla de inodes de su grupo.			*
+ *																	*
+ * ENTRADA: nro_inode: Número de inode (el primero es el 1).										*
+ *	    cod_inexistente: Código de error a devolver si el número de inode no es válido.						*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   inode: El inode leído (lo que no entra en el inode en disco queda en cero).							*
+ *																	*
+ * OBSERVACIONES: La cache guarda los últimos EXT_CACHE_INODES inodes usados, así los prefijos de rutas repetidos, los directorios	*
+ *		  recién listados y los archivos de un mismo directorio no vuelven a decodificarse.					*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::LeerINode(unsigned nro_inode, TINodeEXT &inode, int cod_inexistente)
+{
+	/* Buscarlo en la cache */
 	{
-		unsigned first_chunk = (unsigned)DatosFS.BytesPorCluster - offset_in_block_root;
-		unsigned to_copy = (bytes_por_inode < sizeof(TINodeEXT)) ? bytes_por_inode : sizeof(TINodeEXT);
-		unsigned copied = 0;
-		if (first_chunk > 0)
-		{
-			unsigned c = (first_chunk < to_copy) ? first_chunk : to_copy;
-			memcpy(&((unsigned char*)&inode_dir_root)[0], pblock_root + offset_in_block_root, c);
-			copied += c;
-		}
-		if (copied < to_copy)
+		std::lock_guard<std::mutex> lock(cache_mutex);
+		std::unordered_map<unsigned, std::list<TINodeCacheEXT>::iterator>::iterator it = cache_indice.find(nro_inode);
+		if (it != cache_indice.end())
 		{
-			const unsigned char *pblock2 = PunteroASector((__u64)(block_root + 1) * sectores_por_cluster);
-			if (!pblock2)
-				return CODERROR_LECTURA_DISCO;
-			memcpy(&((unsigned char*)&inode_dir_root)[copied], pblock2, to_copy - copied);
+			cache_inodes.splice(cache_inodes.begin(), cache_inodes, it->second);
+			inode = it->second->inode;
+			return CODERROR_NINGUNO;
 		}
 	}
 
-	if (!S_ISDIR(inode_dir_root.i_mode))
-		return CODERROR_DIRECTORIO_INEXISTENTE;
+	/* Decodificarlo de la tabla, fuera del lock */
+	int cod = LeerINodeTabla(nro_inode, inode, cod_inexistente);
+	if (cod != CODERROR_NINGUNO)
+		return cod;
 
-	/* Recorremos los bloques directos y añadimos cada entrada a Entradas */
-	for (int bi = 0; bi < 12; bi++)
+	/* Guardarlo (otro hilo puede haberlo guardado mientras tanto) */
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	if (cache_indice.find(nro_inode) != cache_indice.end())
+		return CODERROR_NINGUNO;
+	if (cache_inodes.size() >= EXT_CACHE_INODES)
 	{
-		unsigned data_block = (unsigned)inode_dir_root.i_block[bi];
-		if (data_block == 0)
-			continue;
-
-		const unsigned char *db = PunteroASector((__u64)data_block * sectores_por_cluster);
-		if (!db)
-			return CODERROR_LECTURA_DISCO;
-
-		unsigned off = 0;
-		while (off < (unsigned)DatosFS.BytesPorCluster)
-		{
-			const unsigned char *entry = db + off;
-			unsigned inode_entry = entry[0] | (entry[1] << 8) | (entry[2] << 16) | (entry[3] << 24);
-			unsigned rec_len = entry[4] | (entry[5] << 8);
-			unsigned name_len = entry[6];
-
-			if (rec_len == 0)
-				break;
-
-			if (inode_entry != 0 && name_len > 0 && name_len < rec_len)
-			{
-				std::string name((const char *)(entry + 8), name_len);
-
-				/* Leer inode de la entrada para obtener tamaño/tiempos/modo */
-				if (inode_entry == 0 || inode_entry > (unsigned)DatosFS.DatosEspecificos.EXT.NumeroDeINodes)
-				{
-					off += rec_len;
-					continue;
-				}
-
-				unsigned grupo_e = (inode_entry - 1) / inodes_por_grupo;
-				if (grupo_e >= nro_grupos)
-				{
-					off += rec_len;
-					continue;
-				}
-
-				unsigned long long tabla_inodos_e = DatosFS.DatosEspecificos.EXT.DatosGrupo[grupo_e].ClusterTablaINodes;
-				unsigned index_in_group_e = (inode_entry - 1) % inodes_por_grupo;
-				unsigned offset_in_table_e = index_in_group_e * bytes_por_inode;
-				unsigned block_offset_e = offset_in_table_e / DatosFS.BytesPorCluster;
-				unsigned offset_in_block_e = offset_in_table_e % DatosFS.BytesPorCluster;
-				unsigned block_e = (unsigned)(tabla_inodos_e + block_offset_e);
-
-				const unsigned char *pblock_e = PunteroASector((__u64)block_e * sectores_por_cluster);
-				if (!pblock_e)
-				{
-					off += rec_len;
-					continue;
-				}
-
-				TINodeEXT inode_e;
-				memset(&inode_e, 0, sizeof(inode_e));
-				if (offset_in_block_e + bytes_por_inode <= (unsigned)DatosFS.BytesPorCluster)
-				{
-					memcpy(&inode_e, pblock_e + offset_in_block_e, (bytes_por_inode < sizeof(TINodeEXT)) ? bytes_por_inode : sizeof(TINodeEXT));
-				}
-				else
-				{
-					unsigned first_chunk = (unsigned)DatosFS.BytesPorCluster - offset_in_block_e;
-					unsigned to_copy = (bytes_por_inode < sizeof(TINodeEXT)) ? bytes_por_inode : sizeof(TINodeEXT);
-					unsigned copied = 0;
-					if (first_chunk > 0)
-					{
-						unsigned c = (first_chunk < to_copy) ? first_chunk : to_copy;
-						memcpy(&((unsigned char*)&inode_e)[0], pblock_e + offset_in_block_e, c);
-						copied += c;
-					}
-					if (copied < to_copy)
-					{
-						const unsigned char *pblock2 = PunteroASector((__u64)(block_e + 1) * sectores_por_cluster);
-						if (pblock2)
-							memcpy(&((unsigned char*)&inode_e)[copied], pblock2, to_copy - copied);
-					}
-				}
-
-				/* Construir entrada */
-				TEntradaDirectorio e;
-				memset(&e, 0, sizeof(e));
-				e.Nombre = name;
-				unsigned long long size = (unsigned long long)inode_e.i_size_lo;
-				size |= ((unsigned long long)inode_e.i_size_high) << 32;
-				e.Bytes = size;
-				/* la fecha de creacion esta mal en el diff pero no entendemos porque si todo el resto de las fechas estan bien (como que no es del modo de lectura de little endian porque es el mismo en todas las entradas, es como que ni aparece)*/
-				e.FechaCreacion = (time_t)inode_e.i_crtime;
-				e.FechaUltimoAcceso = (time_t)inode_e.i_atime;
-				e.FechaUltimaModificacion = (time_t)inode_e.i_mtime;
-				e.Flags = 0;
-				if (S_ISDIR(inode_e.i_mode))
-					e.Flags |= fedDIRECTORIO;
-				e.DatosEspecificos.EXT.INode = inode_entry;
-
-				Entradas.push_back(e);
-			}
-
-			off += rec_len;
-		}
+		/* Reutilizar el nodo del usado hace más tiempo */
+		cache_indice.erase(cache_inodes.back().nro_inode);
+		cache_inodes.splice(cache_inodes.begin(), cache_inodes, std::prev(cache_inodes.end()));
 	}
+	else
+		cache_inodes.emplace_front();
+	cache_inodes.front().nro_inode = nro_inode;
+	cache_inodes.front().inode = inode;
+	cache_indice[nro_inode] = cache_inodes.begin();
 
 	return CODERROR_NINGUNO;
 }
 
 /****************************************************************************************************************************************
  *																	*
- *						     TDriverEXT :: LeerArchivo								*
+ *						      TDriverEXT :: LeerINodeTabla							*
  *																	*
- * OBJETIVO: Esta función levanta de la imágen un archivo dada su ruta.									*
+ * OBJETIVO: Esta función copia un inode de la tabla de inodes de su grupo.								*
  *																	*
- * ENTRADA: Path: Ruta al archivo a levantar.												*
+ * ENTRADA: nro_inode: Número de inode (el primero es el 1).										*
+ *	    cod_inexistente: Código de error a devolver si el número de inode no es válido.						*
  *																	*
  * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
- *	   Data: Buffer alocado con malloc() con los datos del archivo.									*
- *	   DataLen: Tamaño en bytes del buffer devuelto.										*
- *																	*						*
+ *	   inode: El inode leído (lo que no entra en el inode en disco queda en cero).							*
+ *																	*
  ****************************************************************************************************************************************/
-int TDriverEXT::LeerArchivo(const char *Path, unsigned char *&Data, unsigned &DataLen)
+int TDriverEXT::LeerINodeTabla(unsigned nro_inode, TINodeEXT &inode, int cod_inexistente)
 {
-	Data = NULL;
-	DataLen = 0;
-
-	if (!Path)
-		return CODERROR_PARAMETROS_INVALIDOS;
-
-	if (Path[0] != '/')
-		return CODERROR_RUTA_NO_ABSOLUTA;
-
-	if (DatosFS.TipoFilesystem != tfsEXT2)
-		return CODERROR_FILESYSTEM_DESCONOCIDO;
-
 	unsigned sectores_por_cluster = DatosFS.BytesPorCluster / DatosFS.BytesPorSector;
-
 	unsigned inodes_por_grupo = (unsigned)DatosFS.DatosEspecificos.EXT.INodesPorGrupo;
 	unsigned bytes_por_inode = (unsigned)DatosFS.DatosEspecificos.EXT.BytesPorINode;
-	unsigned nro_grupos = (unsigned)DatosFS.DatosEspecificos.EXT.NroGrupos;
-
-	/* Resolver la ruta igual que en ListarDirectorio */
-	unsigned current_inode = EXT_ROOT_INO; /* inodo 2 */
-	std::string ruta(Path);
-
-	if (ruta != "/")
-	{
-		size_t pos = 1;
-		while (pos < ruta.size())
-		{
-			size_t next = ruta.find('/', pos);
-			std::string componente = (next==std::string::npos) ? ruta.substr(pos) : ruta.substr(pos, next-pos);
-			if (componente.empty())
-			{
-				pos = (next==std::string::npos)? ruta.size() : next+1;
-				continue;
-			}
-
-			if (current_inode == 0 || current_inode > (unsigned)DatosFS.DatosEspecificos.EXT.NumeroDeINodes)
-				return CODERROR_ARCHIVO_INEXISTENTE;
 
-			unsigned grupo = (current_inode - 1) / inodes_por_grupo;
-			if (grupo >= nro_grupos)
-				return CODERROR_ARCHIVO_INEXISTENTE;
+	if (nro_inode == 0 || nro_inode > (unsigned)DatosFS.DatosEspecificos.EXT.NumeroDeINodes)
+		return cod_inexistente;
 
-			unsigned long long tabla_inodos = DatosFS.DatosEspecificos.EXT.DatosGrupo[grupo].ClusterTablaINodes;
-			unsigned index_in_group = (current_inode - 1) % inodes_por_grupo;
-			unsigned offset_in_table = index_in_group * bytes_por_inode;
+	unsigned grupo = (nro_inode - 1) / inodes_por_grupo;
+	if (grupo >= (unsigned)DatosFS.DatosEspecificos.EXT.NroGrupos)
+		return cod_inexistente;
 
-			unsigned block_offset = offset_in_table / DatosFS.BytesPorCluster;
-			unsigned offset_in_block = offset_in_table % DatosFS.BytesPorCluster;
-
-			unsigned block = (unsigned)(tabla_inodos + block_offset);
-			const unsigned char *pblock = PunteroASector((__u64)block * sectores_por_cluster);
-			if (!pblock)
-				return CODERROR_LECTURA_DISCO;
+	unsigned long long tabla_inodos = DatosFS.DatosEspecificos.EXT.DatosGrupo[grupo].ClusterTablaINodes;
+	unsigned offset_in_table = ((nro_inode - 1) % inodes_por_grupo) * bytes_por_inode;
+	unsigned offset_in_block = offset_in_table % DatosFS.BytesPorCluster;
+	__u64 block = tabla_inodos + offset_in_table / DatosFS.BytesPorCluster;
 
-			TINodeEXT inode_dir;
-			memset(&inode_dir, 0, sizeof(inode_dir));
+	TSectorFijado pblock_fijado;
+	const unsigned char *pblock = pblock_fijado.Fijar(this, (__u64)block * sectores_por_cluster);
+	if (!pblock)
+		return CODERROR_LECTURA_DISCO;
 
-			if (offset_in_block + bytes_por_inode <= (unsigned)DatosFS.BytesPorCluster)
-			{
-				memcpy(&inode_dir, pblock + offset_in_block, (bytes_por_inode < sizeof(TINodeEXT)) ? bytes_por_inode : sizeof(TINodeEXT));
-			}
-			else
-			{
-				unsigned first_chunk = (unsigned)DatosFS.BytesPorCluster - offset_in_block;
-				unsigned to_copy = (bytes_por_inode < sizeof(TINodeEXT)) ? bytes_por_inode : sizeof(TINodeEXT);
-				unsigned copied = 0;
-				if (first_chunk > 0)
-				{
-					unsigned c = (first_chunk < to_copy) ? first_chunk : to_copy;
-					memcpy(&((unsigned char*)&inode_dir)[0], pblock + offset_in_block, c);
-					copied += c;
-				}
-				if (copied < to_copy)
-				{
-					const unsigned char *pblock2 = PunteroASector((__u64)(block + 1) * sectores_por_cluster);
-					if (!pblock2)
-						return CODERROR_LECTURA_DISCO;
-					memcpy(&((unsigned char*)&inode_dir)[copied], pblock2, to_copy - copied);
-				}
-			}
+	memset(&inode, 0, sizeof(inode));
+	unsigned to_copy = (bytes_por_inode < sizeof(TINodeEXT)) ? bytes_por_inode : sizeof(TINodeEXT);
+	if (offset_in_block + to_copy <= (unsigned)DatosFS.BytesPorCluster)
+	{
+		memcpy(&inode, pblock + offset_in_block, to_copy);
+	}
+	else
+	{
+		/* El inode cruza el fin del bloque, leer en dos partes */
+		unsigned first_chunk = (unsigned)DatosFS.BytesPorCluster - offset_in_block;
+		memcpy(&inode, pblock + offset_in_block, first_chunk);
+		TSectorFijado pblock2_fijado;
+		const unsigned char *pblock2 = pblock2_fijado.Fijar(this, (__u64)(block + 1) * sectores_por_cluster);
+		if (!pblock2)
+			return CODERROR_LECTURA_DISCO;
+		memcpy(&((unsigned char*)&inode)[first_chunk], pblock2, to_copy - first_chunk);
+	}
 
-			/* Verificar que sea directorio para poder buscar */
-			if (!S_ISDIR(inode_dir.i_mode))
-				return CODERROR_ARCHIVO_INEXISTENTE;
+	return CODERROR_NINGUNO;
+}
 
-			/* Buscar el componente dentro de las entradas del directorio */
-			bool found = false;
-			for (int bi = 0; bi < 12 && !found; bi++)
-			{
-				unsigned data_block = (unsigned)inode_dir.i_block[bi];
-				if (data_block == 0)
-					continue;
-
-				const unsigned char *db = PunteroASector((__u64)data_block * sectores_por_cluster);
-				if (!db)
-					return CODERROR_LECTURA_DISCO;
-
-				unsigned off = 0;
-				while (off < (unsigned)DatosFS.BytesPorCluster)
-				{
-					const unsigned char *entry = db + off;
-					unsigned inode_entry = entry[0] | (entry[1] << 8) | (entry[2] << 16) | (entry[3] << 24);
-					unsigned rec_len = entry[4] | (entry[5] << 8);
-					unsigned name_len = entry[6];
-
-					if (rec_len == 0)
-						break;
-
-					if (inode_entry != 0 && name_len > 0 && name_len < rec_len)
-					{
-						std::string name((const char *)(entry + 8), name_len);
-						if (name == componente)
-						{
-							current_inode = inode_entry;
-							found = true;
-							break;
-						}
-					}
-
-					off += rec_len;
-				}
-			}
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverEXT :: ArmarEntrada							*
+ *																	*
+ * OBJETIVO: Esta función completa una entrada de directorio con los datos de un inode.							*
+ *																	*
+ * ENTRADA: nro_inode: Número del inode.												*
+ *	    inode: El inode.														*
+ *																	*
+ * SALIDA: e: Entrada con tamaño, fechas, flags y número de inode (el nombre no se toca).						*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverEXT::ArmarEntrada(unsigned nro_inode, const TINodeEXT &inode, TEntradaDirectorio &e)
+{
+	unsigned long long size = (unsigned long long)inode.i_size_lo;
+	size |= ((unsigned long long)inode.i_size_high) << 32;
+	e.Bytes = size;
+	/* la fecha de creacion esta mal en el diff pero no entendemos porque si todo el resto de las fechas estan bien (como que no es del modo de lectura de little endian porque es el mismo en todas las entradas, es como que ni aparece)*/
+	e.FechaCreacion = (time_t)inode.i_crtime;
+	e.FechaUltimoAcceso = (time_t)inode.i_atime;
+	e.FechaUltimaModificacion = (time_t)inode.i_mtime;
+	e.Flags = 0;
+	if (S_ISDIR(inode.i_mode))
+		e.Flags |= fedDIRECTORIO;
+	/* Links simbólicos, dispositivos, fifos y sockets no tienen contenido que leer (el destino de un link corto está en i_block) */
+	else if (!S_ISREG(inode.i_mode))
+		e.Flags |= fedACCESO_DIRECTO;
+	e.DatosEspecificos.EXT.INode = nro_inode;
+}
 
-			if (!found)
-				return CODERROR_ARCHIVO_INEXISTENTE;
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverEXT :: BuscarEnDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función busca un nombre entre las entradas de un directorio.								*
+ *																	*
+ * ENTRADA: nro_dir: Número de inode del directorio.											*
+ *	    inode_dir: Inode del directorio.												*
+ *	    nombre: Nombre a buscar (no hace falta que termine en '\0').								*
+ *	    long_nombre: Longitud del nombre.												*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   nro_inode: Número de inode de la entrada, o 0 si el directorio no tiene ese nombre.						*
+ *																	*
+ * OBSERVACIONES: El resultado, exista o no el nombre, se guarda en una cache LRU de EXT_CACHE_DENTRIES búsquedas, así las rutas	*
+ *		  con el mismo prefijo recorren los bloques de cada directorio una sola vez. La imágen no cambia, por lo que nunca	*
+ *		  hace falta invalidarla.												*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::BuscarEnDirectorio(unsigned nro_dir, const TINodeEXT &inode_dir, const char *nombre, unsigned long_nombre, unsigned &nro_inode)
+{
+	/* La clave es el número del directorio seguido del nombre */
+	std::string clave((const char *)&nro_dir, sizeof(nro_dir));
+	clave.append(nombre, long_nombre);
 
-			pos = (next==std::string::npos)? ruta.size() : next+1;
+	/* Buscarlo en la cache */
+	{
+		std::lock_guard<std::mutex> lock(dentries_mutex);
+		std::unordered_map<std::string, std::list<TDentryCacheEXT>::iterator>::iterator it = dentries_indice.find(clave);
+		if (it != dentries_indice.end())
+		{
+			cache_dentries.splice(cache_dentries.begin(), cache_dentries, it->second);
+			nro_inode = it->second->nro_inode;
+			return CODERROR_NINGUNO;
 		}
 	}
 
-	/* Ahora current_inode es el inode del archivo a leer*/
-	if (current_inode == 0 || current_inode > (unsigned)DatosFS.DatosEspecificos.EXT.NumeroDeINodes)
-		return CODERROR_ARCHIVO_INEXISTENTE;
-
-	unsigned grupo_file = (current_inode - 1) / inodes_por_grupo;
-	if (grupo_file >= nro_grupos)
-		return CODERROR_ARCHIVO_INEXISTENTE;
-
-	unsigned long long tabla_inodos_file = DatosFS.DatosEspecificos.EXT.DatosGrupo[grupo_file].ClusterTablaINodes;
-	unsigned index_in_group_file = (current_inode - 1) % inodes_por_grupo;
-	unsigned offset_in_table_file = index_in_group_file * bytes_por_inode;
-	unsigned block_offset_file = offset_in_table_file / DatosFS.BytesPorCluster;
-	unsigned offset_in_block_file = offset_in_table_file % DatosFS.BytesPorCluster;
-	unsigned block_file = (unsigned)(tabla_inodos_file + block_offset_file);
-
-	const unsigned char *pblock_file = PunteroASector((__u64)block_file * sectores_por_cluster);
-	if (!pblock_file)
-		return CODERROR_LECTURA_DISCO;
+	/* Buscarlo con el índice si el directorio lo tiene, sino (o si no se puede usar) recorrer sus entradas, fuera del lock */
+	int cod = CODERROR_NO_IMPLEMENTADO;
+	if ((inode_dir.i_flags & EXT3_INDEX_FL) && (DatosFS.DatosEspecificos.EXT.CaracteristicasCompatibles & EXT3_FEATURE_COMPAT_DIR_INDEX))
+		cod = BuscarEnHTree(inode_dir, nombre, long_nombre, nro_inode);
+	if (cod == CODERROR_NO_IMPLEMENTADO)
+	{
+		nro_inode = 0;
+		cod = RecorrerEntradas(inode_dir, [&](unsigned inode_entry, const char *name, unsigned name_len)
+		{
+			if (name_len != long_nombre || memcmp(name, nombre, name_len))
+				return true;
+			nro_inode = inode_entry;
+			return false;
+		});
+	}
+	if (cod != CODERROR_NINGUNO)
+		return cod;
 
-	TINodeEXT inode_file;
-	memset(&inode_file, 0, sizeof(inode_file));
-	if (offset_in_block_file + bytes_por_inode <= (unsigned)DatosFS.BytesPorCluster)
+	/* Guardar el resultado, también si no se encontró (otro hilo puede haberlo guardado mientras tanto) */
+	std::lock_guard<std::mutex> lock(dentries_mutex);
+	if (dentries_indice.find(clave) != dentries_indice.end())
+		return CODERROR_NINGUNO;
+	if (cache_dentries.size() >= EXT_CACHE_DENTRIES)
 	{
-		memcpy(&inode_file, pblock_file + offset_in_block_file, (bytes_por_inode < sizeof(TINodeEXT)) ? bytes_por_inode : sizeof(TINodeEXT));
+		/* Reutilizar el nodo del usado hace más tiempo */
+		dentries_indice.erase(cache_dentries.back().clave);
+		cache_dentries.splice(cache_dentries.begin(), cache_dentries, std::prev(cache_dentries.end()));
 	}
 	else
+		cache_dentries.emplace_front();
+	cache_dentries.front().clave = clave;
+	cache_dentries.front().nro_inode = nro_inode;
+	dentries_indice.emplace(std::move(clave), cache_dentries.begin());
+
+	return CODERROR_NINGUNO;
+}
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverEXT :: BuscarEnHTree							*
+ *																	*
+ * OBJETIVO: Esta función busca un nombre en un directorio indexado, bajando por su HTree hasta la hoja donde tiene que estar.		*
+ *																	*
+ * ENTRADA: inode_dir: Inode del directorio (con EXT3_INDEX_FL).									*
+ *	    nombre: Nombre a buscar (no hace falta que termine en '\0').								*
+ *	    long_nombre: Longitud del nombre.												*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, CODERROR_NO_IMPLEMENTADO si el índice no se puede usar	*
+ *	   (hash desconocido o índice dañado, hay que recorrer el directorio entero), caso contrario el código de error.		*
+ *	   nro_inode: Número de inode de la entrada, o 0 si el directorio no tiene ese nombre.						*
+ *																	*
+ * OBSERVACIONES: Se lee la raíz, un bloque por cada nivel del índice y la hoja. Sólo se pasa a la hoja siguiente si su primer hash	*
+ *		  es el del nombre (nombres distintos con el mismo hash pueden quedar repartidos en varias hojas).			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::BuscarEnHTree(const TINodeEXT &inode_dir, const char *nombre, unsigned long_nombre, unsigned &nro_inode)
+{
+	unsigned block_size = (unsigned)DatosFS.BytesPorCluster;
+	nro_inode = 0;
+
+	TVisitanteEntradasEXT comparar = [&](unsigned inode_entry, const char *name, unsigned name_len)
+	{
+		if (name_len != long_nombre || memcmp(name, nombre, name_len))
+			return true;
+		nro_inode = inode_entry;
+		return false;
+	};
+
+	/* La raíz es el primer bloque: ".", ".." y los datos del índice (los nodos del camino quedan fijados mientras se usan) */
+	TSectorFijado raiz_fijado, nodos_fijados[EXT_HTREE_MAX_NIVELES], hoja_fijado;
+	const unsigned char *raiz = PunteroABloqueDirectorio(inode_dir, 0, raiz_fijado);
+	if (!raiz)
+		return CODERROR_NO_IMPLEMENTADO;
+
+	/* "." y ".." sólo están en la raíz */
+	if (long_nombre <= 2 && nombre[0] == '.' && (long_nombre == 1 || nombre[1] == '.'))
 	{
-		unsigned first_chunk = (unsigned)DatosFS.BytesPorCluster - offset_in_block_file;
-		unsigned to_copy = (bytes_por_inode < sizeof(TINodeEXT)) ? bytes_por_inode : sizeof(TINodeEXT);
-		unsigned copied = 0;
-		if (first_chunk > 0)
+		RecorrerBloqueEntradas(raiz, block_size, comparar);
+		return CODERROR_NINGUNO;
+	}
+
+	const TDxRaizEXT *info = (const TDxRaizEXT *)(raiz + 24);
+	if (info->reserved_zero != 0 || info->info_length != sizeof(TDxRaizEXT) || info->indirect_levels >= EXT_HTREE_MAX_NIVELES
+	    || info->hash_version > DX_HASH_TEA)
+		return CODERROR_NO_IMPLEMENTADO;
+
+	unsigned hash = HashNombre(nombre, long_nombre, info->hash_version + (hash_sin_signo ? DX_HASH_SIN_SIGNO : 0));
+	unsigned niveles = info->indirect_levels + 1;
+
+	/* Camino desde la raíz: entradas, cantidad y posición elegida en cada nivel */
+	const TDxEntradaEXT *entradas[EXT_HTREE_MAX_NIVELES];
+	unsigned cantidad[EXT_HTREE_MAX_NIVELES];
+	unsigned posicion[EXT_HTREE_MAX_NIVELES];
+
+	/* Valida un nodo y elige la última entrada con hash menor o igual (la primera no tiene hash, vale 0) o la primera */
+	auto cargar = [&](unsigned n, const unsigned char *nodo, unsigned espacio, bool buscar)
+	{
+		const unsigned char *cuenta = nodo;
+		unsigned limit = cuenta[0] | (cuenta[1] << 8);
+		unsigned count = cuenta[2] | (cuenta[3] << 8);
+		if (count == 0 || count > limit || limit * sizeof(TDxEntradaEXT) > espacio)
+			return false;
+
+		entradas[n] = (const TDxEntradaEXT *)nodo;
+		cantidad[n] = count;
+		posicion[n] = 0;
+		if (buscar)
 		{
-			unsigned c = (first_chunk < to_copy) ? first_chunk : to_copy;
-			memcpy(&((unsigned char*)&inode_file)[0], pblock_file + offset_in_block_file, c);
-			copied += c;
+			unsigned desde = 1, hasta = count;
+			while (desde < hasta)
+			{
+				unsigned medio = desde + (hasta - desde) / 2;
+				if (entradas[n][medio].hash > hash)
+					hasta = medio;
+				else
+					desde = medio + 1;
+			}
+			posicion[n] = desde - 1;
 		}
-		if (copied < to_copy)
+		return true;
+	};
+
+	/* Baja desde el nivel n hasta el último nivel del índice */
+	auto bajar = [&](unsigned n, bool buscar)
+	{
+		for (; n < niveles; n++)
 		{
-			const unsigned char *pblock2 = PunteroASector((__u64)(block_file + 1) * sectores_por_cluster);
-			if (!pblock2)
-				return CODERROR_LECTURA_DISCO;
-			memcpy(&((unsigned char*)&inode_file)[copied], pblock2, to_copy - copied);
+			const unsigned char *nodo = PunteroABloqueDirectorio(inode_dir, entradas[n-1][posicion[n-1]].block & EXT_HTREE_MASCARA_BLOQUE, nodos_fijados[n]);
+			if (!nodo || !cargar(n, nodo + 8, block_size - 8, buscar))
+				return false;
+		}
+		return true;
+	};
+
+	unsigned inicio_entradas = 24 + info->info_length;
+	if (!cargar(0, raiz + inicio_entradas, block_size - inicio_entradas, true) || !bajar(1, true))
+		return CODERROR_NO_IMPLEMENTADO;
+
+	while (true)
+	{
+		/* Buscar en la hoja */
+		const unsigned char *hoja = PunteroABloqueDirectorio(inode_dir, entradas[niveles-1][posicion[niveles-1]].block & EXT_HTREE_MASCARA_BLOQUE, hoja_fijado);
+		if (!hoja)
+			return CODERROR_NO_IMPLEMENTADO;
+		if (!RecorrerBloqueEntradas(hoja, block_size, comparar))
+			return CODERROR_NINGUNO;
+
+		/* Seguir con la hoja siguiente sólo si empieza con el mismo hash */
+		int n = (int)niveles - 1;
+		while (n >= 0 && posicion[n] + 1 >= cantidad[n])
+			n--;
+		if (n < 0 || (entradas[n][posicion[n] + 1].hash & ~1u) != hash)
+			return CODERROR_NINGUNO;
+		posicion[n]++;
+		if (!bajar(n + 1, false))
+			return CODERROR_NO_IMPLEMENTADO;
+	}
+}
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TDriverEXT :: HashNombre							*
+ *																	*
+ * OBJETIVO: Esta función calcula el hash de un nombre con el que se lo ubica en el HTree de un directorio.				*
+ *																	*
+ * ENTRADA: nombre: Nombre (no hace falta que termine en '\0').										*
+ *	    long_nombre: Longitud del nombre.												*
+ *	    version: DX_HASH_LEGACY, DX_HASH_HALF_MD4 o DX_HASH_TEA, más DX_HASH_SIN_SIGNO si los bytes se toman sin signo.		*
+ *																	*
+ * SALIDA: En el nombre de la función el hash (con el bit más bajo en cero, ese bit marca en el índice las colisiones).			*
+ *																	*
+ * OBSERVACIONES: Es ext4fs_dirhash(). half-MD4 y TEA parten de la semilla del superbloque, o de la de MD4 si está en cero.		*
+ *																	*
+ ****************************************************************************************************************************************/
+unsigned TDriverEXT::HashNombre(const char *nombre, unsigned long_nombre, unsigned version)
+{
+	bool sin_signo = (version >= DX_HASH_SIN_SIGNO);
+	if (sin_signo)
+		version -= DX_HASH_SIN_SIGNO;
+
+	unsigned estado[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+	if (hash_semilla[0] || hash_semilla[1] || hash_semilla[2] || hash_semilla[3])
+		memcpy(estado, hash_semilla, sizeof(estado));
+
+	unsigned entrada[8];
+	int resto = (int)long_nombre;
+	unsigned hash;
+	switch (version)
+	{
+	case DX_HASH_HALF_MD4:
+		for (; resto > 0; resto -= 32, nombre += 32)
+		{
+			ArmarBloqueHash(nombre, resto, entrada, 8, sin_signo);
+			TransformarMitadMD4(estado, entrada);
+		}
+		hash = estado[1];
+		break;
+	case DX_HASH_TEA:
+		for (; resto > 0; resto -= 16, nombre += 16)
+		{
+			ArmarBloqueHash(nombre, resto, entrada, 4, sin_signo);
+			TransformarTEA(estado, entrada);
+		}
+		hash = estado[0];
+		break;
+	default:
+		hash = HashLegacy(nombre, resto, sin_signo);
+		break;
+	}
+
+	/* 0xFFFFFFFE marca el fin de los directorios en readdir, no se usa como hash */
+	hash &= ~1u;
+	if (hash == (0x7fffffffu << 1))
+		hash = (0x7fffffffu - 1) << 1;
+	return hash;
+}
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TDriverEXT :: PunteroABloqueDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función devuelve dónde está en la imágen un bloque de un directorio.							*
+ *																	*
+ * ENTRADA: inode_dir: Inode del directorio.												*
+ *	    bloque: Número de bloque lógico dentro del directorio.									*
+ *	    fijado: Donde queda fijado el bloque (se suelta el que tuviera antes).							*
+ *																	*
+ * SALIDA: En el nombre de la función un puntero al bloque, válido mientras siga fijado, o NULL si no existe, es un hueco o no se pudo	*
+ *	   leer.															*
+ *																	*
+ ****************************************************************************************************************************************/
+const unsigned char *TDriverEXT::PunteroABloqueDirectorio(const TINodeEXT &inode_dir, __u64 bloque, TSectorFijado &fijado)
+{
+	fijado.Soltar();
+
+	unsigned long long size = (unsigned long long)inode_dir.i_size_lo;
+	size |= ((unsigned long long)inode_dir.i_size_high) << 32;
+
+	__u64 offset = bloque * DatosFS.BytesPorCluster;
+	if (offset + DatosFS.BytesPorCluster > size)
+		return NULL;
+
+	std::vector<TExtentArchivo> extents;
+	if (ArmarExtents(inode_dir, offset, DatosFS.BytesPorCluster, extents) != CODERROR_NINGUNO || extents.size() != 1 || extents[0].Hueco)
+		return NULL;
+
+	return fijado.Fijar(this, extents[0].OffsetImagen / DatosFS.BytesPorSector);
+}
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverEXT :: ResolverRuta							*
+ *																	*
+ * OBJETIVO: Esta función resuelve una ruta componente a componente, empezando en la raíz, y levanta el inode al que lleva.		*
+ *																	*
+ * ENTRADA: Path: Ruta absoluta (cadena de nombres de directorio separados por '/').							*
+ *	    cod_inexistente: Código de error a devolver si algún componente de la ruta no existe.					*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   nro_inode: Número del inode al que lleva la ruta.										*
+ *	   inode: El inode al que lleva la ruta (puede ser de un archivo o de un directorio).						*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::ResolverRuta(const char *Path, unsigned &nro_inode, TINodeEXT &inode, int cod_inexistente)
+{
+	if (!Path)
+		return CODERROR_PARAMETROS_INVALIDOS;
+
+	if (Path[0] != '/')
+		return CODERROR_RUTA_NO_ABSOLUTA;
+
+	/* Empezar en la raiz (inode 2) */
+	unsigned current_inode = EXT_ROOT_INO;
+	const char *componente = Path + 1; /* Saltar la primer / */
+	int cod;
+
+	while (*componente)
+	{
+		const char *fin = strchr(componente, '/');
+		if (!fin)
+			fin = componente + strlen(componente);
+		if (fin == componente)
+		{
+			componente++;
+			continue;
 		}
+
+		TINodeEXT inode_dir;
+		if ((cod = LeerINode(current_inode, inode_dir, cod_inexistente)) != CODERROR_NINGUNO)
+			return cod;
+
+		/* Verificar que sea directorio para poder buscar */
+		if (!S_ISDIR(inode_dir.i_mode))
+			return cod_inexistente;
+
+		/* Buscar el componente dentro del directorio */
+		unsigned nro_hijo;
+		if ((cod = BuscarEnDirectorio(current_inode, inode_dir, componente, (unsigned)(fin - componente), nro_hijo)) != CODERROR_NINGUNO)
+			return cod;
+
+		if (nro_hijo == 0)
+			return cod_inexistente;
+
+		current_inode = nro_hijo;
+		componente = *fin ? fin + 1 : fin;
 	}
 
+	/* Ahora current_inode es el inode al que lleva la ruta */
+	if ((cod = LeerINode(current_inode, inode, cod_inexistente)) != CODERROR_NINGUNO)
+		return cod;
+
+	nro_inode = current_inode;
+	return CODERROR_NINGUNO;
+}
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverEXT :: LeerINodeArchivo							*
+ *																	*
+ * OBJETIVO: Esta función levanta el inode de un archivo ya abierto.									*
+ *																	*
+ * ENTRADA: Manejador: Manejador del archivo.												*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   inode_file: El inode del archivo.												*
+ *																	*
+ * OBSERVACIONES: Devuelve CODERROR_ARCHIVO_INEXISTENTE si el inode es de un directorio.						*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::LeerINodeArchivo(const TManejadorArchivo &Manejador, TINodeEXT &inode_file)
+{
+	int cod = LeerINode(Manejador.DatosEspecificos.EXT.INode, inode_file, CODERROR_ARCHIVO_INEXISTENTE);
+	if (cod != CODERROR_NINGUNO)
+		return cod;
+
 	/* No podemos leer directorios como archivos */
 	if (S_ISDIR(inode_file.i_mode))
 		return CODERROR_ARCHIVO_INEXISTENTE;
 
-	unsigned long long size = (unsigned long long)inode_file.i_size_lo;
-	size |= ((unsigned long long)inode_file.i_size_high) << 32;
+	return CODERROR_NINGUNO;
+}
 
-	if (size == 0)
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverEXT :: RecorrerEntradas							*
+ *																	*
+ * OBJETIVO: Esta función recorre las entradas crudas (inode y nombre) de los bloques de un directorio.					*
+ *																	*
+ * ENTRADA: inode_dir: Inode del directorio.												*
+ *	    visitante: Función a llamar por cada entrada usada (si devuelve false se deja de recorrer).					*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: El nombre que recibe el visitante apunta a la imágen y no termina en '\0'.						*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::RecorrerEntradas(const TINodeEXT &inode_dir, const TVisitanteEntradasEXT &visitante)
+{
+	unsigned block_size = (unsigned)DatosFS.BytesPorCluster;
+
+	/* Mapear el directorio entero (bloques directos e indirectos o árbol de extents) */
+	unsigned long long size = (unsigned long long)inode_dir.i_size_lo;
+	size |= ((unsigned long long)inode_dir.i_size_high) << 32;
+
+	std::vector<TExtentArchivo> extents;
+	int cod = ArmarExtents(inode_dir, 0, size, extents);
+	if (cod != CODERROR_NINGUNO)
+		return cod;
+
+	/* Las entradas no cruzan bloques, así que se recorre cada bloque de cada tramo por separado */
+	for (size_t i = 0; i < extents.size(); i++)
 	{
-		Data = NULL;
-		DataLen = 0;
-		return CODERROR_NINGUNO;
+		if (extents[i].Hueco)
+			continue;
+
+		for (__u64 pos = 0; pos < extents[i].Longitud; pos += block_size)
+		{
+			TSectorFijado db_fijado;
+			const unsigned char *db = db_fijado.Fijar(this, (extents[i].OffsetImagen + pos) / DatosFS.BytesPorSector);
+			if (!db)
+				return CODERROR_LECTURA_DISCO;
+
+			if (!RecorrerBloqueEntradas(db, (unsigned)min((__u64)block_size, extents[i].Longitud - pos), visitante))
+				return CODERROR_NINGUNO;
+		}
+	}
+
+	return CODERROR_NINGUNO;
+}
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverEXT :: RecorrerBloqueEntradas							*
+ *																	*
+ * OBJETIVO: Esta función recorre las entradas crudas (inode y nombre) de un bloque de un directorio.					*
+ *																	*
+ * ENTRADA: bloque: Bloque del directorio.												*
+ *	    longitud: Bytes usados del bloque.												*
+ *	    visitante: Función a llamar por cada entrada usada (si devuelve false se deja de recorrer).					*
+ *																	*
+ * SALIDA: En el nombre de la función false si el visitante cortó el recorrido.								*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TDriverEXT::RecorrerBloqueEntradas(const unsigned char *bloque, unsigned longitud, const TVisitanteEntradasEXT &visitante)
+{
+	unsigned off = 0;
+	while (off + 8 <= longitud)
+	{
+		const unsigned char *entry = bloque + off;
+		unsigned inode_entry = entry[0] | (entry[1] << 8) | (entry[2] << 16) | (entry[3] << 24);
+		unsigned rec_len = entry[4] | (entry[5] << 8);
+		unsigned name_len = entry[6];
+
+		if (rec_len == 0)
+			break;
+
+		if (inode_entry != 0 && name_len > 0 && name_len < rec_len)
+			if (!visitante(inode_entry, (const char *)(entry + 8), name_len))
+				return false;
+
+		off += rec_len;
 	}
 
-	/* Truncar a 32 bits */
-	if (size > (unsigned long long)UINT_MAX)
-		return CODERROR_ARCHIVO_INVALIDO;
+	return true;
+}
 
-	DataLen = (unsigned)size;
-	Data = (unsigned char*)malloc(DataLen);
-	if (!Data)
-		return CODERROR_FALTA_MEMORIA;
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverEXT :: ArmarExtents							*
+ *																	*
+ * OBJETIVO: Esta función arma el mapa de un rango de bytes de un archivo a la imágen, siguiendo el mapa de bloques de su inode.	*
+ *																	*
+ * ENTRADA: inode_file: Inode del archivo.												*
+ *	    Offset: Posición dentro del archivo del primer byte del rango.								*
+ *	    Longitud: Cantidad de bytes del rango (tiene que estar dentro del archivo).							*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Extents: Tramos del rango, en orden. Los bloques físicamente contiguos y los huecos seguidos van en un solo tramo.		*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::ArmarExtents(const TINodeEXT &inode_file, __u64 Offset, __u64 Longitud, std::vector<TExtentArchivo> &Extents)
+{
+	Extents.clear();
+	if (Longitud == 0)
+		return CODERROR_NINGUNO;
+
+	/* Archivos con mapa de bloques (EXT2/EXT3 y los de EXT4 sin extents) */
+	if (!(inode_file.i_flags & EXT4_EXTENTS_FL))
+		return ArmarExtentsBloques(inode_file, Offset, Longitud, Extents);
 
+	/* Archivos con árbol de extents: la raíz está en i_block */
 	unsigned cluster_size = (unsigned)DatosFS.BytesPorCluster;
-	unsigned blocks_needed = (DataLen + cluster_size - 1) / cluster_size;
-	unsigned copied_total = 0;
+	int cod = ArmarExtentsArbol((const unsigned char *)inode_file.i_block, sizeof(inode_file.i_block), 0,
+				    Offset / cluster_size, (Offset + Longitud - 1) / cluster_size, Offset, Longitud, Extents);
+	if (cod != CODERROR_NINGUNO)
+		return cod;
 
-	/* Helper macro para leer uint32 little-endian desde un puntero p en offset o índice */
-	#define RD32_FROM_PTR(p, off) ((unsigned)((p)[(off)] | ((p)[(off)+1] << 8) | ((p)[(off)+2] << 16) | ((p)[(off)+3] << 24)))
+	/* Lo que quede después del último extent es un hueco */
+	__u64 cubierto = Extents.empty() ? Offset : Extents.back().OffsetArchivo + Extents.back().Longitud;
+	if (cubierto < Offset + Longitud)
+		AgregarTramo(Extents, cubierto, 0, Offset + Longitud - cubierto, true);
 
-	unsigned per_block_ptrs = cluster_size / 4;
+	return CODERROR_NINGUNO;
+}
 
-	for (unsigned lb = 0; lb < blocks_needed; lb++)
+/****************************************************************************************************************************************
+ *																	*
+ *						    TDriverEXT :: ArmarExtentsBloques							*
+ *																	*
+ * OBJETIVO: Esta función arma el mapa de un rango de bytes de un archivo a la imágen, siguiendo los punteros a bloques de su inode.	*
+ *																	*
+ * ENTRADA: inode_file: Inode del archivo.												*
+ *	    Offset: Posición dentro del archivo del primer byte del rango.								*
+ *	    Longitud: Cantidad de bytes del rango (tiene que estar dentro del archivo y no ser cero).					*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Extents: Tramos del rango agregados al final, en orden.									*
+ *																	*
+ * OBSERVACIONES: Recorre una sola vez el árbol de bloques de punteros (hasta el triple indirecto) y los bloques físicamente		*
+ *		  contiguos quedan en un solo tramo, así la copia mueve cada tramo entero de una vez.					*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::ArmarExtentsBloques(const TINodeEXT &inode_file, __u64 Offset, __u64 Longitud, std::vector<TExtentArchivo> &Extents)
+{
+	__u64 cluster_size = DatosFS.BytesPorCluster;
+	__u64 first_block = Offset / cluster_size;
+	__u64 last_block = (Offset + Longitud - 1) / cluster_size;
+	__u64 per_block_ptrs = cluster_size / 4;
+
+	/* Bloques directos */
+	for (__u64 lb = first_block; lb < 12 && lb <= last_block; lb++)
+		AgregarBloques(Extents, lb, 1, (unsigned)inode_file.i_block[lb], Offset, Longitud);
+
+	/* Indirecto simple, doble y triple: cada uno cubre per_block_ptrs veces más bloques que el anterior */
+	__u64 base = 12;
+	__u64 cubiertos = per_block_ptrs;
+	for (unsigned nivel = 1; nivel <= 3 && base <= last_block; nivel++)
 	{
-		unsigned phys_block = 0;
-
-		if (lb < 12)
-		{
-			phys_block = (unsigned)inode_file.i_block[lb];
-		}
-		else if (lb < 12 + per_block_ptrs)
+		if (base + cubiertos > first_block)
 		{
-			/* Indirecto simple */
-			unsigned idx = lb - 12;
-			unsigned indirect_block = (unsigned)inode_file.i_block[12];
-			if (indirect_block == 0)
-			{
-				phys_block = 0;
-			}
-			else
-			{
-				const unsigned char *ind = PunteroASector((__u64)indirect_block * sectores_por_cluster);
-				if (!ind)
-				{
-					free(Data);
-					Data = NULL;
-					DataLen = 0;
-					return CODERROR_LECTURA_DISCO;
-				}
-				phys_block = RD32_FROM_PTR(ind, idx*4);
-			}
+			int cod = ArmarExtentsIndirectos((unsigned)inode_file.i_block[11 + nivel], nivel, base, first_block, last_block, Offset, Longitud, Extents);
+			if (cod != CODERROR_NINGUNO)
+				return cod;
 		}
-		else if (lb < 12 + per_block_ptrs + per_block_ptrs * per_block_ptrs)
+		base += cubiertos;
+		cubiertos *= per_block_ptrs;
+	}
+
+	/* Más allá del triple indirecto no puede haber bloques */
+	if (base <= last_block)
+	{
+		__u64 desde = (base > first_block) ? base : first_block;
+		AgregarBloques(Extents, desde, last_block - desde + 1, 0, Offset, Longitud);
+	}
+
+	return CODERROR_NINGUNO;
+}
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TDriverEXT :: ArmarExtentsIndirectos							*
+ *																	*
+ * OBJETIVO: Esta función arma el mapa de la parte de un rango de bloques de un archivo que cuelga de un bloque de punteros.		*
+ *																	*
+ * ENTRADA: bloque: Bloque de punteros (0 si no está asignado, y entonces todo lo que cuelga de él es un hueco).			*
+ *	    nivel: 1 si apunta a bloques de datos, 2 si apunta a bloques de nivel 1 y 3 si apunta a bloques de nivel 2.			*
+ *	    base: Primer bloque lógico que cuelga de él.										*
+ *	    primer_bloque, ultimo_bloque: Primer y último bloque lógico del rango.							*
+ *	    Offset: Posición dentro del archivo del primer byte del rango.								*
+ *	    Longitud: Cantidad de bytes del rango.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Extents: Tramos del rango agregados al final, en orden.									*
+ *																	*
+ * OBSERVACIONES: Cada bloque de punteros se lee una sola vez y sólo se recorren sus punteros que caen dentro del rango.		*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::ArmarExtentsIndirectos(unsigned bloque, unsigned nivel, __u64 base, __u64 primer_bloque, __u64 ultimo_bloque, __u64 Offset, __u64 Longitud, std::vector<TExtentArchivo> &Extents)
+{
+	__u64 per_block_ptrs = DatosFS.BytesPorCluster / 4;
+	unsigned sectores_por_cluster = DatosFS.BytesPorCluster / DatosFS.BytesPorSector;
+
+	/* Bloques lógicos que cubre cada puntero de este nivel */
+	__u64 cubiertos = 1;
+	for (unsigned i = 1; i < nivel; i++)
+		cubiertos *= per_block_ptrs;
+
+	/* Punteros que caen dentro del rango */
+	__u64 desde = (primer_bloque > base) ? (primer_bloque - base) / cubiertos : 0;
+	__u64 hasta = min((ultimo_bloque - base) / cubiertos, per_block_ptrs - 1);
+
+	if (bloque == 0)
+	{
+		/* Sin bloque de punteros todo es un hueco */
+		__u64 lb = (primer_bloque > base) ? primer_bloque : base;
+		__u64 fin = min(ultimo_bloque, base + (hasta + 1) * cubiertos - 1);
+		AgregarBloques(Extents, lb, fin - lb + 1, 0, Offset, Longitud);
+		return CODERROR_NINGUNO;
+	}
+
+	TSectorFijado punteros_fijado;
+	const unsigned char *punteros = punteros_fijado.Fijar(this, (__u64)bloque * sectores_por_cluster);
+	if (!punteros)
+		return CODERROR_LECTURA_DISCO;
+
+	for (__u64 i = desde; i <= hasta; i++)
+	{
+		const unsigned char *p = punteros + i * 4;
+		unsigned hijo = p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24);
+
+		if (nivel == 1)
 		{
-			/* Indirecto doble */
-			unsigned rem = lb - (12 + per_block_ptrs);
-			unsigned idx1 = rem / per_block_ptrs;
-			unsigned idx2 = rem % per_block_ptrs;
-			unsigned dbl_block = (unsigned)inode_file.i_block[13];
-			if (dbl_block == 0)
-			{
-				phys_block = 0;
-			}
-			else
-			{
-				const unsigned char *dbl = PunteroASector((__u64)dbl_block * sectores_por_cluster);
-				if (!dbl)
-				{
-					free(Data);
-					Data = NULL;
-					DataLen = 0;
-					return CODERROR_LECTURA_DISCO;
-				}
-				unsigned first_level = RD32_FROM_PTR(dbl, idx1*4);
-				if (first_level == 0)
-				{
-					phys_block = 0;
-				}
-				else
-				{
-					const unsigned char *ind2 = PunteroASector((__u64)first_level * sectores_por_cluster);
-					if (!ind2)
-					{
-						free(Data);
-						Data = NULL;
-						DataLen = 0;
-						return CODERROR_LECTURA_DISCO;
-					}
-					phys_block = RD32_FROM_PTR(ind2, idx2*4);
-				}
-			}
+			AgregarBloques(Extents, base + i, 1, hijo, Offset, Longitud);
+			continue;
 		}
-		else
+
+		int cod = ArmarExtentsIndirectos(hijo, nivel - 1, base + i * cubiertos, primer_bloque, ultimo_bloque, Offset, Longitud, Extents);
+		if (cod != CODERROR_NINGUNO)
+			return cod;
+	}
+
+	return CODERROR_NINGUNO;
+}
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverEXT :: AgregarBloques							*
+ *																	*
+ * OBJETIVO: Esta función agrega al mapa de un rango de un archivo unos bloques lógicos seguidos, recortados al rango.			*
+ *																	*
+ * ENTRADA: Extents: Mapa del rango.													*
+ *	    bloque: Primer bloque lógico.												*
+ *	    cantidad: Cantidad de bloques.												*
+ *	    fisico: Bloque de la imágen del primero (los demás le siguen), o 0 si son un hueco.						*
+ *	    Offset: Posición dentro del archivo del primer byte del rango.								*
+ *	    Longitud: Cantidad de bytes del rango.											*
+ *																	*
+ * SALIDA: Extents: El mapa con los bloques agregados (juntados con el último tramo si son su continuación).				*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverEXT::AgregarBloques(std::vector<TExtentArchivo> &Extents, __u64 bloque, __u64 cantidad, __u64 fisico, __u64 Offset, __u64 Longitud)
+{
+	__u64 cluster_size = DatosFS.BytesPorCluster;
+
+	/* Sólo el primero y el último del rango pueden quedar parciales */
+	__u64 inicio = (bloque * cluster_size > Offset) ? bloque * cluster_size : Offset;
+	__u64 fin = min((bloque + cantidad) * cluster_size, Offset + Longitud);
+	if (fin <= inicio)
+		return;
+
+	AgregarTramo(Extents, inicio, fisico ? fisico * cluster_size + (inicio - bloque * cluster_size) : 0, fin - inicio, fisico == 0);
+}
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverEXT :: ArmarExtentsArbol							*
+ *																	*
+ * OBJETIVO: Esta función arma el mapa de un rango de bloques de un archivo a la imágen, recorriendo un nodo de su árbol de extents.	*
+ *																	*
+ * ENTRADA: nodo: Nodo del árbol (encabezado seguido de índices o de extents).								*
+ *	    long_nodo: Longitud en bytes del nodo (60 en la raíz, que está en el inode, y un bloque en los demás).			*
+ *	    profundidad: Cantidad de nodos por encima de éste.										*
+ *	    primer_bloque, ultimo_bloque: Primer y último bloque lógico del rango.							*
+ *	    Offset: Posición dentro del archivo del primer byte del rango.								*
+ *	    Longitud: Cantidad de bytes del rango.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Extents: Tramos del rango agregados al final, en orden. Cada extent del árbol es un único tramo (y sólo se parte si		*
+ *		    el rango empieza o termina en el medio), los bloques sin extent y los extents no inicializados son huecos.		*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::ArmarExtentsArbol(const unsigned char *nodo, unsigned long_nodo, unsigned profundidad, __u64 primer_bloque, __u64 ultimo_bloque, __u64 Offset, __u64 Longitud, std::vector<TExtentArchivo> &Extents)
+{
+	const TExtentHeaderEXT4 *header = (const TExtentHeaderEXT4 *)nodo;
+	unsigned entries = header->eh_entries;
+	unsigned cluster_size = (unsigned)DatosFS.BytesPorCluster;
+	unsigned sectores_por_cluster = cluster_size / DatosFS.BytesPorSector;
+
+	/* Validar el nodo (un árbol dañado no tiene que hacernos leer fuera del nodo ni entrar en un ciclo) */
+	if (header->eh_magic != EXT4_EXT_MAGIC || sizeof(TExtentHeaderEXT4) + entries * sizeof(TExtentNodeEXT4) > long_nodo
+	    || profundidad > EXT4_EXT_MAX_PROFUNDIDAD)
+		return CODERROR_FILESYSTEM_CORRUPTO;
+
+	if (header->eh_depth == 0)
+	{
+		/* Hoja: cada extent es un tramo de bloques contiguos */
+		const TExtentNodeEXT4 *extent = (const TExtentNodeEXT4 *)(nodo + sizeof(TExtentHeaderEXT4));
+		for (unsigned i = 0; i < entries; i++)
 		{
-			/* Triple indirecto no lo implementamos */
-			phys_block = 0;
+			__u64 bloque = extent[i].ee_block;
+			unsigned len = extent[i].ee_len;
+			bool sin_inicializar = (len > EXT4_EXT_INIT_MAX_LEN);
+			if (sin_inicializar)
+				len -= EXT4_EXT_INIT_MAX_LEN;
+
+			if (bloque + len <= primer_bloque)
+				continue;
+			if (bloque > ultimo_bloque)
+				break;
+
+			/* Los bloques salteados hasta acá son un hueco */
+			__u64 cubierto = Extents.empty() ? Offset : Extents.back().OffsetArchivo + Extents.back().Longitud;
+			if (cubierto < bloque * cluster_size)
+				AgregarTramo(Extents, cubierto, 0, bloque * cluster_size - cubierto, true);
+
+			__u64 fisico = ((__u64)extent[i].ee_start_hi << 32) | extent[i].ee_start_lo;
+			AgregarBloques(Extents, bloque, len, sin_inicializar ? 0 : fisico, Offset, Longitud);
 		}
+		return CODERROR_NINGUNO;
+	}
+
+	/* Índice: bajar a cada hijo que cubre parte del rango (el hijo i cubre hasta donde empieza el i+1) */
+	const TExtentIndexEXT4 *index = (const TExtentIndexEXT4 *)(nodo + sizeof(TExtentHeaderEXT4));
+	for (unsigned i = 0; i < entries; i++)
+	{
+		if (i + 1 < entries && index[i+1].ei_block <= primer_bloque)
+			continue;
+		if (index[i].ei_block > ultimo_bloque)
+			break;
 
-		/* Copiar */
-		unsigned to_copy = min(cluster_size, DataLen - copied_total);
-		if (phys_block == 0)
+		__u64 hijo = ((__u64)index[i].ei_leaf_hi << 32) | index[i].ei_leaf_lo;
+		TSectorFijado pnodo_fijado;
+		const unsigned char *pnodo = pnodo_fijado.Fijar(this, hijo * sectores_por_cluster);
+		if (!pnodo)
+			return CODERROR_LECTURA_DISCO;
+
+		int cod = ArmarExtentsArbol(pnodo, cluster_size, profundidad + 1, primer_bloque, ultimo_bloque, Offset, Longitud, Extents);
+		if (cod != CODERROR_NINGUNO)
+			return cod;
+	}
+
+	return CODERROR_NINGUNO;
+}
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverEXT :: AgregarTramo							*
+ *																	*
+ * OBJETIVO: Esta función agrega un tramo al final del mapa de un archivo, juntándolo con el último si es su continuación.		*
+ *																	*
+ * ENTRADA: Extents: Mapa del archivo.													*
+ *	    OffsetArchivo: Posición dentro del archivo del tramo (tiene que ser donde termina el último).				*
+ *	    OffsetImagen: Posición dentro de la imágen del tramo (no se usa si es un hueco).						*
+ *	    Longitud: Cantidad de bytes del tramo.											*
+ *	    Hueco: true si el tramo no tiene bloques asignados.										*
+ *																	*
+ * SALIDA: Extents: El mapa con el tramo agregado.											*
+ *																	*
+ ****************************************************************************************************************************************/
+void TDriverEXT::AgregarTramo(std::vector<TExtentArchivo> &Extents, __u64 OffsetArchivo, __u64 OffsetImagen, __u64 Longitud, bool Hueco)
+{
+	if (!Extents.empty() && Extents.back().Hueco == Hueco
+		&& (Hueco || Extents.back().OffsetImagen + Extents.back().Longitud == OffsetImagen))
+	{
+		/* Físicamente contiguo al anterior (o un hueco que sigue a otro), agrandar el tramo */
+		Extents.back().Longitud += Longitud;
+		return;
+	}
+
+	TExtentArchivo extent;
+	extent.OffsetArchivo = OffsetArchivo;
+	extent.OffsetImagen = Hueco ? 0 : OffsetImagen;
+	extent.Longitud = Longitud;
+	extent.Hueco = Hueco;
+	Extents.push_back(extent);
+}
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TDriverEXT :: LeerBloques							*
+ *																	*
+ * OBJETIVO: Esta función copia un rango de bytes de un archivo a un buffer, siguiendo el mapa de bloques de su inode.			*
+ *																	*
+ * ENTRADA: inode_file: Inode del archivo.												*
+ *	    Offset: Posición dentro del archivo del primer byte a copiar.								*
+ *	    Longitud: Cantidad de bytes a copiar (el rango tiene que estar dentro del archivo).						*
+ *	    Destino: Buffer de al menos Longitud bytes.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Los huecos van en cero. Cada tramo con datos es un rango de lectura y todos los rangos se leen con un único pedido	*
+ *		  a la fuente.														*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverEXT::LeerBloques(const TINodeEXT &inode_file, __u64 Offset, __u64 Longitud, unsigned char *Destino)
+{
+	std::vector<TExtentArchivo> extents;
+	int cod = ArmarExtents(inode_file, Offset, Longitud, extents);
+	if (cod != CODERROR_NINGUNO)
+		return cod;
+
+	/* Los huecos van en cero, los tramos con datos se juntan para leerlos todos juntos al final */
+	std::vector<TRangoLectura> rangos;
+	for (size_t i = 0; i < extents.size(); i++)
+	{
+		unsigned char *dest = Destino + (extents[i].OffsetArchivo - Offset);
+		if (extents[i].Hueco)
 		{
-			memset(Data + copied_total, 0, to_copy);
+			memset(dest, 0, (size_t)extents[i].Longitud);
 		}
 		else
 		{
-			const unsigned char *pdat = PunteroASector((__u64)phys_block * sectores_por_cluster);
-			if (!pdat)
-			{
-				free(Data);
-				Data = NULL;
-				DataLen = 0;
-				return CODERROR_LECTURA_DISCO;
-			}
-			memcpy(Data + copied_total, pdat, to_copy);
+			TRangoLectura rango;
+			rango.Offset = extents[i].OffsetImagen;
+			rango.Longitud = extents[i].Longitud;
+			rango.Destino = dest;
+			rangos.push_back(rango);
 		}
-
-		copied_total += to_copy;
 	}
 
-	#undef RD32_FROM_PTR
+	/* Leer todos los rangos de datos en un solo pedido */
+	if (!rangos.empty() && LeerRangos(&rangos[0], (unsigned)rangos.size()) != CODERROR_NINGUNO)
+		return CODERROR_LECTURA_DISCO;
 
 	return CODERROR_NINGUNO;
 }
\ No newline at end of file
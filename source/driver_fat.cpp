@@ -12,13 +12,12 @@
  *																	*
  * OBJETIVO: Inicializar la clase recién creada.											*
  *																	*
- * ENTRADA: DiskData: Puntero a un bloque de memoria con la imágen del disco a analizar.						*
- *	    LongitudDiskData: Tamaño, en bytes, de la imágen a analizar.								*
+ * ENTRADA: Fuente: Origen de los datos de la imágen del disco a analizar.								*
  *																	*
  * SALIDA: Nada.															*
  *																	*
  ****************************************************************************************************************************************/
-TDriverFAT::TDriverFAT(const unsigned char *DiskData, unsigned LongitudDiskData) : TDriverBase(DiskData, LongitudDiskData)
+TDriverFAT::TDriverFAT(TFuenteSectores *Fuente) : TDriverBase(Fuente)
 {
 }
 
@@ -39,6 +38,64 @@ TDriverFAT::~TDriverFAT()
 }
 
 
+/****************************************************************************************************************************************
+ *																	*
+ *							  TDriverFAT :: Sondear								*
+ *																	*
+ * OBJETIVO: Esta función revisa si el comienzo de la imágen tiene un BPB de FAT razonable, sin levantar el superbloque.		*
+ *																	*
+ * ENTRADA: Inicio: Primeros bytes de la imágen.											*
+ *	    Longitud: Cantidad de bytes en Inicio.											*
+ *																	*
+ * SALIDA: En el nombre de la función true si la imágen puede ser FAT12/FAT16/FAT32.							*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TDriverFAT::Sondear(const unsigned char *Inicio, unsigned Longitud)
+{
+unsigned	BytesPorSector, SectoresPorCluster;
+
+/* Tiene que haber un boot sector completo terminado en 0x55 0xAA */
+if ( (Longitud<512) || (Inicio[510]!=0x55) || (Inicio[511]!=0xAA) )
+	return(false);
+
+/* Instrucción de salto al código de arranque */
+if ( (Inicio[0]!=0xEB) && (Inicio[0]!=0xE9) )
+	return(false);
+
+/* Bytes por sector y sectores por cluster tienen que ser potencias de 2 razonables */
+BytesPorSector=Inicio[11] | (Inicio[12] << 8);
+SectoresPorCluster=Inicio[13];
+if ( (BytesPorSector<512) || (BytesPorSector>4096) || (BytesPorSector & (BytesPorSector-1)) )
+	return(false);
+if ( (SectoresPorCluster==0) || (SectoresPorCluster & (SectoresPorCluster-1)) )
+	return(false);
+
+/* Sectores reservados y cantidad de FATs (NTFS tiene ambos en cero) */
+if ( ((Inicio[14] | (Inicio[15] << 8)) == 0) || (Inicio[16]==0) )
+	return(false);
+
+/* Salir */
+return(true);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							   TDriverFAT :: Crear								*
+ *																	*
+ * OBJETIVO: Esta función construye el driver (para el registro de drivers).								*
+ *																	*
+ * ENTRADA: Fuente: Origen de los datos de la imágen del disco a analizar.								*
+ *																	*
+ * SALIDA: En el nombre de la función el driver creado.											*
+ *																	*
+ ****************************************************************************************************************************************/
+TDriverBase *TDriverFAT::Crear(TFuenteSectores *Fuente)
+{
+return(new TDriverFAT(Fuente));
+}
+
+
 /****************************************************************************************************************************************
  *																	*
  *						   TDriverFAT :: LevantarDatosSuperbloque						*
@@ -62,17 +119,84 @@ return(CODERROR_FILESYSTEM_DESCONOCIDO);
 
 /****************************************************************************************************************************************
  *																	*
- *						  TDriverFAT :: ListarDirectorio							*
+ *						    TDriverFAT :: RecorrerDirectorio							*
  *																	*
- * OBJETIVO: Esta función enumera las entradas en un directorio y retorna un arreglo de elementos, uno por cada entrada.		*
+ * OBJETIVO: Esta función recorre las entradas de un directorio y llama al visitante con cada una a medida que la decodifica.		*
  *																	*
- * ENTRADA: Path: Path al directorio enumerar (cadena de nombres de directorio separados por '/').					*
+ * ENTRADA: Manejador: Manejador del directorio a recorrer.										*
+ *	    Visitante: Función a llamar por cada entrada (si devuelve false se deja de recorrer).					*
  *																	*
  * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
- *	   Entradas: Arreglo con cada una de las entradas.										*
  *																	*
  ****************************************************************************************************************************************/
-int TDriverFAT::ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas)
+int TDriverFAT::RecorrerDirectorio(const TManejadorArchivo &Manejador, const TVisitanteDirectorio &Visitante)
+{
+/* Salir */
+return(CODERROR_FILESYSTEM_DESCONOCIDO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							   TDriverFAT :: Abrir								*
+ *																	*
+ * OBJETIVO: Esta función ubica un archivo o directorio dada su ruta y devuelve un manejador para operar sobre él.			*
+ *																	*
+ * ENTRADA: Path: Ruta absoluta al archivo o directorio.										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Manejador: Lo necesario para volver a ubicarlo sin resolver la ruta.								*
+ *																	*
+ * OBSERVACIONES: El manejador guarda el primer cluster y el tamaño de la entrada de directorio, así leer no vuelve a buscar la ruta.	*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverFAT::Abrir(const char *Path, TManejadorArchivo &Manejador)
+{
+/* Salir */
+return(CODERROR_FILESYSTEM_DESCONOCIDO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverFAT :: LeerRangoArchivo							*
+ *																	*
+ * OBJETIVO: Esta función lee de la imágen una parte de un archivo ya abierto, en un buffer del llamador.				*
+ *																	*
+ * ENTRADA: Manejador: Manejador del archivo a leer.											*
+ *	    Offset: Posición dentro del archivo del primer byte a leer.									*
+ *	    Longitud: Cantidad de bytes a leer.												*
+ *	    Destino: Buffer de al menos Longitud bytes.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Leidos: Cantidad de bytes copiados a Destino (menos que Longitud si el rango pasa el fin del archivo).			*
+ *																	*
+ * OBSERVACIONES: Igual que LeerArchivo() pero sin alocar el archivo entero: la cadena de clusters se sigue sólo hasta el último	*
+ *		  cluster del rango pedido.												*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverFAT::LeerRangoArchivo(const TManejadorArchivo &Manejador, __u64 Offset, __u64 Longitud, unsigned char *Destino, __u64 &Leidos)
+{
+/* Salir */
+return(CODERROR_FILESYSTEM_DESCONOCIDO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TDriverFAT :: MapearArchivo							*
+ *																	*
+ * OBJETIVO: Esta función devuelve dónde está cada tramo de un archivo dentro de la imágen, sin leer sus datos.				*
+ *																	*
+ * ENTRADA: Manejador: Manejador del archivo a mapear.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Extents: Tramos del archivo en orden, cubriéndolo entero (los huecos marcados como tales).					*
+ *																	*
+ * OBSERVACIONES: Cada tramo es una serie de clusters consecutivos de la cadena de la FAT.						*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverFAT::MapearArchivo(const TManejadorArchivo &Manejador, std::vector<TExtentArchivo> &Extents)
 {
 /* Salir */
 return(CODERROR_FILESYSTEM_DESCONOCIDO);
@@ -81,20 +205,19 @@ return(CODERROR_FILESYSTEM_DESCONOCIDO);
 
 /****************************************************************************************************************************************
  *																	*
- *						     TDriverFAT :: LeerArchivo								*
+ *							   TDriverFAT :: Stat								*
  *																	*
- * OBJETIVO: Esta función levanta de la imágen un archivo dada su ruta.									*
+ * OBJETIVO: Esta función levanta los datos de un archivo o directorio ya abierto como si fuera su entrada de directorio.		*
  *																	*
- * ENTRADA: Path: Ruta al archivo a levantar.												*
+ * ENTRADA: Manejador: Manejador del archivo o directorio.										*
  *																	*
  * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
- *	   Data: Buffer alocado con malloc() con los datos del archivo.									*
- *	   DataLen: Tamaño en bytes del buffer devuelto.										*
+ *	   Entrada: Datos de la entrada (el nombre lo completa quien llama).								*
  *																	*
- * OBSERVACIONES: Los valores Data y DataLen sólo devuelven valores válidos si se retorna CODERROR_NINGUNO.				*
+ * OBSERVACIONES: En FAT los datos están en la entrada de directorio y no en el cluster: el manejador tiene que alcanzar para releerla.	*
  *																	*
  ****************************************************************************************************************************************/
-int TDriverFAT::LeerArchivo(const char *Path, unsigned char *&Data, unsigned &DataLen)
+int TDriverFAT::Stat(const TManejadorArchivo &Manejador, TEntradaDirectorio &Entrada)
 {
 /* Salir */
 return(CODERROR_FILESYSTEM_DESCONOCIDO);
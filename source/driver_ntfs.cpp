@@ -12,13 +12,12 @@
  *																	*
  * OBJETIVO: Inicializar la clase recién creada.											*
  *																	*
- * ENTRADA: DiskData: Puntero a un bloque de memoria con la imágen del disco a analizar.						*
- *	    LongitudDiskData: Tamaño, en bytes, de la imágen a analizar.								*
+ * ENTRADA: Fuente: Origen de los datos de la imágen del disco a analizar.								*
  *																	*
  * SALIDA: Nada.															*
  *																	*
  ****************************************************************************************************************************************/
-TDriverNTFS::TDriverNTFS(const unsigned char *DiskData, unsigned LongitudDiskData) : TDriverBase(DiskData, LongitudDiskData)
+TDriverNTFS::TDriverNTFS(TFuenteSectores *Fuente) : TDriverBase(Fuente)
 {
 }
 
@@ -39,6 +38,44 @@ TDriverNTFS::~TDriverNTFS()
 }
 
 
+/****************************************************************************************************************************************
+ *																	*
+ *							 TDriverNTFS :: Sondear								*
+ *																	*
+ * OBJETIVO: Esta función revisa si el comienzo de la imágen tiene el OEM id de NTFS, sin levantar el superbloque.			*
+ *																	*
+ * ENTRADA: Inicio: Primeros bytes de la imágen.											*
+ *	    Longitud: Cantidad de bytes en Inicio.											*
+ *																	*
+ * SALIDA: En el nombre de la función true si la imágen puede ser NTFS.									*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TDriverNTFS::Sondear(const unsigned char *Inicio, unsigned Longitud)
+{
+/* Boot sector completo, terminado en 0x55 0xAA, con "NTFS    " como OEM id */
+if ( (Longitud<512) || (Inicio[510]!=0x55) || (Inicio[511]!=0xAA) )
+	return(false);
+return(memcmp(Inicio+3, "NTFS    ", 8)==0);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							  TDriverNTFS :: Crear								*
+ *																	*
+ * OBJETIVO: Esta función construye el driver (para el registro de drivers).								*
+ *																	*
+ * ENTRADA: Fuente: Origen de los datos de la imágen del disco a analizar.								*
+ *																	*
+ * SALIDA: En el nombre de la función el driver creado.											*
+ *																	*
+ ****************************************************************************************************************************************/
+TDriverBase *TDriverNTFS::Crear(TFuenteSectores *Fuente)
+{
+return(new TDriverNTFS(Fuente));
+}
+
+
 /****************************************************************************************************************************************
  *																	*
  *						   TDriverNTFS :: LevantarDatosSuperbloque						*
@@ -62,17 +99,85 @@ return(CODERROR_NO_IMPLEMENTADO);
 
 /****************************************************************************************************************************************
  *																	*
- *						  TDriverNTFS :: ListarDirectorio							*
+ *						    TDriverNTFS :: RecorrerDirectorio							*
  *																	*
- * OBJETIVO: Esta función enumera las entradas en un directorio y retorna un arreglo de elementos, uno por cada entrada.		*
+ * OBJETIVO: Esta función recorre las entradas de un directorio y llama al visitante con cada una a medida que la decodifica.		*
  *																	*
- * ENTRADA: Path: Path al directorio enumerar (cadena de nombres de directorio separados por '/').					*
+ * ENTRADA: Manejador: Manejador del directorio a recorrer.										*
+ *	    Visitante: Función a llamar por cada entrada (si devuelve false se deja de recorrer).					*
  *																	*
  * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
- *	   Entradas: Arreglo con cada una de las entradas.										*
  *																	*
  ****************************************************************************************************************************************/
-int TDriverNTFS::ListarDirectorio(const char *Path, std::vector<TEntradaDirectorio> &Entradas)
+int TDriverNTFS::RecorrerDirectorio(const TManejadorArchivo &Manejador, const TVisitanteDirectorio &Visitante)
+{
+/* Salir */
+return(CODERROR_NO_IMPLEMENTADO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							  TDriverNTFS :: Abrir								*
+ *																	*
+ * OBJETIVO: Esta función ubica un archivo o directorio dada su ruta y devuelve un manejador para operar sobre él.			*
+ *																	*
+ * ENTRADA: Path: Ruta absoluta al archivo o directorio.										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Manejador: Lo necesario para volver a ubicarlo sin resolver la ruta.								*
+ *																	*
+ * OBSERVACIONES: El manejador guarda la referencia al registro de la MFT (índice y número de secuencia) y el tamaño de $DATA.		*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::Abrir(const char *Path, TManejadorArchivo &Manejador)
+{
+/* Salir */
+return(CODERROR_NO_IMPLEMENTADO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TDriverNTFS :: LeerRangoArchivo							*
+ *																	*
+ * OBJETIVO: Esta función lee de la imágen una parte de un archivo ya abierto, en un buffer del llamador.				*
+ *																	*
+ * ENTRADA: Manejador: Manejador del archivo a leer.											*
+ *	    Offset: Posición dentro del archivo del primer byte a leer.									*
+ *	    Longitud: Cantidad de bytes a leer.												*
+ *	    Destino: Buffer de al menos Longitud bytes.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Leidos: Cantidad de bytes copiados a Destino (menos que Longitud si el rango pasa el fin del archivo).			*
+ *																	*
+ * OBSERVACIONES: Igual que LeerArchivo() pero sin alocar el archivo entero: de los data runs del atributo $DATA sólo se leen los que	*
+ *		  cubren el rango pedido.												*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::LeerRangoArchivo(const TManejadorArchivo &Manejador, __u64 Offset, __u64 Longitud, unsigned char *Destino, __u64 &Leidos)
+{
+/* Salir */
+return(CODERROR_NO_IMPLEMENTADO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TDriverNTFS :: MapearArchivo							*
+ *																	*
+ * OBJETIVO: Esta función devuelve dónde está cada tramo de un archivo dentro de la imágen, sin leer sus datos.				*
+ *																	*
+ * ENTRADA: Manejador: Manejador del archivo a mapear.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Extents: Tramos del archivo en orden, cubriéndolo entero (los huecos marcados como tales).					*
+ *																	*
+ * OBSERVACIONES: Cada data run del atributo $DATA es un tramo (los runs sin LCN son huecos). Los archivos residentes no tienen		*
+ *		  tramos en la imágen fuera del file record.										*
+ *																	*
+ ****************************************************************************************************************************************/
+int TDriverNTFS::MapearArchivo(const TManejadorArchivo &Manejador, std::vector<TExtentArchivo> &Extents)
 {
 /* Salir */
 return(CODERROR_NO_IMPLEMENTADO);
@@ -81,20 +186,19 @@ return(CODERROR_NO_IMPLEMENTADO);
 
 /****************************************************************************************************************************************
  *																	*
- *						     TDriverNTFS :: LeerArchivo								*
+ *							   TDriverNTFS :: Stat								*
  *																	*
- * OBJETIVO: Esta función levanta de la imágen un archivo dada su ruta.									*
+ * OBJETIVO: Esta función levanta los datos de un archivo o directorio ya abierto como si fuera su entrada de directorio.		*
  *																	*
- * ENTRADA: Path: Ruta al archivo a levantar.												*
+ * ENTRADA: Manejador: Manejador del archivo o directorio.										*
  *																	*
  * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
- *	   Data: Buffer alocado con malloc() con los datos del archivo.									*
- *	   DataLen: Tamaño en bytes del buffer devuelto.										*
+ *	   Entrada: Datos de la entrada (el nombre lo completa quien llama).								*
  *																	*
- * OBSERVACIONES: Los valores Data y DataLen sólo devuelven valores válidos si se retorna CODERROR_NINGUNO.				*
+ * OBSERVACIONES: Sale de $STANDARD_INFORMATION y $DATA del registro de la MFT del manejador, sin tocar el índice del directorio.	*
  *																	*
  ****************************************************************************************************************************************/
-int TDriverNTFS::LeerArchivo(const char *Path, unsigned char *&Data, unsigned &DataLen)
+int TDriverNTFS::Stat(const TManejadorArchivo &Manejador, TEntradaDirectorio &Entrada)
 {
 /* Salir */
 return(CODERROR_NO_IMPLEMENTADO);
@@ -0,0 +1,1000 @@
+﻿#include "all_heads.h"
+
+
+/************************
+ *			*
+ *     Constantes	*
+ *			*
+ ************************/
+static const char	DigitosBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char	DigitosHexa[] = "0123456789abcdef";
+
+/* Letras de los flags de una entrada, en el mismo orden que en el listado de texto */
+static const struct
+    {
+	unsigned	Flag;
+	char		Letra;
+    }			LetrasFlags[] =
+    {
+	{fedSOLO_LECTURA,	'R'},
+	{fedOCULTO,		'H'},
+	{fedSISTEMA,		'S'},
+	{fedETIQUETA_VOLUMEN,	'V'},
+	{fedDIRECTORIO,		'D'},
+	{fedARCHIVAR,		'A'},
+	{fedACCESO_DIRECTO,	'L'},
+	{fedCOMPRIMIDO,		'C'},
+	{fedENCRIPTADO,		'E'},
+	{fedDISPERSO,		'P'}
+    };
+
+
+/********************************
+ *				*
+ *   Clase TEmisorRegistros	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *						  TEmisorRegistros :: TEmisorRegistros							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Salida: Buffer de salida en el que se escriben los registros (sigue siendo propiedad del llamador).				*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TEmisorRegistros::TEmisorRegistros(TSalida *Salida)
+{
+TEmisorRegistros::Salida=Salida;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TEmisorRegistros :: ~TEmisorRegistros							*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TEmisorRegistros::~TEmisorRegistros()
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TEmisorRegistros :: Crear							*
+ *																	*
+ * OBJETIVO: Esta función construye el emisor que corresponde a un formato de salida.							*
+ *																	*
+ * ENTRADA: Formato: Formato pedido.													*
+ *	    Salida: Buffer de salida en el que se escriben los registros.								*
+ *																	*
+ * SALIDA: En el nombre de la función el emisor (a liberar con delete), o NULL para el formato de texto, que no usa registros.		*
+ *																	*
+ ****************************************************************************************************************************************/
+TEmisorRegistros *TEmisorRegistros::Crear(TFormatoSalida Formato, TSalida *Salida)
+{
+switch (Formato)
+    {
+	case fmtJSONL:
+		return(new TEmisorJSONL(Salida));
+	case fmtBINARIO:
+		return(new TEmisorBinario(Salida));
+	default:
+		return(NULL);
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TEmisorRegistros :: NombreFormato							*
+ *																	*
+ * OBJETIVO: Esta función devuelve el nombre de un tipo de filesystem, igual al que muestra el listado de texto.			*
+ *																	*
+ * ENTRADA: Tipo: Tipo de filesystem.													*
+ *																	*
+ * SALIDA: En el nombre de la función el nombre.											*
+ *																	*
+ ****************************************************************************************************************************************/
+const char *TEmisorRegistros::NombreFormato(TipoFilsystem Tipo)
+{
+switch (Tipo)
+    {
+	case tfsFAT12:
+		return("FAT12");
+	case tfsFAT16:
+		return("FAT16");
+	case tfsFAT32:
+		return("FAT32");
+	case tfsEXT2:
+		return("EXT2");
+	case tfsEXT3:
+		return("EXT3");
+	case tfsEXT4:
+		return("EXT4");
+	case tfsNTFS:
+		return("NTFS");
+	default:
+		return("DESCONOCIDO");
+    }
+}
+
+
+/********************************
+ *				*
+ *     Clase TEmisorJSONL	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *						      TEmisorJSONL :: TEmisorJSONL							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Salida: Buffer de salida en el que se escriben los registros.								*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TEmisorJSONL::TEmisorJSONL(TSalida *Salida) : TEmisorRegistros(Salida)
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TEmisorJSONL :: ~TEmisorJSONL							*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TEmisorJSONL::~TEmisorJSONL()
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TEmisorJSONL :: Imagen								*
+ *																	*
+ * OBJETIVO: Esta función emite el registro que abre el informe de una imágen.								*
+ *																	*
+ * ENTRADA: Ruta: Ruta a la imágen.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorJSONL::Imagen(const char *Ruta)
+{
+Salida->Cadena("{\"tipo\":\"imagen\"");
+Texto("ruta", Ruta, strlen(Ruta));
+Salida->Cadena("}\n");
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TEmisorJSONL :: Superbloque							*
+ *																	*
+ * OBJETIVO: Esta función emite los datos del superbloque, con los mismos campos que muestra el listado de texto.			*
+ *																	*
+ * ENTRADA: DatosFS: Datos levantados por el driver.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorJSONL::Superbloque(const TDatosFS &DatosFS)
+{
+const char	*Formato = NombreFormato(DatosFS.TipoFilesystem);
+int		i;
+
+/* Valores comunes a todos los filesystems */
+Salida->Cadena("{\"tipo\":\"superbloque\"");
+Texto("formato", Formato, strlen(Formato));
+Numero("bytes_por_sector", (unsigned)DatosFS.BytesPorSector);
+Numero("bytes_por_cluster", (unsigned)DatosFS.BytesPorCluster);
+Numero("nro_clusters", DatosFS.NumeroDeClusters);
+
+/* Valores propios de cada filesystem */
+switch (DatosFS.TipoFilesystem)
+    {
+	case tfsFAT12:
+	case tfsFAT16:
+	case tfsFAT32:
+		Numero("nro_sectores", (unsigned)DatosFS.DatosEspecificos.FAT.TotalSectores);
+		Numero("nro_sectores_ocultos", (unsigned)DatosFS.DatosEspecificos.FAT.SectoresOcultos);
+		Numero("nro_sectores_reservados", (unsigned)DatosFS.DatosEspecificos.FAT.SectoresReservados);
+		Numero("nro_copias_fat", (unsigned)DatosFS.DatosEspecificos.FAT.CopiasFAT);
+		Numero("nro_entradas_rootdir", (unsigned)DatosFS.DatosEspecificos.FAT.EntradasRootDir);
+		Numero("sectores_por_cluster", (unsigned)DatosFS.DatosEspecificos.FAT.SectoresPorCluster);
+		Numero("sectores_por_fat", (unsigned)DatosFS.DatosEspecificos.FAT.SectoresPorFAT);
+		Numero("nro_clusters_rootdir", (unsigned)DatosFS.DatosEspecificos.FAT.ClustersRootDir);
+		Numero("primer_cluster_rootdir", (unsigned)DatosFS.DatosEspecificos.FAT.PrimerClusterRootDir);
+		break;
+	case tfsEXT2:
+	case tfsEXT3:
+	case tfsEXT4:
+		Numero("caracteristicas_compatibles", (unsigned)DatosFS.DatosEspecificos.EXT.CaracteristicasCompatibles);
+		Numero("caracteristicas_incompatibles", (unsigned)DatosFS.DatosEspecificos.EXT.CaracteristicasIncompatibles);
+		Numero("caracteristicas_solo_lectura", (unsigned)DatosFS.DatosEspecificos.EXT.CaracteristicasSoloLectura);
+		Numero("clusters_por_grupo", (unsigned)DatosFS.DatosEspecificos.EXT.ClustersPorGrupo);
+		Numero("inodes_por_grupo", (unsigned)DatosFS.DatosEspecificos.EXT.INodesPorGrupo);
+		Numero("bytes_por_inode", (unsigned)DatosFS.DatosEspecificos.EXT.BytesPorINode);
+		Numero("nro_inodes", (unsigned)DatosFS.DatosEspecificos.EXT.NumeroDeINodes);
+		Numero("nro_grupos", (unsigned)DatosFS.DatosEspecificos.EXT.NroGrupos);
+		Numero("periodo_agrupado_flex", (unsigned)DatosFS.DatosEspecificos.EXT.PeriodoAgrupadoFlex);
+		Numero("nro_clusters_reservados_gdt", (unsigned)DatosFS.DatosEspecificos.EXT.ClustersReservadosGDT);
+
+		/* Un objeto por grupo */
+		Salida->Cadena(",\"grupos\":[");
+		for(i=0;i<DatosFS.DatosEspecificos.EXT.NroGrupos;i++)
+		    {
+			Salida->Cadena(i ? ",{" : "{");
+			Salida->Cadena("\"cluster_bitmap_inodes\":");
+			Salida->Decimal(DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterBitmapINodes, 0);
+			Numero("cluster_tabla_inodes", DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterTablaINodes);
+			Numero("cluster_bitmap_bloques", DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterBitmapBloques);
+			Numero("cluster_tabla_bloques", DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterTablaBloques);
+			Salida->Caracter('}');
+		    }
+		Salida->Caracter(']');
+		break;
+	case tfsNTFS:
+		Numero("offset_particion_sectores", (unsigned)DatosFS.DatosEspecificos.NTFS.OffsetParticionEnSectores);
+		Numero("nro_sectores", DatosFS.DatosEspecificos.NTFS.TotalSectores);
+		Numero("sectores_por_cluster", (unsigned)DatosFS.DatosEspecificos.NTFS.SectoresPorCluster);
+		Numero("bytes_por_file_record_segment", (unsigned)DatosFS.DatosEspecificos.NTFS.BytesPorFileRecordSegment);
+		Numero("bytes_por_index_buffer", (unsigned)DatosFS.DatosEspecificos.NTFS.BytesPorIndexBuffer);
+		Numero("cluster_mft", DatosFS.DatosEspecificos.NTFS.ClusterMFT);
+		Numero("cluster_mft_mirror", DatosFS.DatosEspecificos.NTFS.ClusterMFTMirror);
+		break;
+    }
+Salida->Cadena("}\n");
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TEmisorJSONL :: Entrada							*
+ *																	*
+ * OBJETIVO: Esta función emite una entrada de directorio.										*
+ *																	*
+ * ENTRADA: Directorio: Ruta al directorio que la contiene.										*
+ *	    Tipo: Tipo de filesystem (determina qué datos específicos tiene la entrada).						*
+ *	    Entrada: Entrada a emitir.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Las fechas van en segundos desde 1970 (UTC), o null si la entrada no la tiene.					*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorJSONL::Entrada(const char *Directorio, TipoFilsystem Tipo, const TEntradaDirectorio &Entrada)
+{
+char		Flags[sizeof(LetrasFlags)/sizeof(LetrasFlags[0])];
+unsigned	i, n;
+
+/* Armar las letras de los flags prendidos */
+for(i=n=0;i<sizeof(LetrasFlags)/sizeof(LetrasFlags[0]);i++)
+	if (Entrada.Flags & LetrasFlags[i].Flag)
+		Flags[n++]=LetrasFlags[i].Letra;
+
+/* Campos comunes */
+Salida->Cadena("{\"tipo\":\"entrada\"");
+Texto("directorio", Directorio, strlen(Directorio));
+Texto("nombre", Entrada.Nombre.data(), Entrada.Nombre.size());
+Texto("flags", Flags, n);
+Numero("bytes", Entrada.Bytes);
+Fecha("creacion", Entrada.FechaCreacion);
+Fecha("acceso", Entrada.FechaUltimoAcceso);
+Fecha("modificacion", Entrada.FechaUltimaModificacion);
+
+/* Campos propios de cada filesystem */
+switch (Tipo)
+    {
+	case tfsFAT12:
+	case tfsFAT16:
+	case tfsFAT32:
+		Numero("primer_cluster", Entrada.DatosEspecificos.FAT.PrimerCluster);
+		break;
+	case tfsEXT2:
+	case tfsEXT3:
+	case tfsEXT4:
+		Numero("inode", Entrada.DatosEspecificos.EXT.INode);
+		break;
+	case tfsNTFS:
+		Numero("indice_mft", Entrada.DatosEspecificos.NTFS.IndiceMFT);
+		Numero("nro_secuencia", Entrada.DatosEspecificos.NTFS.NroSecuencia);
+		break;
+    }
+Salida->Cadena("}\n");
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TEmisorJSONL :: Archivo							*
+ *																	*
+ * OBJETIVO: Esta función emite el registro que abre el contenido de un archivo, con su tamaño. Lo siguen los de datos.			*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo.													*
+ *	    Longitud: Cantidad de bytes del archivo.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorJSONL::Archivo(const char *Path, __u64 Longitud)
+{
+Salida->Cadena("{\"tipo\":\"archivo\"");
+Texto("ruta", Path, strlen(Path));
+Numero("bytes", Longitud);
+Salida->Cadena("}\n");
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							  TEmisorJSONL :: Datos								*
+ *																	*
+ * OBJETIVO: Esta función emite un tramo del contenido de un archivo.									*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo.													*
+ *	    Offset: Posición del tramo dentro del archivo.										*
+ *	    Datos: Bytes del tramo.													*
+ *	    Longitud: Cantidad de bytes del tramo.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Va un registro cada EMISOR_TAM_BLOQUE bytes, para que ninguna línea sea desmesurada y el consumidor pueda procesar	*
+ *		  el archivo por partes.												*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorJSONL::Datos(const char *Path, __u64 Offset, const unsigned char *Datos, __u64 Longitud)
+{
+size_t	LongitudPath = strlen(Path);
+__u64	i;
+
+for(i=0;i<Longitud;i+=EMISOR_TAM_BLOQUE)
+    {
+	Salida->Cadena("{\"tipo\":\"datos\"");
+	Texto("ruta", Path, LongitudPath);
+	Numero("offset", Offset+i);
+	Salida->Cadena(",\"base64\":\"");
+	Base64(Datos+i, (unsigned)min((__u64)EMISOR_TAM_BLOQUE, Longitud-i));
+	Salida->Cadena("\"}\n");
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TEmisorJSONL :: Extent								*
+ *																	*
+ * OBJETIVO: Esta función emite un tramo del mapa de un archivo a la imágen.								*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo.													*
+ *	    Extent: Tramo a emitir.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: En los huecos el offset en la imágen va en null.									*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorJSONL::Extent(const char *Path, const TExtentArchivo &Extent)
+{
+Salida->Cadena("{\"tipo\":\"extent\"");
+Texto("ruta", Path, strlen(Path));
+Numero("offset", Extent.OffsetArchivo);
+if (Extent.Hueco)
+	Salida->Cadena(",\"offset_imagen\":null");
+else
+	Numero("offset_imagen", Extent.OffsetImagen);
+Numero("bytes", Extent.Longitud);
+Salida->Cadena(Extent.Hueco ? ",\"hueco\":true}\n" : ",\"hueco\":false}\n");
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TEmisorJSONL :: Totales							*
+ *																	*
+ * OBJETIVO: Esta función emite los totales de un directorio recorrido recursivamente.							*
+ *																	*
+ * ENTRADA: Path: Ruta al directorio.													*
+ *	    Totales: Bytes y cantidad de archivos, subdirectorios y nombres repetidos de todo su subárbol.				*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorJSONL::Totales(const char *Path, const TTotalesArbol &Totales)
+{
+Salida->Cadena("{\"tipo\":\"totales\"");
+Texto("ruta", Path, strlen(Path));
+Numero("bytes", Totales.Bytes);
+Numero("archivos", Totales.Archivos);
+Numero("directorios", Totales.Directorios);
+Numero("repetidos", Totales.Repetidos);
+Salida->Cadena("}\n");
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							  TEmisorJSONL :: Error								*
+ *																	*
+ * OBJETIVO: Esta función emite el resultado de un comando que no se pudo completar (por ejemplo un directorio que no existe).		*
+ *																	*
+ * ENTRADA: Path: Ruta sobre la que se ejecutó el comando.										*
+ *	    CodError: Código de error.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorJSONL::Error(const char *Path, int CodError)
+{
+Salida->Cadena("{\"tipo\":\"error\"");
+Texto("ruta", Path, strlen(Path));
+Salida->Printf(",\"codigo\":%d}\n", CodError);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							   TEmisorJSONL :: Fin								*
+ *																	*
+ * OBJETIVO: Esta función emite el registro que cierra el informe de una imágen.							*
+ *																	*
+ * ENTRADA: CodError: Resultado del análisis de la imágen.										*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorJSONL::Fin(int CodError)
+{
+Salida->Printf("{\"tipo\":\"fin\",\"resultado\":%d}\n", CodError);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							  TEmisorJSONL :: Texto								*
+ *																	*
+ * OBJETIVO: Esta función agrega al objeto un campo de texto, escapando lo que JSON no permite dentro de una cadena.			*
+ *																	*
+ * ENTRADA: Clave: Nombre del campo.													*
+ *	    Valor: Texto del campo (no necesita terminar en '\0').									*
+ *	    Longitud: Cantidad de bytes del texto.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Los bytes de 0x80 en adelante se copian tal cual, suponiendo que los nombres vienen en UTF-8.				*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorJSONL::Texto(const char *Clave, const char *Valor, size_t Longitud)
+{
+unsigned char	c;
+size_t		i;
+char		*Inicio, *p;
+
+/* Clave */
+Salida->Cadena(",\"");
+Salida->Cadena(Clave);
+Salida->Cadena("\":\"");
+
+/* Valor, en el peor caso cada byte ocupa 6 ("\u00XX") */
+if ( (Inicio=p=Salida->Reservar(6*Longitud+1)) == NULL )
+	return;
+for(i=0;i<Longitud;i++)
+    {
+	c=(unsigned char)Valor[i];
+	if ( (c=='"') || (c=='\\') )
+	    {
+		*p++='\\';
+		*p++=c;
+	    }
+	else if (c<0x20)
+	    {
+		memcpy(p, "\\u00", 4);
+		p[4]=DigitosHexa[c>>4];
+		p[5]=DigitosHexa[c&0xF];
+		p+=6;
+	    }
+	else
+		*p++=c;
+    }
+*p++='"';
+Salida->Avanzar(p-Inicio);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TEmisorJSONL :: Numero								*
+ *																	*
+ * OBJETIVO: Esta función agrega al objeto un campo numérico.										*
+ *																	*
+ * ENTRADA: Clave: Nombre del campo.													*
+ *	    Valor: Valor del campo.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorJSONL::Numero(const char *Clave, __u64 Valor)
+{
+Salida->Cadena(",\"");
+Salida->Cadena(Clave);
+Salida->Cadena("\":");
+Salida->Decimal(Valor, 0);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							  TEmisorJSONL :: Fecha								*
+ *																	*
+ * OBJETIVO: Esta función agrega al objeto un campo con una fecha.									*
+ *																	*
+ * ENTRADA: Clave: Nombre del campo.													*
+ *	    Valor: Fecha, en segundos desde 1970 (0 si la entrada no la tiene).								*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorJSONL::Fecha(const char *Clave, time_t Valor)
+{
+Salida->Cadena(",\"");
+Salida->Cadena(Clave);
+Salida->Cadena("\":");
+if (!Valor)
+	Salida->Cadena("null");
+else if (Valor<0)
+	Salida->Printf("%lld", (long long)Valor);
+else
+	Salida->Decimal((__u64)Valor, 0);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TEmisorJSONL :: Base64								*
+ *																	*
+ * OBJETIVO: Esta función agrega un bloque de bytes codificado en base64 (RFC 4648, con relleno '=').					*
+ *																	*
+ * ENTRADA: Datos: Bytes a codificar.													*
+ *	    Longitud: Cantidad de bytes.												*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorJSONL::Base64(const unsigned char *Datos, unsigned Longitud)
+{
+unsigned	i, v;
+char		*p;
+
+/* Reservar lugar para todo el bloque y codificar de a 3 bytes */
+if ( (p=Salida->Reservar((Longitud+2)/3*4)) == NULL )
+	return;
+for(i=0;i+3<=Longitud;i+=3)
+    {
+	v=(Datos[i]<<16) | (Datos[i+1]<<8) | Datos[i+2];
+	*p++=DigitosBase64[(v>>18)&0x3F];
+	*p++=DigitosBase64[(v>>12)&0x3F];
+	*p++=DigitosBase64[(v>> 6)&0x3F];
+	*p++=DigitosBase64[ v     &0x3F];
+    }
+
+/* Los 1 o 2 bytes finales llevan relleno */
+if (i<Longitud)
+    {
+	v=Datos[i]<<16;
+	if (i+1<Longitud)
+		v|=Datos[i+1]<<8;
+	*p++=DigitosBase64[(v>>18)&0x3F];
+	*p++=DigitosBase64[(v>>12)&0x3F];
+	*p++=(i+1<Longitud) ? DigitosBase64[(v>>6)&0x3F] : '=';
+	*p++='=';
+    }
+Salida->Avanzar((Longitud+2)/3*4);
+}
+
+
+/********************************
+ *				*
+ *    Clase TEmisorBinario	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *						    TEmisorBinario :: TEmisorBinario							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Salida: Buffer de salida en el que se escriben los registros.								*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TEmisorBinario::TEmisorBinario(TSalida *Salida) : TEmisorRegistros(Salida)
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TEmisorBinario :: ~TEmisorBinario							*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TEmisorBinario::~TEmisorBinario()
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TEmisorBinario :: Imagen							*
+ *																	*
+ * OBJETIVO: Esta función emite el registro que abre el informe de una imágen: la ruta.							*
+ *																	*
+ * ENTRADA: Ruta: Ruta a la imágen.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorBinario::Imagen(const char *Ruta)
+{
+Cadena(Ruta, strlen(Ruta));
+Cerrar(regIMAGEN, NULL, 0);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TEmisorBinario :: Superbloque							*
+ *																	*
+ * OBJETIVO: Esta función emite los datos del superbloque.										*
+ *																	*
+ * ENTRADA: DatosFS: Datos levantados por el driver.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Tipo de filesystem (1), bytes/sector (4), bytes/cluster (4) y nro de clusters (8), seguidos de los campos propios	*
+ *		  del filesystem en el mismo orden que en el listado de texto. En EXT, por cada grupo, sus 4 clusters de 8 bytes.	*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorBinario::Superbloque(const TDatosFS &DatosFS)
+{
+int	i;
+
+/* Valores comunes a todos los filesystems */
+Entero(DatosFS.TipoFilesystem, 1);
+Entero(DatosFS.BytesPorSector, 4);
+Entero(DatosFS.BytesPorCluster, 4);
+Entero(DatosFS.NumeroDeClusters, 8);
+
+/* Valores propios de cada filesystem */
+switch (DatosFS.TipoFilesystem)
+    {
+	case tfsFAT12:
+	case tfsFAT16:
+	case tfsFAT32:
+		Entero(DatosFS.DatosEspecificos.FAT.TotalSectores, 4);
+		Entero(DatosFS.DatosEspecificos.FAT.SectoresOcultos, 4);
+		Entero(DatosFS.DatosEspecificos.FAT.SectoresReservados, 4);
+		Entero(DatosFS.DatosEspecificos.FAT.CopiasFAT, 4);
+		Entero(DatosFS.DatosEspecificos.FAT.EntradasRootDir, 4);
+		Entero(DatosFS.DatosEspecificos.FAT.SectoresPorCluster, 4);
+		Entero(DatosFS.DatosEspecificos.FAT.SectoresPorFAT, 4);
+		Entero(DatosFS.DatosEspecificos.FAT.ClustersRootDir, 4);
+		Entero(DatosFS.DatosEspecificos.FAT.PrimerClusterRootDir, 4);
+		break;
+	case tfsEXT2:
+	case tfsEXT3:
+	case tfsEXT4:
+		Entero(DatosFS.DatosEspecificos.EXT.CaracteristicasCompatibles, 4);
+		Entero(DatosFS.DatosEspecificos.EXT.CaracteristicasIncompatibles, 4);
+		Entero(DatosFS.DatosEspecificos.EXT.CaracteristicasSoloLectura, 4);
+		Entero(DatosFS.DatosEspecificos.EXT.ClustersPorGrupo, 4);
+		Entero(DatosFS.DatosEspecificos.EXT.INodesPorGrupo, 4);
+		Entero(DatosFS.DatosEspecificos.EXT.BytesPorINode, 4);
+		Entero(DatosFS.DatosEspecificos.EXT.NumeroDeINodes, 4);
+		Entero(DatosFS.DatosEspecificos.EXT.NroGrupos, 4);
+		Entero(DatosFS.DatosEspecificos.EXT.PeriodoAgrupadoFlex, 4);
+		Entero(DatosFS.DatosEspecificos.EXT.ClustersReservadosGDT, 4);
+		for(i=0;i<DatosFS.DatosEspecificos.EXT.NroGrupos;i++)
+		    {
+			Entero(DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterBitmapINodes, 8);
+			Entero(DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterTablaINodes, 8);
+			Entero(DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterBitmapBloques, 8);
+			Entero(DatosFS.DatosEspecificos.EXT.DatosGrupo[i].ClusterTablaBloques, 8);
+		    }
+		break;
+	case tfsNTFS:
+		Entero(DatosFS.DatosEspecificos.NTFS.OffsetParticionEnSectores, 4);
+		Entero(DatosFS.DatosEspecificos.NTFS.TotalSectores, 8);
+		Entero(DatosFS.DatosEspecificos.NTFS.SectoresPorCluster, 4);
+		Entero(DatosFS.DatosEspecificos.NTFS.BytesPorFileRecordSegment, 4);
+		Entero(DatosFS.DatosEspecificos.NTFS.BytesPorIndexBuffer, 4);
+		Entero(DatosFS.DatosEspecificos.NTFS.ClusterMFT, 8);
+		Entero(DatosFS.DatosEspecificos.NTFS.ClusterMFTMirror, 8);
+		break;
+    }
+Cerrar(regSUPERBLOQUE, NULL, 0);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TEmisorBinario :: Entrada							*
+ *																	*
+ * OBJETIVO: Esta función emite una entrada de directorio.										*
+ *																	*
+ * ENTRADA: Directorio: Ruta al directorio que la contiene.										*
+ *	    Tipo: Tipo de filesystem (determina qué datos específicos tiene la entrada).						*
+ *	    Entrada: Entrada a emitir.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Directorio y nombre (cadenas), flags (4), tamaño (8), las tres fechas (8 cada una, 0 si no la tiene) y los datos	*
+ *		  propios del filesystem: 1er cluster (4) en FAT, inode (4) en EXT, índice MFT (8) y nro de secuencia (2) en NTFS.	*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorBinario::Entrada(const char *Directorio, TipoFilsystem Tipo, const TEntradaDirectorio &Entrada)
+{
+/* Campos comunes */
+Cadena(Directorio, strlen(Directorio));
+Cadena(Entrada.Nombre.data(), Entrada.Nombre.size());
+Entero(Entrada.Flags, 4);
+Entero(Entrada.Bytes, 8);
+Entero(Entrada.FechaCreacion, 8);
+Entero(Entrada.FechaUltimoAcceso, 8);
+Entero(Entrada.FechaUltimaModificacion, 8);
+
+/* Campos propios de cada filesystem */
+switch (Tipo)
+    {
+	case tfsFAT12:
+	case tfsFAT16:
+	case tfsFAT32:
+		Entero(Entrada.DatosEspecificos.FAT.PrimerCluster, 4);
+		break;
+	case tfsEXT2:
+	case tfsEXT3:
+	case tfsEXT4:
+		Entero(Entrada.DatosEspecificos.EXT.INode, 4);
+		break;
+	case tfsNTFS:
+		Entero(Entrada.DatosEspecificos.NTFS.IndiceMFT, 8);
+		Entero(Entrada.DatosEspecificos.NTFS.NroSecuencia, 2);
+		break;
+    }
+Cerrar(regENTRADA, NULL, 0);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TEmisorBinario :: Archivo							*
+ *																	*
+ * OBJETIVO: Esta función emite el registro que abre el contenido de un archivo: la ruta y el tamaño (8). Lo siguen los de datos.	*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo.													*
+ *	    Longitud: Cantidad de bytes del archivo.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorBinario::Archivo(const char *Path, __u64 Longitud)
+{
+Cadena(Path, strlen(Path));
+Entero(Longitud, 8);
+Cerrar(regARCHIVO, NULL, 0);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TEmisorBinario :: Datos							*
+ *																	*
+ * OBJETIVO: Esta función emite un tramo del contenido de un archivo.									*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo.													*
+ *	    Offset: Posición del tramo dentro del archivo.										*
+ *	    Datos: Bytes del tramo.													*
+ *	    Longitud: Cantidad de bytes del tramo.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Va un registro cada EMISOR_TAM_BLOQUE bytes con el offset (8) seguido de los bytes tal cual, que se copian directo	*
+ *		  al buffer de salida.													*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorBinario::Datos(const char *Path, __u64 Offset, const unsigned char *Datos, __u64 Longitud)
+{
+__u64	i;
+
+for(i=0;i<Longitud;i+=EMISOR_TAM_BLOQUE)
+    {
+	Entero(Offset+i, 8);
+	Cerrar(regDATOS, Datos+i, (unsigned)min((__u64)EMISOR_TAM_BLOQUE, Longitud-i));
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TEmisorBinario :: Extent							*
+ *																	*
+ * OBJETIVO: Esta función emite un tramo del mapa de un archivo a la imágen.								*
+ *																	*
+ * ENTRADA: Path: Ruta al archivo.													*
+ *	    Extent: Tramo a emitir.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Ruta (cadena), offset en el archivo (8), offset en la imágen (8, 0 en los huecos), longitud (8) y si es un hueco (1).	*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorBinario::Extent(const char *Path, const TExtentArchivo &Extent)
+{
+Cadena(Path, strlen(Path));
+Entero(Extent.OffsetArchivo, 8);
+Entero(Extent.OffsetImagen, 8);
+Entero(Extent.Longitud, 8);
+Entero(Extent.Hueco, 1);
+Cerrar(regEXTENT, NULL, 0);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TEmisorBinario :: Totales							*
+ *																	*
+ * OBJETIVO: Esta función emite los totales de un directorio recorrido recursivamente.							*
+ *																	*
+ * ENTRADA: Path: Ruta al directorio.													*
+ *	    Totales: Bytes y cantidad de archivos, subdirectorios y nombres repetidos de todo su subárbol.				*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Ruta (cadena), bytes (8), archivos (8), directorios (8) y repetidos (8).						*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorBinario::Totales(const char *Path, const TTotalesArbol &Totales)
+{
+Cadena(Path, strlen(Path));
+Entero(Totales.Bytes, 8);
+Entero(Totales.Archivos, 8);
+Entero(Totales.Directorios, 8);
+Entero(Totales.Repetidos, 8);
+Cerrar(regTOTALES, NULL, 0);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TEmisorBinario :: Error							*
+ *																	*
+ * OBJETIVO: Esta función emite el resultado de un comando que no se pudo completar: la ruta y el código de error (4).			*
+ *																	*
+ * ENTRADA: Path: Ruta sobre la que se ejecutó el comando.										*
+ *	    CodError: Código de error.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorBinario::Error(const char *Path, int CodError)
+{
+Cadena(Path, strlen(Path));
+Entero(CodError, 4);
+Cerrar(regERROR, NULL, 0);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							  TEmisorBinario :: Fin								*
+ *																	*
+ * OBJETIVO: Esta función emite el registro que cierra el informe de una imágen: el resultado (4).					*
+ *																	*
+ * ENTRADA: CodError: Resultado del análisis de la imágen.										*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorBinario::Fin(int CodError)
+{
+Entero(CodError, 4);
+Cerrar(regFIN, NULL, 0);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TEmisorBinario :: Entero							*
+ *																	*
+ * OBJETIVO: Esta función agrega al registro en armado un entero en little endian.							*
+ *																	*
+ * ENTRADA: Valor: Valor a agregar (los negativos en complemento a 2).									*
+ *	    Bytes: Cantidad de bytes que ocupa (1, 2, 4 u 8).										*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorBinario::Entero(__u64 Valor, unsigned Bytes)
+{
+unsigned	i;
+
+for(i=0;i<Bytes;i++)
+	Registro+=(char)(Valor>>(8*i));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TEmisorBinario :: Cadena							*
+ *																	*
+ * OBJETIVO: Esta función agrega al registro en armado una cadena: su longitud (2) seguida de los bytes, sin '\0'.			*
+ *																	*
+ * ENTRADA: Valor: Texto a agregar.													*
+ *	    Longitud: Cantidad de bytes del texto (se trunca a 65535).									*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorBinario::Cadena(const char *Valor, size_t Longitud)
+{
+Longitud=min(Longitud, (size_t)0xFFFF);
+Entero(Longitud, 2);
+Registro.append(Valor, Longitud);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TEmisorBinario :: Cerrar							*
+ *																	*
+ * OBJETIVO: Esta función escribe en la salida el registro armado, con su tipo y longitud, y deja vacío el de armado.			*
+ *																	*
+ * ENTRADA: Tipo: Tipo de registro (regXXX).												*
+ *	    Cola: Bytes a agregar al final del registro tal cual, sin pasar por el de armado (NULL si no hay).				*
+ *	    LongitudCola: Cantidad de bytes de la cola.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TEmisorBinario::Cerrar(unsigned char Tipo, const unsigned char *Cola, unsigned LongitudCola)
+{
+unsigned	Longitud = Registro.size()+LongitudCola;
+char		Encabezado[5];
+
+/* Tipo y longitud del resto */
+Encabezado[0]=Tipo;
+Encabezado[1]=(char)(Longitud);
+Encabezado[2]=(char)(Longitud>>8);
+Encabezado[3]=(char)(Longitud>>16);
+Encabezado[4]=(char)(Longitud>>24);
+Salida->Bytes(Encabezado, sizeof(Encabezado));
+
+/* Campos y cola */
+Salida->Bytes(Registro.data(), Registro.size());
+if (LongitudCola)
+	Salida->Bytes(Cola, LongitudCola);
+Registro.clear();
+}
\ No newline at end of file
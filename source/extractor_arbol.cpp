@@ -0,0 +1,426 @@
+﻿#include "all_heads.h"
+
+
+/************************
+ *			*
+ *     Funciones	*
+ *			*
+ ************************/
+/* Llamadas al sistema para crear directorios y fijar fechas (sus envoltorios de la libc están en sys/stat.h, que choca con driver_ext.h) */
+static int sys_mkdirat(const char *Ruta, unsigned Modo)
+{
+return((int)syscall(__NR_mkdirat, EXTRACCION_AT_FDCWD, Ruta, Modo));
+}
+
+static int sys_utimensat(const char *Ruta, const struct timespec *Fechas)
+{
+return((int)syscall(__NR_utimensat, EXTRACCION_AT_FDCWD, Ruta, Fechas, 0));
+}
+
+
+/********************************
+ *				*
+ *   Clase TExtractorArbol	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *						   TExtractorArbol :: TExtractorArbol							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Driver: Driver con la imágen a extraer (sigue siendo propiedad del llamador).						*
+ *	    NroHilos: Cantidad de hilos a usar (0 usa uno por núcleo).									*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Si la fuente de la imágen no admite lecturas concurrentes se copia de a un archivo.					*
+ *																	*
+ ****************************************************************************************************************************************/
+TExtractorArbol::TExtractorArbol(TDriverBase *Driver, unsigned NroHilos)
+{
+/* Inicializar variables */
+TExtractorArbol::Driver=Driver;
+TExtractorArbol::NroHilos=NroHilos;
+
+/* Determinar la cantidad de hilos */
+if (TExtractorArbol::NroHilos==0)
+	TExtractorArbol::NroHilos=std::thread::hardware_concurrency();
+if ( (TExtractorArbol::NroHilos==0) || (!Driver->AdmiteHilos()) )
+	TExtractorArbol::NroHilos=1;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TExtractorArbol :: ~TExtractorArbol							*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TExtractorArbol::~TExtractorArbol()
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TExtractorArbol :: Extraer							*
+ *																	*
+ * OBJETIVO: Esta función copia recursivamente un directorio de la imágen a un directorio del host.					*
+ *																	*
+ * ENTRADA: Ruta: Ruta al directorio de la imágen.											*
+ *	    Destino: Directorio del host donde queda su contenido (se crea si no existe).						*
+ *																	*
+ * SALIDA: En el nombre de la función el código de error.										*
+ *	   Totales: Bytes, archivos y directorios del árbol.										*
+ *																	*
+ * OBSERVACIONES: Primero se recorre el árbol (en paralelo), después se crean los directorios y por último se copian los archivos,	*
+ *		  varios a la vez. Los nombres repetidos de un archivo quedan como hard links a su copia y cada archivo y directorio	*
+ *		  conserva sus fechas de acceso y modificación. Las etiquetas de volumen y los accesos directos (links simbólicos y	*
+ *		  otros archivos especiales) no se copian. Un archivo que no se puede copiar no corta la extracción: queda en Fallos()	*
+ *		  y se sigue con el resto.												*
+ *																	*
+ ****************************************************************************************************************************************/
+int TExtractorArbol::Extraer(const char *Ruta, const char *Destino, TTotalesArbol &Totales)
+{
+TRecorredorArbol	Recorredor(Driver, NroHilos);
+TManejadorArchivo	Manejador;
+std::string		Base, Relativa, RutaDirectorio;
+size_t			LongitudRaiz;
+unsigned		i;
+int			CodError;
+
+/* Inicializar (el lote conserva su memoria de la extracción anterior) */
+Elementos.Vaciar();
+Repetidas.clear();
+Copiados.clear();
+ListaFallos.clear();
+
+/* Normalizar las rutas como lo hace el recorredor (sin '/' al final, salvo la raíz) */
+Raiz.assign(Ruta);
+while ( (Raiz.size()>1) && (Raiz[Raiz.size()-1]=='/') )
+	Raiz.erase(Raiz.size()-1);
+LongitudRaiz=(Raiz.size()>1) ? Raiz.size() : 0;
+Base.assign(Destino);
+while ( (Base.size()>1) && (Base[Base.size()-1]=='/') )
+	Base.erase(Base.size()-1);
+
+/* Juntar todo el árbol (un directorio puede llegar antes que su padre, por eso se crean recién al final) */
+Recorredor.UsarVisitante([&](const char *Directorio, const TEntradaDirectorio &Entrada, bool Repetida)
+    {
+	/* Sólo se copia contenido, y un directorio repetido es un ciclo */
+	if (Entrada.Flags&(fedETIQUETA_VOLUMEN | fedACCESO_DIRECTO))
+		return(true);
+	if ( (Repetida) && (Entrada.Flags&fedDIRECTORIO) )
+		return(true);
+
+	/* Ruta relativa a la raíz extraída, siempre empezando con '/' (sólo la raíz de la imágen queda como "/") */
+	Relativa.assign(Directorio+LongitudRaiz);
+	if (Relativa.size()!=1)
+		Relativa+='/';
+	Relativa+=Entrada.Nombre;
+
+	/* Un nombre vacío, ".", ".." o con '/' (imágen dañada o armada a propósito) sacaría la copia fuera del destino, se omite */
+	if (!TRecorredorArbol::NombreValido(Entrada.Nombre))
+	    {
+		AgregarFallo(Relativa, CODERROR_FILESYSTEM_CORRUPTO);
+		return(true);
+	    }
+
+	/* Recordar cuál es la copia de cada archivo, para enlazarle sus otros nombres */
+	if ( (!Repetida) && (!(Entrada.Flags&fedDIRECTORIO)) )
+	    {
+		Driver->ManejadorEntrada(Entrada, Manejador);
+		Copiados[Driver->Identificador(Manejador)]=Elementos.Cantidad();
+	    }
+
+	/* Guardarla en el lote, con la ruta relativa como nombre */
+	Elementos.Agregar(Entrada, Relativa.c_str(), (unsigned)Relativa.size());
+	Repetidas.push_back(Repetida);
+	return(true);
+    });
+if ( (CodError=Recorredor.Recorrer(Ruta, Totales)) != CODERROR_NINGUNO )
+	return(CodError);
+
+/* Crear la raíz y los directorios */
+if ( (CodError=CrearDirectorios(Base.c_str())) != CODERROR_NINGUNO )
+	return(CodError);
+
+/* Copiar los archivos, varios a la vez */
+ErroresCopia.assign(Elementos.Cantidad(), CODERROR_NINGUNO);
+    {
+	TPoolHilos Pool(NroHilos);
+	Pool.Ejecutar(Elementos.Cantidad(), [&](unsigned Indice)
+	    {
+		if ( (!Repetidas[Indice]) && (!(Elementos.Flags(Indice)&fedDIRECTORIO)) )
+			CopiarArchivo(Base.c_str(), Indice);
+	    });
+    }
+
+/* Enlazar los otros nombres de cada archivo */
+EnlazarRepetidos(Base.c_str());
+
+/* Las fechas de los directorios van al final, crear algo adentro las cambia */
+for (i=0; i<Elementos.Cantidad(); i++)
+	if (Elementos.Flags(i)&fedDIRECTORIO)
+	    {
+		RutaHost(Base.c_str(), i, RutaDirectorio);
+		FijarFechas(RutaDirectorio.c_str(), i);
+	    }
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TExtractorArbol :: CrearDirectorios							*
+ *																	*
+ * OBJETIVO: Esta función crea en el host el directorio destino y todos los directorios del árbol.					*
+ *																	*
+ * ENTRADA: Destino: Directorio del host donde va el árbol.										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Se crean ordenados por ruta, así cada padre (que es prefijo de sus hijos) se crea antes. Los que ya existen se	*
+ *		  reutilizan.														*
+ *																	*
+ ****************************************************************************************************************************************/
+int TExtractorArbol::CrearDirectorios(const char *Destino)
+{
+std::vector<unsigned>	Directorios;
+std::string		Ruta;
+unsigned		i;
+
+/* Crear la raíz */
+if ( (sys_mkdirat(Destino, EXTRACCION_MODO_DIRECTORIO) != 0) && (errno!=EEXIST) )
+	return(CODERROR_ESCRITURA_DISCO);
+
+/* Ordenar los directorios por ruta */
+for (i=0; i<Elementos.Cantidad(); i++)
+	if (Elementos.Flags(i)&fedDIRECTORIO)
+		Directorios.push_back(i);
+std::sort(Directorios.begin(), Directorios.end(), [this](unsigned a, unsigned b) { return(strcmp(Elementos.Nombre(a), Elementos.Nombre(b))<0); });
+
+/* Crearlos */
+for (i=0; i<Directorios.size(); i++)
+    {
+	RutaHost(Destino, Directorios[i], Ruta);
+	if ( (sys_mkdirat(Ruta.c_str(), EXTRACCION_MODO_DIRECTORIO) != 0) && (errno!=EEXIST) )
+		return(CODERROR_ESCRITURA_DISCO);
+    }
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TExtractorArbol :: CopiarArchivo							*
+ *																	*
+ * OBJETIVO: Esta función copia un archivo de la imágen al host y le pone sus fechas.							*
+ *																	*
+ * ENTRADA: Destino: Directorio del host donde va el árbol.										*
+ *	    Indice: Archivo a copiar (número de entrada en el lote).													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Se llama desde varios hilos a la vez. Si falla se borra la copia incompleta y el archivo queda en la lista de fallos,	*
+ *		  sin afectar a los demás.												*
+ *																	*
+ ****************************************************************************************************************************************/
+void TExtractorArbol::CopiarArchivo(const char *Destino, unsigned Indice)
+{
+TManejadorArchivo	Manejador;
+std::string		Ruta;
+FILE			*f;
+int			CodError;
+
+/* Escribir el archivo directamente desde la imágen */
+RutaHost(Destino, Indice, Ruta);
+Elementos.Manejador(Indice, Manejador);
+if ( (f=fopen(Ruta.c_str(), "wb")) == NULL )
+    {
+	AgregarFallo(Indice, CODERROR_ESCRITURA_DISCO);
+	return;
+    }
+CodError=Driver->ExportarArchivo(Manejador, f);
+if ( (fclose(f)!=0) && (CodError==CODERROR_NINGUNO) )
+	CodError=CODERROR_ESCRITURA_DISCO;
+
+/* Ponerle sus fechas, o borrar la copia incompleta y registrar el fallo */
+if (CodError==CODERROR_NINGUNO)
+	FijarFechas(Ruta.c_str(), Indice);
+else
+    {
+	unlink(Ruta.c_str());
+	AgregarFallo(Indice, CodError);
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TExtractorArbol :: EnlazarRepetidos							*
+ *																	*
+ * OBJETIVO: Esta función crea los otros nombres de los archivos ya copiados como hard links a la copia.				*
+ *																	*
+ * ENTRADA: Destino: Directorio del host donde va el árbol.										*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Los nombres que no se pueden enlazar, o cuya copia falló, quedan en la lista de fallos.				*
+ *																	*
+ ****************************************************************************************************************************************/
+void TExtractorArbol::EnlazarRepetidos(const char *Destino)
+{
+std::unordered_map<__u64, unsigned>::iterator	Copia;
+TManejadorArchivo				Manejador;
+std::string					Ruta, RutaOriginal;
+unsigned					i;
+
+for (i=0; i<Elementos.Cantidad(); i++)
+    {
+	if ( (!Repetidas[i]) || (Elementos.Flags(i)&fedDIRECTORIO) )
+		continue;
+
+	/* Buscar la copia de este archivo (si no se pudo copiar, este nombre tampoco se puede extraer) */
+	Elementos.Manejador(i, Manejador);
+	if ( (Copia=Copiados.find(Driver->Identificador(Manejador))) == Copiados.end() )
+		continue;
+	if (ErroresCopia[Copia->second]!=CODERROR_NINGUNO)
+	    {
+		AgregarFallo(i, ErroresCopia[Copia->second]);
+		continue;
+	    }
+	RutaHost(Destino, Copia->second, RutaOriginal);
+	RutaHost(Destino, i, Ruta);
+
+	/* Reemplazar lo que hubiera con ese nombre */
+	unlink(Ruta.c_str());
+	if (link(RutaOriginal.c_str(), Ruta.c_str()) != 0)
+		AgregarFallo(i, CODERROR_ESCRITURA_DISCO);
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TExtractorArbol :: FijarFechas							*
+ *																	*
+ * OBJETIVO: Esta función le pone a un archivo o directorio del host las fechas de acceso y modificación de la imágen.			*
+ *																	*
+ * ENTRADA: Ruta: Ruta en el host.													*
+ *	    Indice: Número de entrada en el lote.										*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: La fecha de creación no se puede fijar en el host. Si falla se deja la fecha actual, no es un error.			*
+ *																	*
+ ****************************************************************************************************************************************/
+void TExtractorArbol::FijarFechas(const char *Ruta, unsigned Indice)
+{
+struct timespec	Fechas[2];
+
+Fechas[0].tv_sec=Elementos.FechaUltimoAcceso(Indice);
+Fechas[0].tv_nsec=0;
+Fechas[1].tv_sec=Elementos.FechaUltimaModificacion(Indice);
+Fechas[1].tv_nsec=0;
+sys_utimensat(Ruta, Fechas);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TExtractorArbol :: RutaHost							*
+ *																	*
+ * OBJETIVO: Esta función arma la ruta del host para una entrada del árbol.								*
+ *																	*
+ * ENTRADA: Destino: Directorio del host donde va el árbol.										*
+ *	    Indice: Número de entrada en el lote.												*
+ *																	*
+ * SALIDA: Ruta: Ruta en el host.													*
+ *																	*
+ ****************************************************************************************************************************************/
+void TExtractorArbol::RutaHost(const char *Destino, unsigned Indice, std::string &Ruta)
+{
+Ruta.assign(Destino);
+if ( (Ruta.size()==1) && (Ruta[0]=='/') )
+	Ruta.clear();
+Ruta.append(Elementos.Nombre(Indice), Elementos.LongitudNombre(Indice));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TExtractorArbol :: AgregarFallo							*
+ *																	*
+ * OBJETIVO: Esta función registra una entrada del lote que no se pudo extraer.							*
+ *																	*
+ * ENTRADA: Indice: Número de entrada en el lote.											*
+ *	    CodError: Código del error.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Se llama desde varios hilos a la vez.											*
+ *																	*
+ ****************************************************************************************************************************************/
+void TExtractorArbol::AgregarFallo(unsigned Indice, int CodError)
+{
+/* Registrarla por su ruta y recordar que esta copia falló */
+AgregarFallo(std::string(Elementos.Nombre(Indice), Elementos.LongitudNombre(Indice)), CodError);
+std::lock_guard<std::mutex> Lock(Mutex);
+ErroresCopia[Indice]=CodError;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TExtractorArbol :: AgregarFallo							*
+ *																	*
+ * OBJETIVO: Esta función registra una entrada del árbol que no se pudo extraer, o que se omitió.					*
+ *																	*
+ * ENTRADA: Relativa: Ruta de la entrada relativa a la raíz extraída (empezando con '/').						*
+ *	    CodError: Código del error.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Se llama desde varios hilos a la vez.											*
+ *																	*
+ ****************************************************************************************************************************************/
+void TExtractorArbol::AgregarFallo(const std::string &Relativa, int CodError)
+{
+std::lock_guard<std::mutex>	Lock(Mutex);
+TFalloExtraccion		Fallo;
+
+/* La ruta en la imágen es la raíz extraída más la relativa (la raíz de la imágen no se antepone) */
+Fallo.Ruta.assign( (Raiz.size()>1) ? Raiz : std::string() );
+Fallo.Ruta.append(Relativa);
+Fallo.CodError=CodError;
+ListaFallos.push_back(Fallo);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TExtractorArbol :: Fallos							*
+ *																	*
+ * OBJETIVO: Esta función devuelve los archivos que no se pudieron extraer en la última extracción.					*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función la ruta en la imágen y el error de cada uno, ordenados por ruta.					*
+ *																	*
+ ****************************************************************************************************************************************/
+const std::vector<TFalloExtraccion> &TExtractorArbol::Fallos(void)
+{
+std::sort(ListaFallos.begin(), ListaFallos.end(), [](const TFalloExtraccion &a, const TFalloExtraccion &b) { return(a.Ruta<b.Ruta); });
+return(ListaFallos);
+}
\ No newline at end of file
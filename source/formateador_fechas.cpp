@@ -0,0 +1,214 @@
+﻿#include "all_heads.h"
+
+
+/************************
+ *			*
+ *     Funciones	*
+ *			*
+ ************************/
+/* División entera redondeando hacia -infinito (las fechas anteriores a 1970 son negativas) */
+static long long DividirHaciaAbajo(long long a, long long b)
+{
+return( (a>=0) ? (a/b) : -((-a+b-1)/b) );
+}
+
+
+/********************************
+ *				*
+ *  Clase TFormateadorFechas	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *						TFormateadorFechas :: TFormateadorFechas						*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada, con las dos caches vacías.								*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFormateadorFechas::TFormateadorFechas()
+{
+unsigned	i;
+
+/* Marcar todas las entradas como vacías (ninguna hora ni minuto válido cae en la posición de LLONG_MIN) */
+for(i=0;i<FECHAS_ENTRADAS_HORAS;i++)
+	Horas[i].Hora=LLONG_MIN;
+for(i=0;i<FECHAS_ENTRADAS_MINUTOS;i++)
+	Minutos[i].Minuto=LLONG_MIN;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						TFormateadorFechas :: ~TFormateadorFechas						*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFormateadorFechas::~TFormateadorFechas()
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TFormateadorFechas :: Formatear							*
+ *																	*
+ * OBJETIVO: Esta función arma el texto "dd/mm/aaaa hh:mm" de una fecha en hora local, igual al que arma localtime() + printf().	*
+ *																	*
+ * ENTRADA: Fecha: Fecha a convertir.													*
+ *	    Texto: Buffer de al menos FECHAS_LARGO_TEXTO caracteres (no se agrega el '\0').						*
+ *																	*
+ * SALIDA: En el nombre de la función true si se pudo armar, o false si el año no entra en 4 dígitos (o localtime_r() falla).		*
+ *																	*
+ * OBSERVACIONES: Las fechas repetidas dentro del mismo minuto sólo cuestan una búsqueda en la cache.					*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TFormateadorFechas::Formatear(time_t Fecha, char *Texto)
+{
+long		Desplazamiento;
+long long	Minuto;
+unsigned	i;
+
+/* Pasar a hora local */
+if (!ObtenerDesplazamiento(Fecha, Desplazamiento))
+	return(false);
+Minuto=DividirHaciaAbajo((long long)Fecha+Desplazamiento, 60);
+
+/* Buscar el minuto en la cache, y si no está armarlo */
+i=(unsigned)Minuto & (FECHAS_ENTRADAS_MINUTOS-1);
+if (Minutos[i].Minuto!=Minuto)
+    {
+	if (!ArmarTexto(Minuto, Minutos[i].Texto))
+		return(false);
+	Minutos[i].Minuto=Minuto;
+    }
+
+/* Devolverlo */
+memcpy(Texto, Minutos[i].Texto, FECHAS_LARGO_TEXTO);
+return(true);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *					       TFormateadorFechas :: ObtenerDesplazamiento						*
+ *																	*
+ * OBJETIVO: Esta función devuelve cuántos segundos hay que sumarle a una fecha UTC para tener la hora local.				*
+ *																	*
+ * ENTRADA: Fecha: Fecha en cuestión.													*
+ *																	*
+ * SALIDA: En el nombre de la función true si no hubo errores.										*
+ *	   Desplazamiento: Segundos a sumar.												*
+ *																	*
+ * OBSERVACIONES: Se guarda el desplazamiento de cada hora que tuvo el mismo valor al principio y al final. Las horas en las que	*
+ *		  cambia (horario de verano) se resuelven segundo a segundo con localtime_r().						*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TFormateadorFechas::ObtenerDesplazamiento(time_t Fecha, long &Desplazamiento)
+{
+THoraDesplazamiento	*Entrada;
+long long		Hora;
+time_t			Inicio, Fin;
+tm			Tiempo;
+
+/* Ver si ya tengo esa hora */
+Hora=DividirHaciaAbajo(Fecha, 3600);
+Entrada=&Horas[(unsigned)Hora & (FECHAS_ENTRADAS_HORAS-1)];
+if (Entrada->Hora!=Hora)
+    {
+	/* No, comparar el desplazamiento al principio y al final de la hora */
+	Inicio=(time_t)(Hora*3600);
+	Fin=Inicio+3599;
+	if (!localtime_r(&Inicio, &Tiempo))
+		return(false);
+	Entrada->Desplazamiento=Tiempo.tm_gmtoff;
+	if (!localtime_r(&Fin, &Tiempo))
+		return(false);
+	Entrada->Uniforme=(Entrada->Desplazamiento==Tiempo.tm_gmtoff);
+	Entrada->Hora=Hora;
+    }
+
+/* En una hora con cambio de desplazamiento, calcularlo para este segundo */
+if (!Entrada->Uniforme)
+    {
+	if (!localtime_r(&Fecha, &Tiempo))
+		return(false);
+	Desplazamiento=Tiempo.tm_gmtoff;
+	return(true);
+    }
+
+/* Devolver el de la cache */
+Desplazamiento=Entrada->Desplazamiento;
+return(true);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TFormateadorFechas :: ArmarTexto							*
+ *																	*
+ * OBJETIVO: Esta función arma el texto "dd/mm/aaaa hh:mm" de un minuto, contado desde el 01/01/1970 00:00 en hora local.		*
+ *																	*
+ * ENTRADA: Minuto: Minuto a convertir.													*
+ *	    Texto: Buffer de al menos FECHAS_LARGO_TEXTO caracteres.									*
+ *																	*
+ * SALIDA: En el nombre de la función true si se pudo armar, o false si el año no entra en 4 dígitos.					*
+ *																	*
+ * OBSERVACIONES: Pasa de días a año/mes/día con aritmética del calendario gregoriano (algoritmo "civil_from_days" de H. Hinnant).	*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TFormateadorFechas::ArmarTexto(long long Minuto, char *Texto)
+{
+long long	Dias, Era, Anio;
+unsigned	MinutoDelDia, DiaDeEra, AnioDeEra, DiaDelAnio, mp, Dia, Mes, Hora, Min;
+
+/* Separar días y minuto dentro del día */
+Dias=DividirHaciaAbajo(Minuto, 1440);
+MinutoDelDia=(unsigned)(Minuto-Dias*1440);
+Hora=MinutoDelDia/60;
+Min=MinutoDelDia%60;
+
+/* Días desde 1970 a fecha civil (eras de 400 años, años empezando en marzo) */
+Dias+=719468;
+Era=DividirHaciaAbajo(Dias, 146097);
+DiaDeEra=(unsigned)(Dias-Era*146097);
+AnioDeEra=(DiaDeEra-DiaDeEra/1460+DiaDeEra/36524-DiaDeEra/146096)/365;
+DiaDelAnio=DiaDeEra-(365*AnioDeEra+AnioDeEra/4-AnioDeEra/100);
+mp=(5*DiaDelAnio+2)/153;
+Dia=DiaDelAnio-(153*mp+2)/5+1;
+Mes=(mp<10) ? mp+3 : mp-9;
+Anio=(long long)AnioDeEra+Era*400+(Mes<=2);
+
+/* El campo tiene lugar para 4 dígitos de año */
+if ( (Anio<0) || (Anio>9999) )
+	return(false);
+
+/* Armar el texto */
+Texto[ 0]='0'+Dia/10;
+Texto[ 1]='0'+Dia%10;
+Texto[ 2]='/';
+Texto[ 3]='0'+Mes/10;
+Texto[ 4]='0'+Mes%10;
+Texto[ 5]='/';
+Texto[ 6]='0'+(unsigned)(Anio/1000);
+Texto[ 7]='0'+(unsigned)(Anio/100%10);
+Texto[ 8]='0'+(unsigned)(Anio/10%10);
+Texto[ 9]='0'+(unsigned)(Anio%10);
+Texto[10]=' ';
+Texto[11]='0'+Hora/10;
+Texto[12]='0'+Hora%10;
+Texto[13]=':';
+Texto[14]='0'+Min/10;
+Texto[15]='0'+Min%10;
+
+/* Salir indicando éxito */
+return(true);
+}
\ No newline at end of file
@@ -0,0 +1,344 @@
+﻿#include "all_heads.h"
+
+
+/************************
+ *			*
+ *     Funciones	*
+ *			*
+ ************************/
+/* Llamadas al sistema de io_uring (no hay envoltorio en la libc) */
+static int io_uring_setup(unsigned Entradas, TUringParametros *Parametros)
+{
+return((int)syscall(__NR_io_uring_setup, Entradas, Parametros));
+}
+
+static int io_uring_enter(int Fd, unsigned AEnviar, unsigned MinCompletos, unsigned Flags)
+{
+return((int)syscall(__NR_io_uring_enter, Fd, AEnviar, MinCompletos, Flags, NULL, 0));
+}
+
+
+/********************************************
+ *					    *
+ *  Clase TFuenteSectoresAsincronica	    *
+ *					    *
+ ********************************************/
+/****************************************************************************************************************************************
+ *																	*
+ *					TFuenteSectoresAsincronica :: TFuenteSectoresAsincronica					*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada, preparando io_uring o, si el kernel no lo ofrece, un pool de hilos para pread().	*
+ *																	*
+ * ENTRADA: f: Archivo abierto con la imágen (pasa a ser propiedad de esta clase).							*
+ *	    Longitud: Tamaño, en bytes, de la imágen.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteSectoresAsincronica::TFuenteSectoresAsincronica(FILE *f, __u64 Longitud) : TFuenteSectoresArchivo(f, Longitud)
+{
+/* Inicializar variables */
+FdUring=-1;
+Entradas=0;
+MapeoSQ=MAP_FAILED;
+LongitudMapeoSQ=0;
+MapeoCQ=MAP_FAILED;
+LongitudMapeoCQ=0;
+SQEs=(TUringSQE *)MAP_FAILED;
+LongitudSQEs=0;
+Pool=NULL;
+
+/* Si no hay io_uring (kernel viejo, seccomp, etc.) usar hilos con pread() */
+if (IniciarUring()!=CODERROR_NINGUNO)
+    {
+	FinalizarUring();
+	Pool=new TPoolHilos(ASINC_HILOS_PREAD);
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *					TFuenteSectoresAsincronica :: ~TFuenteSectoresAsincronica					*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteSectoresAsincronica::~TFuenteSectoresAsincronica()
+{
+/* Cerrar io_uring */
+FinalizarUring();
+
+/* Terminar el pool */
+if (Pool)
+    {
+	delete Pool;
+	Pool=NULL;
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *					       TFuenteSectoresAsincronica :: IniciarUring						*
+ *																	*
+ * OBJETIVO: Esta función crea la instancia de io_uring y mapea sus anillos de envíos y resultados.					*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TFuenteSectoresAsincronica::IniciarUring(void)
+{
+TUringParametros	Parametros;
+
+/* Crear la instancia */
+memset(&Parametros, 0, sizeof(Parametros));
+if ( (FdUring=io_uring_setup(URING_ENTRADAS, &Parametros)) < 0 )
+	return(CODERROR_NO_IMPLEMENTADO);
+Entradas=Parametros.sq_entries;
+
+/* Mapear el anillo de envíos y el de resultados (con un solo mmap si el kernel lo permite) */
+LongitudMapeoSQ=Parametros.sq_off.array+Parametros.sq_entries*sizeof(unsigned);
+LongitudMapeoCQ=Parametros.cq_off.cqes+Parametros.cq_entries*sizeof(TUringCQE);
+if (Parametros.features & URING_FEAT_SINGLE_MMAP)
+    {
+	if (LongitudMapeoCQ>LongitudMapeoSQ)
+		LongitudMapeoSQ=LongitudMapeoCQ;
+	LongitudMapeoCQ=0;
+    }
+if ( (MapeoSQ=mmap(NULL, LongitudMapeoSQ, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, FdUring, URING_OFF_SQ_RING)) == MAP_FAILED )
+	return(CODERROR_FALTA_MEMORIA);
+if (LongitudMapeoCQ==0)
+	MapeoCQ=MapeoSQ;
+else if ( (MapeoCQ=mmap(NULL, LongitudMapeoCQ, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, FdUring, URING_OFF_CQ_RING)) == MAP_FAILED )
+	return(CODERROR_FALTA_MEMORIA);
+
+/* Mapear el arreglo de pedidos */
+LongitudSQEs=Parametros.sq_entries*sizeof(TUringSQE);
+if ( (SQEs=(TUringSQE *)mmap(NULL, LongitudSQEs, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, FdUring, URING_OFF_SQES)) == MAP_FAILED )
+	return(CODERROR_FALTA_MEMORIA);
+
+/* Ubicar los campos de cada anillo */
+SQHead=(unsigned *)((unsigned char *)MapeoSQ+Parametros.sq_off.head);
+SQTail=(unsigned *)((unsigned char *)MapeoSQ+Parametros.sq_off.tail);
+SQMascara=(unsigned *)((unsigned char *)MapeoSQ+Parametros.sq_off.ring_mask);
+SQArreglo=(unsigned *)((unsigned char *)MapeoSQ+Parametros.sq_off.array);
+CQHead=(unsigned *)((unsigned char *)MapeoCQ+Parametros.cq_off.head);
+CQTail=(unsigned *)((unsigned char *)MapeoCQ+Parametros.cq_off.tail);
+CQMascara=(unsigned *)((unsigned char *)MapeoCQ+Parametros.cq_off.ring_mask);
+CQEs=(TUringCQE *)((unsigned char *)MapeoCQ+Parametros.cq_off.cqes);
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *					      TFuenteSectoresAsincronica :: FinalizarUring						*
+ *																	*
+ * OBJETIVO: Esta función desmapea los anillos y cierra la instancia de io_uring (tolera una inicialización a medias).			*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TFuenteSectoresAsincronica::FinalizarUring(void)
+{
+/* Desmapear lo que se haya llegado a mapear */
+if (SQEs!=MAP_FAILED)
+	munmap(SQEs, LongitudSQEs);
+if ( (MapeoCQ!=MAP_FAILED) && (MapeoCQ!=MapeoSQ) )
+	munmap(MapeoCQ, LongitudMapeoCQ);
+if (MapeoSQ!=MAP_FAILED)
+	munmap(MapeoSQ, LongitudMapeoSQ);
+SQEs=(TUringSQE *)MAP_FAILED;
+MapeoCQ=MAP_FAILED;
+MapeoSQ=MAP_FAILED;
+
+/* Cerrar la instancia */
+if (FdUring>=0)
+	close(FdUring);
+FdUring=-1;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						TFuenteSectoresAsincronica :: LeerRangos						*
+ *																	*
+ * OBJETIVO: Esta función copia varios rangos de la imágen a buffers del llamador, con todas las lecturas en vuelo a la vez.		*
+ *																	*
+ * ENTRADA: Rangos: Rangos a leer, cada uno con su buffer de destino.									*
+ *	    NroRangos: Cantidad de elementos de Rangos.											*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Los rangos grandes se parten en tramos de a lo sumo ASINC_MAX_LECTURA bytes, así se leen en paralelo.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TFuenteSectoresAsincronica::LeerRangos(TRangoLectura *Rangos, unsigned NroRangos)
+{
+std::vector<TRangoLectura>	Tramos;
+TRangoLectura			Tramo;
+__u64				Hecho;
+unsigned			i;
+
+/* Validar todos los rangos antes de lanzar nada */
+for(i=0;i<NroRangos;i++)
+	if ( (Rangos[i].Offset>LongitudImagen) || (Rangos[i].Longitud>(LongitudImagen-Rangos[i].Offset)) )
+		return(CODERROR_LECTURA_DISCO);
+
+/* Partir los rangos en tramos */
+for(i=0;i<NroRangos;i++)
+	for(Hecho=0;Hecho<Rangos[i].Longitud;Hecho+=Tramo.Longitud)
+	    {
+		Tramo.Offset=Rangos[i].Offset+Hecho;
+		Tramo.Longitud=min(Rangos[i].Longitud-Hecho, (__u64)ASINC_MAX_LECTURA);
+		Tramo.Destino=Rangos[i].Destino+Hecho;
+		Tramos.push_back(Tramo);
+	    }
+
+/* Un único tramo no gana nada con la maquinaria asincrónica */
+if (Tramos.size()==0)
+	return(CODERROR_NINGUNO);
+if (Tramos.size()==1)
+	return(Leer(Tramos[0].Offset, Tramos[0].Longitud, Tramos[0].Destino));
+
+/* Lanzarlos por io_uring o por el pool */
+if (FdUring>=0)
+	return(LeerRangosUring(Tramos));
+return(LeerRangosPool(Tramos));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *					      TFuenteSectoresAsincronica :: LeerRangosUring						*
+ *																	*
+ * OBJETIVO: Esta función lee un lote de tramos manteniendo hasta Entradas lecturas en vuelo en io_uring.				*
+ *																	*
+ * ENTRADA: Tramos: Tramos ya validados a leer.												*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Las lecturas cortas se completan con pread(). Un solo lote a la vez usa el anillo. Aún ante un error no sale con	*
+ *		  lecturas en vuelo, porque el kernel seguiría escribiendo en los buffers del llamador.					*
+ *																	*
+ ****************************************************************************************************************************************/
+int TFuenteSectoresAsincronica::LeerRangosUring(std::vector<TRangoLectura> &Tramos)
+{
+std::lock_guard<std::mutex>	Lock(MutexUring);
+TUringSQE			*SQE;
+TUringCQE			*CQE;
+TRangoLectura			*Tramo;
+unsigned			Siguiente, EnVuelo, AEnviar, Cabeza, Cola, Indice;
+int				Resultado, CodError;
+
+/* Inicializar variables */
+Siguiente=0;
+EnVuelo=0;
+AEnviar=0;
+CodError=CODERROR_NINGUNO;
+
+/* Hasta que no queden tramos por enviar ni lecturas en vuelo */
+while ( (Siguiente<Tramos.size()) || (EnVuelo>0) )
+    {
+	/* Cargar pedidos mientras haya lugar en el anillo (después de un error sólo se esperan los que están en vuelo) */
+	Cola=*SQTail;
+	while ( (CodError==CODERROR_NINGUNO) && (Siguiente<Tramos.size()) && (EnVuelo<Entradas) )
+	    {
+		Indice=Cola & *SQMascara;
+		SQE=&SQEs[Indice];
+		memset(SQE, 0, sizeof(TUringSQE));
+		SQE->opcode=URING_OP_READ;
+		SQE->fd=fileno(Archivo);
+		SQE->off=Tramos[Siguiente].Offset;
+		SQE->addr=(__u64)(uintptr_t)Tramos[Siguiente].Destino;
+		SQE->len=(__u32)Tramos[Siguiente].Longitud;
+		SQE->user_data=Siguiente;
+		SQArreglo[Indice]=Indice;
+		Cola++;
+		Siguiente++;
+		EnVuelo++;
+		AEnviar++;
+	    }
+	__atomic_store_n(SQTail, Cola, __ATOMIC_RELEASE);
+
+	/* Si hubo un error y no queda nada en vuelo, terminar */
+	if (EnVuelo==0)
+		break;
+
+	/* Enviar los pedidos pendientes y esperar al menos un resultado, los que el kernel no tomó siguen pendientes */
+	Resultado=io_uring_enter(FdUring, AEnviar, 1, URING_ENTER_GETEVENTS);
+	AEnviar=Cola-__atomic_load_n(SQHead, __ATOMIC_ACQUIRE);
+	if ( (Resultado<0) && (errno!=EINTR) )
+	    {
+		/* Retirar del anillo los pedidos no tomados y seguir sólo para recoger los que el kernel ya está leyendo */
+		if (CodError==CODERROR_NINGUNO)
+			CodError=CODERROR_LECTURA_DISCO;
+		__atomic_store_n(SQTail, Cola-AEnviar, __ATOMIC_RELEASE);
+		EnVuelo-=AEnviar;
+		AEnviar=0;
+	    }
+
+	/* Recoger los resultados disponibles */
+	Cabeza=*CQHead;
+	Cola=__atomic_load_n(CQTail, __ATOMIC_ACQUIRE);
+	while (Cabeza!=Cola)
+	    {
+		CQE=&CQEs[Cabeza & *CQMascara];
+		Tramo=&Tramos[(size_t)CQE->user_data];
+		Resultado=CQE->res;
+		Cabeza++;
+		EnVuelo--;
+
+		/* Completar con pread() las lecturas cortas */
+		if ( (Resultado<0) || ((__u64)Resultado>Tramo->Longitud) )
+			CodError=CODERROR_LECTURA_DISCO;
+		else if ( ((__u64)Resultado<Tramo->Longitud) && (CodError==CODERROR_NINGUNO) )
+			CodError=TFuenteSectoresArchivo::Leer(Tramo->Offset+Resultado, Tramo->Longitud-Resultado, Tramo->Destino+Resultado);
+	    }
+	__atomic_store_n(CQHead, Cabeza, __ATOMIC_RELEASE);
+    }
+
+/* Salir indicando el resultado */
+return(CodError);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *					      TFuenteSectoresAsincronica :: LeerRangosPool						*
+ *																	*
+ * OBJETIVO: Esta función lee un lote de tramos repartiéndolos entre los hilos del pool, cada uno con pread().				*
+ *																	*
+ * ENTRADA: Tramos: Tramos ya validados a leer.												*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TFuenteSectoresAsincronica::LeerRangosPool(std::vector<TRangoLectura> &Tramos)
+{
+std::atomic<int>	CodError(CODERROR_NINGUNO);
+
+/* Cada tarea lee un tramo, el primer error encontrado es el que se informa */
+Pool->Ejecutar(Tramos.size(), [&](unsigned i)
+    {
+	int	Resultado;
+	int	Esperado = CODERROR_NINGUNO;
+
+	if ( (Resultado=TFuenteSectoresArchivo::Leer(Tramos[i].Offset, Tramos[i].Longitud, Tramos[i].Destino)) != CODERROR_NINGUNO )
+		CodError.compare_exchange_strong(Esperado, Resultado);
+    });
+
+/* Salir indicando el resultado */
+return(CodError);
+}
\ No newline at end of file
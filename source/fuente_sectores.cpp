@@ -0,0 +1,736 @@
+﻿#include "all_heads.h"
+
+
+/********************************
+ *				*
+ *    Clase TFuenteSectores	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *						   TFuenteSectores :: TFuenteSectores							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteSectores::TFuenteSectores()
+{
+/* Inicialziar variables */
+LongitudImagen=0;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TFuenteSectores :: ~TFuenteSectores							*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteSectores::~TFuenteSectores()
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TFuenteSectores :: Longitud							*
+ *																	*
+ * OBJETIVO: Esta función devuelve el tamaño de la imágen.										*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función el tamaño, en bytes, de la imágen.								*
+ *																	*
+ ****************************************************************************************************************************************/
+__u64 TFuenteSectores::Longitud(void)
+{
+return(LongitudImagen);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TFuenteSectores :: PunteroARango							*
+ *																	*
+ * OBJETIVO: Esta función devuelve un puntero a un rango de bytes contiguos de la imágen.						*
+ *																	*
+ * ENTRADA: Offset: Posición, en bytes, del comienzo del rango.										*
+ *	    Longitud: Cantidad de bytes contiguos que se necesitan a partir de Offset.							*
+ *																	*
+ * SALIDA: En el nombre de la función el puntero a los datos, o NULL si el rango no existe o la fuente no es direccionable.		*
+ *																	*
+ ****************************************************************************************************************************************/
+const unsigned char *TFuenteSectores::PunteroARango(__u64 Offset, unsigned Longitud)
+{
+/* Por defecto la fuente no es direccionable */
+return(NULL);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TFuenteSectores :: SoltarRango							*
+ *																	*
+ * OBJETIVO: Esta función avisa que ya no se usa un puntero devuelto por PunteroARango().						*
+ *																	*
+ * ENTRADA: Puntero: Puntero devuelto por PunteroARango() (NULL no hace nada).								*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Por defecto no hace nada, los datos viven tanto como la fuente.							*
+ *																	*
+ ****************************************************************************************************************************************/
+void TFuenteSectores::SoltarRango(const unsigned char *Puntero)
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TFuenteSectores :: Leer							*
+ *																	*
+ * OBJETIVO: Esta función copia un rango de la imágen a un buffer del llamador.								*
+ *																	*
+ * ENTRADA: Offset: Posición, en bytes, del comienzo del rango.										*
+ *	    Longitud: Cantidad de bytes a copiar.											*
+ *	    Destino: Buffer donde copiar los datos (de al menos Longitud bytes).							*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: La implementación por defecto copia desde PunteroARango() de a un bloque de cache por vez.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TFuenteSectores::Leer(__u64 Offset, __u64 Longitud, unsigned char *Destino)
+{
+const unsigned char	*p;
+unsigned		Tramo;
+
+/* Validar el rango */
+if ( (Offset>LongitudImagen) || (Longitud>(LongitudImagen-Offset)) )
+	return(CODERROR_LECTURA_DISCO);
+
+/* Copiar de a tramos */
+while (Longitud>0)
+    {
+	Tramo=(unsigned)min(Longitud, (__u64)CACHE_TAM_BLOQUE);
+	if ( (p=PunteroARango(Offset, Tramo)) == NULL )
+		return(CODERROR_LECTURA_DISCO);
+	memcpy(Destino, p, Tramo);
+	SoltarRango(p);
+	Offset+=Tramo;
+	Destino+=Tramo;
+	Longitud-=Tramo;
+    }
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TFuenteSectores :: LeerRangos							*
+ *																	*
+ * OBJETIVO: Esta función copia un lote de rangos de la imágen a los buffers del llamador.						*
+ *																	*
+ * ENTRADA: Rangos: Arreglo con los rangos a leer y dónde copiar cada uno.								*
+ *	    NroRangos: Cantidad de elementos del arreglo.										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si se leyeron todos, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: La implementación por defecto lee los rangos de a uno, las fuentes que pueden tener varias lecturas en vuelo la	*
+ *		  redefinen.														*
+ *																	*
+ ****************************************************************************************************************************************/
+int TFuenteSectores::LeerRangos(TRangoLectura *Rangos, unsigned NroRangos)
+{
+int		CodError;
+unsigned	i;
+
+/* Leer cada rango */
+for(i=0;i<NroRangos;i++)
+	if ( (CodError=Leer(Rangos[i].Offset, Rangos[i].Longitud, Rangos[i].Destino)) != CODERROR_NINGUNO )
+		return(CodError);
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TFuenteSectores :: Concurrente							*
+ *																	*
+ * OBJETIVO: Esta función indica si varios hilos pueden leer de la fuente a la vez.							*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función true si se la puede usar desde varios hilos sin sincronizar.					*
+ *																	*
+ * OBSERVACIONES: Por defecto no, las fuentes con estado (como la cache) invalidan punteros devueltos a otros hilos.			*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TFuenteSectores::Concurrente(void)
+{
+return(false);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TFuenteSectores :: EnMemoria							*
+ *																	*
+ * OBJETIVO: Esta función indica si la imágen completa está en memoria, de modo que PunteroARango() no lee ni aloca nada.		*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función true si los punteros a cualquier rango salen directamente de la imágen en memoria.		*
+ *																	*
+ * OBSERVACIONES: Por defecto no. En la cache PunteroARango() siempre devuelve un puntero, pero levantando el rango a un bloque, por	*
+ *		  lo que quien recorre rangos grandes una sola vez conviene que use Leer() a un buffer propio.				*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TFuenteSectores::EnMemoria(void)
+{
+return(false);
+}
+
+
+/****************************************
+ *					*
+ *  Clase TFuenteSectoresMemoria	*
+ *					*
+ ****************************************/
+/****************************************************************************************************************************************
+ *																	*
+ *					    TFuenteSectoresMemoria :: TFuenteSectoresMemoria						*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Datos: Buffer alocado con malloc() con la imágen completa (pasa a ser propiedad de esta clase).				*
+ *	    Longitud: Tamaño, en bytes, de la imágen.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteSectoresMemoria::TFuenteSectoresMemoria(unsigned char *Datos, __u64 Longitud)
+{
+/* Tomar los valores recibidos */
+TFuenteSectoresMemoria::Datos=Datos;
+LongitudImagen=Longitud;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *					    TFuenteSectoresMemoria :: ~TFuenteSectoresMemoria						*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteSectoresMemoria::~TFuenteSectoresMemoria()
+{
+/* Liberar la imágen si todavía es mía */
+if (Datos)
+    {
+	free(Datos);
+	Datos=NULL;
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TFuenteSectoresMemoria :: PunteroARango						*
+ *																	*
+ * OBJETIVO: Esta función devuelve un puntero a un rango de bytes contiguos de la imágen.						*
+ *																	*
+ * ENTRADA: Offset: Posición, en bytes, del comienzo del rango.										*
+ *	    Longitud: Cantidad de bytes contiguos que se necesitan a partir de Offset.							*
+ *																	*
+ * SALIDA: En el nombre de la función el puntero a los datos, o NULL si el rango no existe.						*
+ *																	*
+ ****************************************************************************************************************************************/
+const unsigned char *TFuenteSectoresMemoria::PunteroARango(__u64 Offset, unsigned Longitud)
+{
+/* Ver si el rango existe */
+if ( (!Datos) || (Offset>LongitudImagen) || (Longitud>(LongitudImagen-Offset)) )
+	return(NULL);
+
+/* La imágen está toda en memoria */
+return(Datos+Offset);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TFuenteSectoresMemoria :: Leer							*
+ *																	*
+ * OBJETIVO: Esta función copia un rango de la imágen a un buffer del llamador.								*
+ *																	*
+ * ENTRADA: Offset: Posición, en bytes, del comienzo del rango.										*
+ *	    Longitud: Cantidad de bytes a copiar.											*
+ *	    Destino: Buffer donde copiar los datos (de al menos Longitud bytes).							*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TFuenteSectoresMemoria::Leer(__u64 Offset, __u64 Longitud, unsigned char *Destino)
+{
+/* Validar el rango */
+if ( (!Datos) || (Offset>LongitudImagen) || (Longitud>(LongitudImagen-Offset)) )
+	return(CODERROR_LECTURA_DISCO);
+
+/* La imágen está toda en memoria, copiar de una vez */
+memcpy(Destino, Datos+Offset, (size_t)Longitud);
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TFuenteSectoresMemoria :: Concurrente							*
+ *																	*
+ * OBJETIVO: Esta función indica si varios hilos pueden leer de la fuente a la vez.							*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función true: la imágen está entera en memoria y no se modifica.						*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TFuenteSectoresMemoria::Concurrente(void)
+{
+return(true);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TFuenteSectoresMemoria :: EnMemoria							*
+ *																	*
+ * OBJETIVO: Esta función indica si la imágen completa está en memoria.									*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función true: la imágen está entera en memoria (alocada o mapeada).					*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TFuenteSectoresMemoria::EnMemoria(void)
+{
+return(true);
+}
+
+
+/****************************************
+ *					*
+ *   Clase TFuenteSectoresMMap		*
+ *					*
+ ****************************************/
+/****************************************************************************************************************************************
+ *																	*
+ *					       TFuenteSectoresMMap :: TFuenteSectoresMMap						*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Mapeo: Dirección devuelta por mmap() para la imágen completa (pasa a ser propiedad de esta clase).				*
+ *	    Longitud: Tamaño, en bytes, de la imágen.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteSectoresMMap::TFuenteSectoresMMap(void *Mapeo, __u64 Longitud) : TFuenteSectoresMemoria((unsigned char *)Mapeo, Longitud)
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *					       TFuenteSectoresMMap :: ~TFuenteSectoresMMap						*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteSectoresMMap::~TFuenteSectoresMMap()
+{
+/* Desmapear la imágen (y evitar que la clase base intente liberarla con free) */
+if (Datos)
+    {
+	munmap(Datos, (size_t)LongitudImagen);
+	Datos=NULL;
+    }
+}
+
+
+/****************************************
+ *					*
+ *  Clase TFuenteSectoresArchivo	*
+ *					*
+ ****************************************/
+/****************************************************************************************************************************************
+ *																	*
+ *					    TFuenteSectoresArchivo :: TFuenteSectoresArchivo						*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: f: Archivo abierto con la imágen (pasa a ser propiedad de esta clase).							*
+ *	    Longitud: Tamaño, en bytes, de la imágen.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteSectoresArchivo::TFuenteSectoresArchivo(FILE *f, __u64 Longitud)
+{
+/* Tomar los valores recibidos */
+Archivo=f;
+LongitudImagen=Longitud;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *					    TFuenteSectoresArchivo :: ~TFuenteSectoresArchivo						*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TFuenteSectoresArchivo::~TFuenteSectoresArchivo()
+{
+/* Cerrar el archivo */
+if (Archivo)
+    {
+	fclose(Archivo);
+	Archivo=NULL;
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TFuenteSectoresArchivo :: Leer							*
+ *																	*
+ * OBJETIVO: Esta función copia un rango de la imágen a un buffer del llamador leyéndolo directamente del archivo.			*
+ *																	*
+ * ENTRADA: Offset: Posición, en bytes, del comienzo del rango.										*
+ *	    Longitud: Cantidad de bytes a copiar.											*
+ *	    Destino: Buffer donde copiar los datos (de al menos Longitud bytes).							*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TFuenteSectoresArchivo::Leer(__u64 Offset, __u64 Longitud, unsigned char *Destino)
+{
+ssize_t	Leidos;
+
+/* Validar el rango */
+if ( (Offset>LongitudImagen) || (Longitud>(LongitudImagen-Offset)) )
+	return(CODERROR_LECTURA_DISCO);
+
+/* pread() puede devolver menos de lo pedido, insistir hasta completar */
+while (Longitud>0)
+    {
+	Leidos=pread(fileno(Archivo), Destino, (size_t)Longitud, (off_t)Offset);
+	if (Leidos<=0)
+		return(CODERROR_LECTURA_DISCO);
+	Offset+=Leidos;
+	Destino+=Leidos;
+	Longitud-=Leidos;
+    }
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/********************************
+ *				*
+ *      Clase TCacheBloques	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *						     TCacheBloques :: TCacheBloques							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Origen: Fuente de la que se leen los bloques que no están en la cache (pasa a ser propiedad de esta clase).			*
+ *	    Presupuesto: Cantidad máxima de bytes a mantener en la cache.								*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TCacheBloques::TCacheBloques(TFuenteSectores *Origen, __u64 Presupuesto)
+{
+/* Tomar los valores recibidos */
+TCacheBloques::Origen=Origen;
+TCacheBloques::Presupuesto=Presupuesto;
+LongitudImagen=Origen->Longitud();
+
+/* No bajar del mínimo de bloques que necesitan los drivers */
+if (TCacheBloques::Presupuesto<(__u64)CACHE_MIN_BLOQUES*CACHE_TAM_BLOQUE)
+	TCacheBloques::Presupuesto=(__u64)CACHE_MIN_BLOQUES*CACHE_TAM_BLOQUE;
+
+/* Inicialziar variables */
+Ocupado=0;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TCacheBloques :: ~TCacheBloques							*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TCacheBloques::~TCacheBloques()
+{
+std::list<TBloqueCache>::iterator	it;
+
+/* Liberar los bloques guardados y los retirados que nadie soltó */
+for(it=Bloques.begin();it!=Bloques.end();it++)
+	free(it->Datos);
+for(it=Retirados.begin();it!=Retirados.end();it++)
+	free(it->Datos);
+Bloques.clear();
+Retirados.clear();
+Indice.clear();
+PorDatos.clear();
+
+/* Liberar la fuente de origen */
+delete Origen;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TCacheBloques :: PunteroARango							*
+ *																	*
+ * OBJETIVO: Esta función devuelve un puntero a un rango de bytes contiguos de la imágen, trayendo a la cache el bloque alineado que	*
+ *	     lo contiene si no está.													*
+ *																	*
+ * ENTRADA: Offset: Posición, en bytes, del comienzo del rango.										*
+ *	    Longitud: Cantidad de bytes contiguos que se necesitan a partir de Offset.							*
+ *																	*
+ * SALIDA: En el nombre de la función el puntero a los datos, o NULL si el rango no existe o no se pudo leer.				*
+ *																	*
+ * OBSERVACIONES: El bloque queda fijado (no se desaloja ni se libera) hasta que se suelte el puntero con SoltarRango(). Si el rango	*
+ *		  cruza el límite de un bloque se guarda un bloque más largo que lo cubre entero.					*
+ *																	*
+ ****************************************************************************************************************************************/
+const unsigned char *TCacheBloques::PunteroARango(__u64 Offset, unsigned Longitud)
+{
+std::unordered_map<__u64, std::list<TBloqueCache>::iterator>::iterator	Buscado;
+TBloqueCache								Bloque;
+__u64									Fin;
+
+/* Validar el rango */
+if ( (Offset>LongitudImagen) || (Longitud>(LongitudImagen-Offset)) )
+	return(NULL);
+
+/* Calcular el bloque alineado que contiene el rango */
+Bloque.Inicio=Offset-(Offset%CACHE_TAM_BLOQUE);
+Fin=Offset+Longitud;
+
+/* Ver si ya lo tengo y alcanza para cubrir el rango */
+Buscado=Indice.find(Bloque.Inicio);
+if (Buscado!=Indice.end())
+    {
+	if (Buscado->second->Inicio+Buscado->second->Longitud >= Fin)
+	    {
+		/* Acierto, pasarlo al frente de la lista LRU y fijarlo */
+		Bloques.splice(Bloques.begin(), Bloques, Buscado->second);
+		Bloques.front().Fijaciones++;
+		return(Bloques.front().Datos+(Offset-Bloque.Inicio));
+	    }
+
+	/* Es más corto que lo que necesito, descartarlo para traer uno más largo (si está fijado se libera recién al soltarlo) */
+	if (Buscado->second->Fijaciones)
+	    {
+		Buscado->second->Retirado=true;
+		Retirados.splice(Retirados.end(), Bloques, Buscado->second);
+	    }
+	else
+		Liberar(Bloques, Buscado->second);
+	Indice.erase(Buscado);
+    }
+
+/* Redondear el final al siguiente bloque, sin pasarse de la imágen */
+Fin=((Fin+CACHE_TAM_BLOQUE-1)/CACHE_TAM_BLOQUE)*CACHE_TAM_BLOQUE;
+if (Fin>LongitudImagen)
+	Fin=LongitudImagen;
+Bloque.Longitud=(unsigned)(Fin-Bloque.Inicio);
+
+/* Traer el bloque del origen */
+Bloque.Fijaciones=1;
+Bloque.Retirado=false;
+if ( (Bloque.Datos=(unsigned char *)malloc(Bloque.Longitud)) == NULL )
+	return(NULL);
+if (Origen->Leer(Bloque.Inicio, Bloque.Longitud, Bloque.Datos) != CODERROR_NINGUNO)
+    {
+	free(Bloque.Datos);
+	return(NULL);
+    }
+
+/* Guardarlo como el más recientemente usado y hacer lugar si me pasé del presupuesto */
+Bloques.push_front(Bloque);
+Indice[Bloque.Inicio]=Bloques.begin();
+PorDatos[Bloque.Datos]=Bloques.begin();
+Ocupado+=Bloque.Longitud;
+Desalojar();
+
+/* Retornar el puntero solicitado */
+return(Bloque.Datos+(Offset-Bloque.Inicio));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TCacheBloques :: SoltarRango							*
+ *																	*
+ * OBJETIVO: Esta función avisa que ya no se usa un puntero devuelto por PunteroARango(), para que su bloque se pueda desalojar.	*
+ *																	*
+ * ENTRADA: Puntero: Puntero devuelto por PunteroARango() (NULL no hace nada).								*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TCacheBloques::SoltarRango(const unsigned char *Puntero)
+{
+std::map<const unsigned char *, std::list<TBloqueCache>::iterator>::iterator	Buscado;
+std::list<TBloqueCache>::iterator						Bloque;
+
+/* Buscar el bloque que contiene el puntero (el de comienzo más cercano por debajo) */
+if (!Puntero)
+	return;
+Buscado=PorDatos.upper_bound(Puntero);
+if (Buscado==PorDatos.begin())
+	return;
+Bloque=(--Buscado)->second;
+if ( (Puntero>=Bloque->Datos+Bloque->Longitud) || (Bloque->Fijaciones==0) )
+	return;
+
+/* Si era el último que lo usaba, liberarlo si estaba retirado o desalojar lo que haya quedado esperando */
+if (--Bloque->Fijaciones)
+	return;
+if (Bloque->Retirado)
+	Liberar(Retirados, Bloque);
+else if (Ocupado>Presupuesto)
+	Desalojar();
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							  TCacheBloques :: Leer								*
+ *																	*
+ * OBJETIVO: Esta función copia un rango de la imágen a un buffer del llamador.								*
+ *																	*
+ * ENTRADA: Offset: Posición, en bytes, del comienzo del rango.										*
+ *	    Longitud: Cantidad de bytes a copiar.											*
+ *	    Destino: Buffer donde copiar los datos (de al menos Longitud bytes).							*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Las lecturas masivas van directo al origen para no desalojar de la cache la metadata que se usa seguido.		*
+ *																	*
+ ****************************************************************************************************************************************/
+int TCacheBloques::Leer(__u64 Offset, __u64 Longitud, unsigned char *Destino)
+{
+return(Origen->Leer(Offset, Longitud, Destino));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TCacheBloques :: LeerRangos							*
+ *																	*
+ * OBJETIVO: Esta función copia un lote de rangos de la imágen a los buffers del llamador.						*
+ *																	*
+ * ENTRADA: Rangos: Arreglo con los rangos a leer y dónde copiar cada uno.								*
+ *	    NroRangos: Cantidad de elementos del arreglo.										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si se leyeron todos, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Igual que Leer(), el lote va directo al origen sin pasar por la cache.						*
+ *																	*
+ ****************************************************************************************************************************************/
+int TCacheBloques::LeerRangos(TRangoLectura *Rangos, unsigned NroRangos)
+{
+return(Origen->LeerRangos(Rangos, NroRangos));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TCacheBloques :: Desalojar							*
+ *																	*
+ * OBJETIVO: Esta función libera los bloques menos recientemente usados hasta volver a estar dentro del presupuesto.			*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Los bloques fijados no se desalojan, si sólo quedan ésos la cache se pasa del presupuesto hasta que se suelten.	*
+ *																	*
+ ****************************************************************************************************************************************/
+void TCacheBloques::Desalojar(void)
+{
+std::list<TBloqueCache>::iterator	it;
+
+/* Recorrer la lista LRU desde el final, salteando los que están en uso */
+it=Bloques.end();
+while ( (Ocupado>Presupuesto) && (it!=Bloques.begin()) )
+    {
+	if ((--it)->Fijaciones)
+		continue;
+	Indice.erase(it->Inicio);
+	it=Liberar(Bloques, it);
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TCacheBloques :: Liberar							*
+ *																	*
+ * OBJETIVO: Esta función libera un bloque y lo saca de la lista en la que está.							*
+ *																	*
+ * ENTRADA: Lista: Lista que contiene al bloque (Bloques o Retirados).									*
+ *	    Bloque: Bloque a liberar (no lo saca del índice por posición).								*
+ *																	*
+ * SALIDA: En el nombre de la función el bloque que le seguía en la lista.								*
+ *																	*
+ ****************************************************************************************************************************************/
+std::list<TBloqueCache>::iterator TCacheBloques::Liberar(std::list<TBloqueCache> &Lista, std::list<TBloqueCache>::iterator Bloque)
+{
+Ocupado-=Bloque->Longitud;
+PorDatos.erase(Bloque->Datos);
+free(Bloque->Datos);
+return(Lista.erase(Bloque));
+}
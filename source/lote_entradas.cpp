@@ -0,0 +1,299 @@
+﻿#include "all_heads.h"
+
+
+/********************************
+ *				*
+ *    Clase TLoteEntradas	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *						     TLoteEntradas :: TLoteEntradas							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TLoteEntradas::TLoteEntradas()
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TLoteEntradas :: ~TLoteEntradas							*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TLoteEntradas::~TLoteEntradas()
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TLoteEntradas :: Vaciar							*
+ *																	*
+ * OBJETIVO: Esta función descarta todas las entradas del lote, conservando la memoria para las siguientes.				*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TLoteEntradas::Vaciar(void)
+{
+Arena.clear();
+Inicios.clear();
+ListaFlags.clear();
+ListaBytes.clear();
+ListaFechasCreacion.clear();
+ListaFechasAcceso.clear();
+ListaFechasModificacion.clear();
+ListaEspecificos.clear();
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TLoteEntradas :: Agregar							*
+ *																	*
+ * OBJETIVO: Esta función agrega una copia de una entrada de directorio al final del lote.						*
+ *																	*
+ * ENTRADA: Entrada: Entrada a copiar.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TLoteEntradas::Agregar(const TEntradaDirectorio &Entrada)
+{
+Agregar(Entrada, Entrada.Nombre.c_str(), (unsigned)Entrada.Nombre.size());
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TLoteEntradas :: Agregar							*
+ *																	*
+ * OBJETIVO: Esta función agrega una copia de una entrada de directorio al final del lote, guardándola con otro nombre.			*
+ *																	*
+ * ENTRADA: Entrada: Entrada a copiar (se ignora su nombre).										*
+ *	    Nombre: Nombre a guardar (por ejemplo, una ruta completa).									*
+ *	    LongitudNombre: Cantidad de caracteres de Nombre.										*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Cada nombre queda terminado en '\0' dentro del buffer común, que no puede superar los 4GB.				*
+ *																	*
+ ****************************************************************************************************************************************/
+void TLoteEntradas::Agregar(const TEntradaDirectorio &Entrada, const char *Nombre, unsigned LongitudNombre)
+{
+size_t	Inicio;
+
+/* Copiar el nombre al final del buffer común */
+Inicios.push_back((unsigned)Arena.size());
+Arena.insert(Arena.end(), Nombre, Nombre+LongitudNombre);
+Arena.push_back('\0');
+
+/* Copiar los campos fijos, cada uno en su vector */
+ListaFlags.push_back(Entrada.Flags);
+ListaBytes.push_back(Entrada.Bytes);
+ListaFechasCreacion.push_back(Entrada.FechaCreacion);
+ListaFechasAcceso.push_back(Entrada.FechaUltimoAcceso);
+ListaFechasModificacion.push_back(Entrada.FechaUltimaModificacion);
+Inicio=ListaEspecificos.size();
+ListaEspecificos.resize(Inicio+sizeof(Entrada.DatosEspecificos));
+memcpy(&ListaEspecificos[Inicio], &Entrada.DatosEspecificos, sizeof(Entrada.DatosEspecificos));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TLoteEntradas :: Cantidad							*
+ *																	*
+ * OBJETIVO: Esta función retorna la cantidad de entradas del lote.									*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función la cantidad de entradas.										*
+ *																	*
+ ****************************************************************************************************************************************/
+unsigned TLoteEntradas::Cantidad(void) const
+{
+return((unsigned)Inicios.size());
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TLoteEntradas :: Nombre							*
+ *																	*
+ * OBJETIVO: Esta función retorna el nombre de una entrada del lote.									*
+ *																	*
+ * ENTRADA: Indice: Número de entrada (0 a Cantidad()-1).										*
+ *																	*
+ * SALIDA: En el nombre de la función el nombre, terminado en '\0'. Sigue siendo válido hasta que se agregue otra entrada o se		*
+ *	   vacíe el lote.														*
+ *																	*
+ ****************************************************************************************************************************************/
+const char *TLoteEntradas::Nombre(unsigned Indice) const
+{
+return(&Arena[Inicios[Indice]]);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TLoteEntradas :: LongitudNombre							*
+ *																	*
+ * OBJETIVO: Esta función retorna la longitud del nombre de una entrada del lote.							*
+ *																	*
+ * ENTRADA: Indice: Número de entrada (0 a Cantidad()-1).										*
+ *																	*
+ * SALIDA: En el nombre de la función la cantidad de caracteres del nombre, sin contar el '\0'.						*
+ *																	*
+ ****************************************************************************************************************************************/
+unsigned TLoteEntradas::LongitudNombre(unsigned Indice) const
+{
+unsigned	Fin;
+
+/* El nombre termina donde empieza el siguiente (o donde termina el buffer), menos el '\0' */
+Fin=(Indice+1<Inicios.size()) ? Inicios[Indice+1] : (unsigned)Arena.size();
+return(Fin-Inicios[Indice]-1);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TLoteEntradas :: Flags								*
+ *																	*
+ * OBJETIVO: Esta función retorna los flags (fed*) de una entrada del lote.								*
+ *																	*
+ * ENTRADA: Indice: Número de entrada (0 a Cantidad()-1).										*
+ *																	*
+ * SALIDA: En el nombre de la función los flags.											*
+ *																	*
+ ****************************************************************************************************************************************/
+unsigned TLoteEntradas::Flags(unsigned Indice) const
+{
+return(ListaFlags[Indice]);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TLoteEntradas :: Bytes								*
+ *																	*
+ * OBJETIVO: Esta función retorna el tamaño de una entrada del lote.									*
+ *																	*
+ * ENTRADA: Indice: Número de entrada (0 a Cantidad()-1).										*
+ *																	*
+ * SALIDA: En el nombre de la función el tamaño en bytes.										*
+ *																	*
+ ****************************************************************************************************************************************/
+__u64 TLoteEntradas::Bytes(unsigned Indice) const
+{
+return(ListaBytes[Indice]);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TLoteEntradas :: FechaCreacion							*
+ *																	*
+ * OBJETIVO: Esta función retorna la fecha de creación de una entrada del lote.								*
+ *																	*
+ * ENTRADA: Indice: Número de entrada (0 a Cantidad()-1).										*
+ *																	*
+ * SALIDA: En el nombre de la función la fecha.												*
+ *																	*
+ ****************************************************************************************************************************************/
+time_t TLoteEntradas::FechaCreacion(unsigned Indice) const
+{
+return(ListaFechasCreacion[Indice]);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TLoteEntradas :: FechaUltimoAcceso							*
+ *																	*
+ * OBJETIVO: Esta función retorna la fecha de último acceso de una entrada del lote.							*
+ *																	*
+ * ENTRADA: Indice: Número de entrada (0 a Cantidad()-1).										*
+ *																	*
+ * SALIDA: En el nombre de la función la fecha.												*
+ *																	*
+ ****************************************************************************************************************************************/
+time_t TLoteEntradas::FechaUltimoAcceso(unsigned Indice) const
+{
+return(ListaFechasAcceso[Indice]);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						TLoteEntradas :: FechaUltimaModificacion						*
+ *																	*
+ * OBJETIVO: Esta función retorna la fecha de última modificación de una entrada del lote.						*
+ *																	*
+ * ENTRADA: Indice: Número de entrada (0 a Cantidad()-1).										*
+ *																	*
+ * SALIDA: En el nombre de la función la fecha.												*
+ *																	*
+ ****************************************************************************************************************************************/
+time_t TLoteEntradas::FechaUltimaModificacion(unsigned Indice) const
+{
+return(ListaFechasModificacion[Indice]);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TLoteEntradas :: Entrada							*
+ *																	*
+ * OBJETIVO: Esta función rearma una entrada de directorio completa a partir del lote.							*
+ *																	*
+ * ENTRADA: Indice: Número de entrada (0 a Cantidad()-1).										*
+ *																	*
+ * SALIDA: Entrada: Copia de la entrada (conviene reutilizarla entre llamadas, así el nombre no vuelve a alocar).			*
+ *																	*
+ ****************************************************************************************************************************************/
+void TLoteEntradas::Entrada(unsigned Indice, TEntradaDirectorio &Entrada) const
+{
+Entrada.Nombre.assign(Nombre(Indice), LongitudNombre(Indice));
+Entrada.Flags=ListaFlags[Indice];
+Entrada.Bytes=ListaBytes[Indice];
+Entrada.FechaCreacion=ListaFechasCreacion[Indice];
+Entrada.FechaUltimoAcceso=ListaFechasAcceso[Indice];
+Entrada.FechaUltimaModificacion=ListaFechasModificacion[Indice];
+memcpy(&Entrada.DatosEspecificos, &ListaEspecificos[Indice*sizeof(Entrada.DatosEspecificos)], sizeof(Entrada.DatosEspecificos));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TLoteEntradas :: Manejador							*
+ *																	*
+ * OBJETIVO: Esta función arma el manejador de una entrada del lote, sin pasar por una TEntradaDirectorio.				*
+ *																	*
+ * ENTRADA: Indice: Número de entrada (0 a Cantidad()-1).										*
+ *																	*
+ * SALIDA: Manejador: Lo mismo que arma TDriverBase::ManejadorEntrada() para esa entrada.						*
+ *																	*
+ ****************************************************************************************************************************************/
+void TLoteEntradas::Manejador(unsigned Indice, TManejadorArchivo &Manejador) const
+{
+memset(&Manejador, 0, sizeof(Manejador));
+Manejador.Flags=ListaFlags[Indice];
+Manejador.Bytes=ListaBytes[Indice];
+memcpy(&Manejador.DatosEspecificos, &ListaEspecificos[Indice*sizeof(Manejador.DatosEspecificos)], sizeof(Manejador.DatosEspecificos));
+}
\ No newline at end of file
@@ -0,0 +1,386 @@
+﻿#include "all_heads.h"
+
+
+/********************************
+ *				*
+ *    Clase TLoteImagenes	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *						     TLoteImagenes :: TLoteImagenes							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TLoteImagenes::TLoteImagenes()
+{
+/* Inicializar variables */
+SiguienteImagen=0;
+SiguienteAEmitir=0;
+PresupuestoCache=0;
+NroHilos=0;
+Formato=fmtTEXTO;
+Metricas=false;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TLoteImagenes :: ~TLoteImagenes							*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TLoteImagenes::~TLoteImagenes()
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TLoteImagenes :: CargarImagenes							*
+ *																	*
+ * OBJETIVO: Esta función arma la lista de imágenes a analizar.										*
+ *																	*
+ * ENTRADA: Ruta: Directorio con las imágenes, o archivo de texto con la ruta de una imágen por línea.					*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Los informes se emiten en el orden de la lista, o en orden alfabético si se trata de un directorio.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TLoteImagenes::CargarImagenes(const char *Ruta)
+{
+DIR	*Directorio;
+int	CodError;
+
+/* Empezar con la lista vacía */
+Rutas.clear();
+
+/* Ver si es un directorio o una lista */
+if ( (Directorio=opendir(Ruta)) != NULL )
+	CodError=CargarDirectorio(Directorio, Ruta);
+else
+	CodError=CargarLista(Ruta);
+if (CodError!=CODERROR_NINGUNO)
+	return(CodError);
+
+/* Tiene que haber al menos una imágen */
+if (Rutas.empty())
+	return(CODERROR_ARCHIVO_INEXISTENTE);
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TLoteImagenes :: UsarCacheBloques							*
+ *																	*
+ * OBJETIVO: Esta función indica que cada imágen se lea bajo demanda a través de una cache de bloques propia.				*
+ *																	*
+ * ENTRADA: Presupuesto: Cantidad máxima de memoria, en bytes, de la cache de cada hilo (0 mapea las imágenes).				*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TLoteImagenes::UsarCacheBloques(__u64 Presupuesto)
+{
+PresupuestoCache=Presupuesto;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TLoteImagenes :: UsarHilos							*
+ *																	*
+ * OBJETIVO: Esta función indica cuántas imágenes se analizan a la vez.									*
+ *																	*
+ * ENTRADA: NroHilos: Cantidad de hilos (0 usa uno por núcleo).										*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TLoteImagenes::UsarHilos(unsigned NroHilos)
+{
+TLoteImagenes::NroHilos=NroHilos;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TLoteImagenes :: UsarFormato							*
+ *																	*
+ * OBJETIVO: Esta función elige el formato de los informes: texto (por defecto), JSON Lines o binario.					*
+ *																	*
+ * ENTRADA: Formato: Formato a usar.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TLoteImagenes::UsarFormato(TFormatoSalida Formato)
+{
+TLoteImagenes::Formato=Formato;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TLoteImagenes :: UsarMetricas							*
+ *																	*
+ * OBJETIVO: Esta función indica si se mide cada comando de tests, con un resumen al final del informe de cada imágen.			*
+ *																	*
+ * ENTRADA: Activar: true para medir.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TLoteImagenes::UsarMetricas(bool Activar)
+{
+Metricas=Activar;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TLoteImagenes :: Ejecutar							*
+ *																	*
+ * OBJETIVO: Esta función analiza todas las imágenes de la lista en paralelo y emite sus informes por stdout.				*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si todas las imágenes se analizaron sin errores, caso contrario el código de	*
+ *	   error de la primera (en el orden de la lista) que falló.									*
+ *																	*
+ * OBSERVACIONES: Cada hilo tiene su propio TAnalizadorFS y escribe el informe de cada imágen en un buffer en memoria. Apenas está	*
+ *		  completo el informe que sigue en el orden de la lista se emite, junto con los siguientes que ya estén listos.		*
+ *																	*
+ ****************************************************************************************************************************************/
+int TLoteImagenes::Ejecutar(void)
+{
+unsigned	Hilos, i;
+
+/* Preparar el estado de cada imágen */
+Informes.assign(Rutas.size(), std::string());
+Resultados.assign(Rutas.size(), CODERROR_NINGUNO);
+Terminados.assign(Rutas.size(), false);
+SiguienteImagen=0;
+SiguienteAEmitir=0;
+
+/* No tiene sentido tener más hilos que imágenes */
+Hilos=NroHilos ? NroHilos : std::thread::hardware_concurrency();
+if (Hilos==0)
+	Hilos=1;
+if (Hilos>Rutas.size())
+	Hilos=Rutas.size();
+
+/* Cada tarea del pool es un trabajador que va tomando imágenes de la lista */
+    {
+	TPoolHilos Pool(Hilos);
+	Pool.Ejecutar(Pool.NroHilos(), [this](unsigned) { Trabajar(); });
+    }
+
+/* Informar el primer error, en el orden de la lista */
+for(i=0;i<Resultados.size();i++)
+	if (Resultados[i]!=CODERROR_NINGUNO)
+		return(Resultados[i]);
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TLoteImagenes :: CargarDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función agrega a la lista los archivos de un directorio, en orden alfabético.						*
+ *																	*
+ * ENTRADA: Directorio: Directorio abierto con opendir() (esta función lo cierra).							*
+ *	    Ruta: Ruta del directorio.													*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Se saltean los archivos ocultos y los subdirectorios.									*
+ *																	*
+ ****************************************************************************************************************************************/
+int TLoteImagenes::CargarDirectorio(DIR *Directorio, const char *Ruta)
+{
+struct dirent	*Entrada;
+std::string	Prefijo(Ruta);
+
+/* Armar el prefijo de cada ruta */
+if ( (Prefijo.empty()) || (Prefijo[Prefijo.size()-1]!='/') )
+	Prefijo+='/';
+
+/* Tomar los archivos */
+while ( (Entrada=readdir(Directorio)) != NULL )
+    {
+	if (Entrada->d_name[0]=='.')
+		continue;
+	if ( (Entrada->d_type!=DT_REG) && (Entrada->d_type!=DT_LNK) && (Entrada->d_type!=DT_UNKNOWN) )
+		continue;
+	Rutas.push_back(Prefijo+Entrada->d_name);
+    }
+closedir(Directorio);
+
+/* readdir() no garantiza ningún orden */
+std::sort(Rutas.begin(), Rutas.end());
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TLoteImagenes :: CargarLista							*
+ *																	*
+ * OBJETIVO: Esta función agrega a la lista las imágenes nombradas en un archivo de texto, una por línea.				*
+ *																	*
+ * ENTRADA: Ruta: Ruta al archivo con la lista.												*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *																	*
+ * OBSERVACIONES: Se saltean las líneas en blanco y las que empiezan con '#', igual que en el archivo de tests.				*
+ *																	*
+ ****************************************************************************************************************************************/
+int TLoteImagenes::CargarLista(const char *Ruta)
+{
+char	aux[PATH_MAX+2];
+char	*p;
+FILE	*f;
+
+/* Abrir la lista */
+if ( (f=fopen(Ruta, "r")) == NULL )
+	return(CODERROR_ARCHIVO_INEXISTENTE);
+
+/* Tomar cada línea */
+while (fgets(aux, sizeof(aux), f))
+    {
+	/* Sacar los caracteres de fin de línea */
+	p=aux+strlen(aux)-1;
+	while ( (p>=aux) && ((*p=='\r')||(*p=='\n')) )
+		*p--='\0';
+
+	/* Si es una línea en blanco o un comentario, saltearla */
+	if ( (aux[0]=='\0') || (aux[0]=='#') )
+		continue;
+
+	Rutas.push_back(aux);
+    }
+fclose(f);
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TLoteImagenes :: Trabajar							*
+ *																	*
+ * OBJETIVO: Esta función es el cuerpo de cada trabajador: toma imágenes de la lista hasta agotarla y emite sus informes.		*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TLoteImagenes::Trabajar(void)
+{
+TAnalizadorFS	Analizador;
+unsigned	i;
+
+/* El analizador se reutiliza para todas las imágenes que toma este trabajador */
+Analizador.UsarCacheBloques(PresupuestoCache);
+Analizador.UsarFormato(Formato);
+Analizador.UsarHilos(1);
+Analizador.UsarMetricas(Metricas);
+while ( (i=SiguienteImagen.fetch_add(1)) < Rutas.size() )
+    {
+	Resultados[i]=AnalizarImagen(Analizador, i);
+	Emitir(i);
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TLoteImagenes :: AnalizarImagen							*
+ *																	*
+ * OBJETIVO: Esta función analiza una imágen de la lista dejando su informe en memoria.							*
+ *																	*
+ * ENTRADA: Analizador: Analizador propio del hilo que llama.										*
+ *	    Indice: Posición de la imágen en la lista.											*
+ *																	*
+ * SALIDA: En el nombre de la función el resultado del análisis de la imágen.								*
+ *																	*
+ ****************************************************************************************************************************************/
+int TLoteImagenes::AnalizarImagen(TAnalizadorFS &Analizador, unsigned Indice)
+{
+char	*Buffer = NULL;
+size_t	Longitud = 0;
+FILE	*f;
+int	CodError;
+
+/* Abrir un archivo en memoria para el informe */
+if ( (f=open_memstream(&Buffer, &Longitud)) == NULL )
+	return(CODERROR_FALTA_MEMORIA);
+
+/* Analizar la imágen, escribiendo el informe ahí (los formatos de registros ya marcan el principio y el fin de cada imágen) */
+if (Formato==fmtTEXTO)
+	fprintf(f, "==> %s <==\n", Rutas[Indice].c_str());
+Analizador.UsarSalida(f);
+CodError=Analizador.Ejecutar(Rutas[Indice].c_str());
+Analizador.UsarSalida(stdout);
+if (Formato==fmtTEXTO)
+	fprintf(f, "La imágen termina con resultado %d.\r\n\n", CodError);
+
+/* Guardar el informe */
+fclose(f);
+Informes[Indice].assign(Buffer, Longitud);
+free(Buffer);
+
+/* Salir */
+return(CodError);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TLoteImagenes :: Emitir							*
+ *																	*
+ * OBJETIVO: Esta función marca como terminado un informe y emite todos los que ya pueden salir en el orden de la lista.		*
+ *																	*
+ * ENTRADA: Indice: Posición en la lista de la imágen que se terminó de analizar.							*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TLoteImagenes::Emitir(unsigned Indice)
+{
+std::lock_guard<std::mutex>	Lock(MutexEmision);
+
+/* Marcarlo como terminado */
+Terminados[Indice]=true;
+
+/* Emitir los informes consecutivos que estén listos, liberando su memoria */
+while ( (SiguienteAEmitir<Rutas.size()) && (Terminados[SiguienteAEmitir]) )
+    {
+	fwrite(Informes[SiguienteAEmitir].data(), 1, Informes[SiguienteAEmitir].size(), stdout);
+	std::string().swap(Informes[SiguienteAEmitir]);
+	SiguienteAEmitir++;
+    }
+fflush(stdout);
+}
\ No newline at end of file
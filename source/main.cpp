@@ -3,17 +3,66 @@
 int main(int argc, char *argv[])
 {
 int		CodError;
+int		Opcion;
+bool		ModoLote = false;
+TFormatoSalida	Formato = fmtTEXTO;
 TAnalizadorFS	AnalizadorFS;
+TLoteImagenes	LoteImagenes;
+
+/* Analizar las opciones */
+while ( (Opcion=getopt(argc, argv, "c:bj:f:m")) != -1 )
+    {
+	switch (Opcion)
+	    {
+		case 'c':
+			/* Leer la imágen bajo demanda con una cache de los megabytes indicados */
+			AnalizadorFS.UsarCacheBloques((__u64)atoll(optarg)*1024*1024);
+			LoteImagenes.UsarCacheBloques((__u64)atoll(optarg)*1024*1024);
+			break;
+		case 'b':
+			/* El parámetro es un directorio o una lista de imágenes a analizar en paralelo */
+			ModoLote=true;
+			break;
+		case 'j':
+			/* Cantidad de imágenes a analizar a la vez en modo lote (o de hilos para recorrer árboles con FIND y DU) */
+			LoteImagenes.UsarHilos((unsigned)atoi(optarg));
+			AnalizadorFS.UsarHilos((unsigned)atoi(optarg));
+			break;
+		case 'f':
+			/* Formato del informe: texto, jsonl o binario */
+			if (!strcasecmp(optarg, "texto"))
+				Formato=fmtTEXTO;
+			else if (!strcasecmp(optarg, "jsonl"))
+				Formato=fmtJSONL;
+			else if (!strcasecmp(optarg, "binario"))
+				Formato=fmtBINARIO;
+			else
+				return(CODERROR_PARAMETROS_INVALIDOS);
+			AnalizadorFS.UsarFormato(Formato);
+			LoteImagenes.UsarFormato(Formato);
+			break;
+		case 'm':
+			/* Medir cada comando de tests y mostrar un resumen al final de cada imágen */
+			AnalizadorFS.UsarMetricas(true);
+			LoteImagenes.UsarMetricas(true);
+			break;
+		default:
+			return(CODERROR_PARAMETROS_INVALIDOS);
+	    }
+    }
 
 /* Analizar los parámetros */
-if (argc!=2)
+if (optind!=argc-1)
 	return(CODERROR_PARAMETROS_INVALIDOS);
 
-/* Ejeuctar la clase que busca el driver adecuado y luego analiza la imágen */
-CodError=AnalizadorFS.Ejecutar(argv[1]);
+/* Ejeuctar la clase que busca el driver adecuado y luego analiza la imágen (o todas las del lote) */
+if (!ModoLote)
+	CodError=AnalizadorFS.Ejecutar(argv[optind]);
+else if ( (CodError=LoteImagenes.CargarImagenes(argv[optind])) == CODERROR_NINGUNO )
+	CodError=LoteImagenes.Ejecutar();
 
-/* Imprimir un mensaje final */
-printf("El programa termina con resultado %d.\r\n", CodError);
+/* Imprimir un mensaje final (fuera de stdout si ahí van registros) */
+fprintf(Formato==fmtTEXTO ? stdout : stderr, "El programa termina con resultado %d.\r\n", CodError);
 
 /* Salir */
 return(CodError);
@@ -0,0 +1,315 @@
+﻿#include "all_heads.h"
+
+
+/************************
+ *			*
+ *  Variables globales	*
+ *			*
+ ************************/
+/* Contador del medidor al que se cargan las alocaciones de este hilo (NULL si no se está midiendo nada) */
+static thread_local std::atomic<__u64>	*CuentaHilo=NULL;
+
+
+/************************
+ *			*
+ *     Funciones	*
+ *			*
+ ************************/
+/* Aloca con malloc() (o posix_memalign() si pide más alineación) contando la alocación, igual que la biblioteca ante la falta de memoria */
+static void *Alocar(size_t Longitud, size_t Alineacion)
+{
+std::new_handler	Manejador;
+void			*p;
+
+/* Contar */
+if (CuentaHilo)
+	CuentaHilo->fetch_add(1, std::memory_order_relaxed);
+
+/* Alocar reintentando mientras haya un new_handler */
+if (!Longitud)
+	Longitud=1;
+while (true)
+    {
+	if (Alineacion<=__STDCPP_DEFAULT_NEW_ALIGNMENT__)
+		p=malloc(Longitud);
+	else if (posix_memalign(&p, Alineacion, Longitud)!=0)
+		p=NULL;
+	if (p)
+		return(p);
+	if ( (Manejador=std::get_new_handler()) == NULL )
+		throw std::bad_alloc();
+	Manejador();
+    }
+}
+
+/* Versión que no tira excepciones */
+static void *AlocarSinExcepcion(size_t Longitud, size_t Alineacion) noexcept
+{
+try
+    {
+	return(Alocar(Longitud, Alineacion));
+    }
+catch (...)
+    {
+	return(NULL);
+    }
+}
+
+/* Reemplazan a toda la familia new/delete de la biblioteca, así todo lo alocado con new se libera con free() y se puede contar */
+void *operator new(size_t Longitud)									{ return(Alocar(Longitud, 0)); }
+void *operator new[](size_t Longitud)									{ return(Alocar(Longitud, 0)); }
+void *operator new(size_t Longitud, std::align_val_t Alineacion)					{ return(Alocar(Longitud, (size_t)Alineacion)); }
+void *operator new[](size_t Longitud, std::align_val_t Alineacion)					{ return(Alocar(Longitud, (size_t)Alineacion)); }
+void *operator new(size_t Longitud, const std::nothrow_t &) noexcept					{ return(AlocarSinExcepcion(Longitud, 0)); }
+void *operator new[](size_t Longitud, const std::nothrow_t &) noexcept					{ return(AlocarSinExcepcion(Longitud, 0)); }
+void *operator new(size_t Longitud, std::align_val_t Alineacion, const std::nothrow_t &) noexcept	{ return(AlocarSinExcepcion(Longitud, (size_t)Alineacion)); }
+void *operator new[](size_t Longitud, std::align_val_t Alineacion, const std::nothrow_t &) noexcept	{ return(AlocarSinExcepcion(Longitud, (size_t)Alineacion)); }
+void operator delete(void *p) noexcept									{ free(p); }
+void operator delete[](void *p) noexcept								{ free(p); }
+void operator delete(void *p, size_t) noexcept								{ free(p); }
+void operator delete[](void *p, size_t) noexcept							{ free(p); }
+void operator delete(void *p, std::align_val_t) noexcept						{ free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept						{ free(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept					{ free(p); }
+void operator delete[](void *p, size_t, std::align_val_t) noexcept					{ free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept						{ free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept					{ free(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept			{ free(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept			{ free(p); }
+
+
+/********************************
+ *				*
+ *   Clase TMedidorComandos	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *						  TMedidorComandos :: TMedidorComandos							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TMedidorComandos::TMedidorComandos()
+{
+/* Inicializar variables */
+memset(&Inicio, 0, sizeof(Inicio));
+memset(&ContadoresInicio, 0, sizeof(ContadoresInicio));
+AlocacionesInicio=0;
+Alocaciones=0;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TMedidorComandos :: ~TMedidorComandos							*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TMedidorComandos::~TMedidorComandos()
+{
+/* Que este hilo no siga contando en un medidor que ya no existe */
+if (CuentaHilo==&Alocaciones)
+	CuentaHilo=NULL;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TMedidorComandos :: CuentaDelHilo							*
+ *																	*
+ * OBJETIVO: Esta función devuelve el contador de alocaciones en el que se está contando desde el hilo actual.				*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función el contador, o NULL si el hilo no está midiendo nada.						*
+ *																	*
+ ****************************************************************************************************************************************/
+std::atomic<__u64> *TMedidorComandos::CuentaDelHilo(void)
+{
+return(CuentaHilo);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TMedidorComandos :: UsarCuentaEnHilo							*
+ *																	*
+ * OBJETIVO: Esta función fija el contador de alocaciones del hilo actual.								*
+ *																	*
+ * ENTRADA: Cuenta: Contador a usar, o NULL para dejar de contar.									*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: La usa el pool de hilos para que las tareas que hacen sus hilos se cuenten en el medidor del hilo que las pidió.	*
+ *																	*
+ ****************************************************************************************************************************************/
+void TMedidorComandos::UsarCuentaEnHilo(std::atomic<__u64> *Cuenta)
+{
+CuentaHilo=Cuenta;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TMedidorComandos :: Vaciar							*
+ *																	*
+ * OBJETIVO: Esta función descarta las mediciones juntadas hasta ahora.									*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TMedidorComandos::Vaciar(void)
+{
+Comandos.clear();
+Mediciones.clear();
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TMedidorComandos :: Empezar							*
+ *																	*
+ * OBJETIVO: Esta función toma los valores iniciales antes de ejecutar un comando.							*
+ *																	*
+ * ENTRADA: Contadores: Contadores del driver en este momento.										*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Hasta Terminar() se cuentan las alocaciones de este hilo y las de las tareas que haga el pool de hilos para él.	*
+ *																	*
+ ****************************************************************************************************************************************/
+void TMedidorComandos::Empezar(const TContadoresDriver &Contadores)
+{
+ContadoresInicio=Contadores;
+AlocacionesInicio=Alocaciones.load(std::memory_order_relaxed);
+CuentaHilo=&Alocaciones;
+clock_gettime(CLOCK_MONOTONIC, &Inicio);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TMedidorComandos :: Terminar							*
+ *																	*
+ * OBJETIVO: Esta función registra lo que costó el comando que acaba de terminar y lo muestra.						*
+ *																	*
+ * ENTRADA: Comando: Nombre del comando (DIR, CAT, etc), se agrupa sin distinguir mayúsculas.						*
+ *	    Contadores: Contadores del driver en este momento.										*
+ *	    Salida: Donde mostrar la medición.												*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TMedidorComandos::Terminar(const char *Comando, const TContadoresDriver &Contadores, TSalida *Salida)
+{
+struct timespec		Fin;
+TMedicionComando	Medicion;
+std::string		Tipo;
+
+/* Calcular las diferencias antes de alocar nada */
+clock_gettime(CLOCK_MONOTONIC, &Fin);
+CuentaHilo=NULL;
+Medicion.Alocaciones=Alocaciones.load(std::memory_order_relaxed)-AlocacionesInicio;
+Medicion.Nanosegundos=(__u64)(Fin.tv_sec-Inicio.tv_sec)*1000000000ULL+Fin.tv_nsec-Inicio.tv_nsec;
+Medicion.Sectores=Contadores.Sectores-ContadoresInicio.Sectores;
+Medicion.Bytes=Contadores.Bytes-ContadoresInicio.Bytes;
+
+/* Guardarla con las de su tipo */
+for (; *Comando; Comando++)
+	Tipo+=(char)toupper((unsigned char)*Comando);
+if (Mediciones.find(Tipo)==Mediciones.end())
+	Comandos.push_back(Tipo);
+Mediciones[Tipo].push_back(Medicion);
+
+/* Mostrarla */
+Salida->Printf("\t[%s: %.3f ms, %llu sectores, %llu bytes copiados, %llu alocaciones]\n", Tipo.c_str(),
+	       Medicion.Nanosegundos/1000000.0, Medicion.Sectores, Medicion.Bytes, Medicion.Alocaciones);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						   TMedidorComandos :: MostrarResumen							*
+ *																	*
+ * OBJETIVO: Esta función muestra, por tipo de comando, los percentiles del tiempo, el caudal y el promedio de cada contador.		*
+ *																	*
+ * ENTRADA: Salida: Donde mostrar el resumen.												*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TMedidorComandos::MostrarResumen(TSalida *Salida)
+{
+std::vector<__u64>	Tiempos;
+__u64			TotalTiempo, TotalSectores, TotalBytes, TotalAlocaciones;
+unsigned		i, j, n;
+
+/* Si no se midió nada no hay nada que mostrar */
+if (Comandos.empty())
+	return;
+
+/* Encabezado */
+Salida->Printf("Métricas por comando:\n");
+Salida->Printf("\tComando      Cant.   p50 (ms)   p95 (ms)   p99 (ms)       MB/s  Sectores/cmd     Bytes/cmd  Aloc./cmd\n");
+
+/* Una línea por tipo, en el orden en que aparecieron */
+for (i=0; i<Comandos.size(); i++)
+    {
+	const std::vector<TMedicionComando> &Lista=Mediciones[Comandos[i]];
+
+	/* Juntar los tiempos y los totales */
+	n=(unsigned)Lista.size();
+	Tiempos.clear();
+	TotalTiempo=TotalSectores=TotalBytes=TotalAlocaciones=0;
+	for (j=0; j<n; j++)
+	    {
+		Tiempos.push_back(Lista[j].Nanosegundos);
+		TotalTiempo+=Lista[j].Nanosegundos;
+		TotalSectores+=Lista[j].Sectores;
+		TotalBytes+=Lista[j].Bytes;
+		TotalAlocaciones+=Lista[j].Alocaciones;
+	    }
+
+	/* Mostrarlos */
+	Salida->Printf("\t%-10s %7u %10.3f %10.3f %10.3f %10.1f %13llu %13llu %10llu\n", Comandos[i].c_str(), n,
+		       Percentil(Tiempos, 50)/1000000.0, Percentil(Tiempos, 95)/1000000.0, Percentil(Tiempos, 99)/1000000.0,
+		       TotalTiempo ? (TotalBytes*1000.0)/TotalTiempo : 0.0,
+		       TotalSectores/n, TotalBytes/n, TotalAlocaciones/n);
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TMedidorComandos :: Percentil							*
+ *																	*
+ * OBJETIVO: Esta función calcula un percentil por rango más cercano.									*
+ *																	*
+ * ENTRADA: Valores: Valores medidos (se ordenan).											*
+ *	    Porcentaje: Percentil pedido (1 a 100).											*
+ *																	*
+ * SALIDA: En el nombre de la función el menor valor que es mayor o igual que el Porcentaje% de los valores.				*
+ *																	*
+ ****************************************************************************************************************************************/
+__u64 TMedidorComandos::Percentil(std::vector<__u64> &Valores, unsigned Porcentaje)
+{
+size_t	Rango;
+
+if (Valores.empty())
+	return(0);
+std::sort(Valores.begin(), Valores.end());
+Rango=(Porcentaje*Valores.size()+99)/100;
+return(Valores[Rango ? Rango-1 : 0]);
+}
\ No newline at end of file
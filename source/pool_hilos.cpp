@@ -0,0 +1,234 @@
+﻿#include "all_heads.h"
+
+
+/********************************
+ *				*
+ *	 Clase TPoolHilos	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *							TPoolHilos :: TPoolHilos							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada y lanzar los hilos de trabajo.								*
+ *																	*
+ * ENTRADA: NroHilos: Cantidad total de hilos que ejecutan tareas, incluyendo al que llama a Ejecutar() (0 usa uno por núcleo).		*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TPoolHilos::TPoolHilos(unsigned NroHilos)
+{
+unsigned	i;
+
+/* Inicializar variables */
+Tarea=NULL;
+CuentaAlocaciones=NULL;
+NroTareas=0;
+Siguiente=0;
+Terminadas=0;
+Activos=0;
+Generacion=0;
+Terminar=false;
+
+/* Determinar la cantidad de hilos */
+if (NroHilos==0)
+	NroHilos=std::thread::hardware_concurrency();
+if (NroHilos==0)
+	NroHilos=1;
+
+/* El hilo que llama a Ejecutar() también trabaja, lanzar el resto */
+for(i=1;i<NroHilos;i++)
+	Hilos.push_back(std::thread(&TPoolHilos::Trabajar, this));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TPoolHilos :: ~TPoolHilos							*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados, esperando que terminen todos los hilos.								*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TPoolHilos::~TPoolHilos()
+{
+unsigned	i;
+
+/* Avisar a los hilos que terminen */
+    {
+	std::lock_guard<std::mutex> Lock(Mutex);
+	Terminar=true;
+    }
+HayLote.notify_all();
+
+/* Esperarlos */
+for(i=0;i<Hilos.size();i++)
+	Hilos[i].join();
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TPoolHilos :: NroHilos								*
+ *																	*
+ * OBJETIVO: Esta función devuelve la cantidad de hilos que ejecutan tareas.								*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función la cantidad de hilos, incluyendo al que llama a Ejecutar().					*
+ *																	*
+ ****************************************************************************************************************************************/
+unsigned TPoolHilos::NroHilos(void)
+{
+return(Hilos.size()+1);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TPoolHilos :: Ejecutar								*
+ *																	*
+ * OBJETIVO: Esta función ejecuta en paralelo las tareas 0..NroTareas-1 y retorna cuando terminaron todas.				*
+ *																	*
+ * ENTRADA: NroTareas: Cantidad de tareas del lote.											*
+ *	    Tarea: Función a ejecutar para cada índice de tarea.									*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Si se llama desde varios hilos a la vez los lotes se ejecutan uno después del otro. Las alocaciones de las tareas se	*
+ *		  cuentan en el medidor de comandos del hilo que llama, si tiene uno.							*
+ *																	*
+ ****************************************************************************************************************************************/
+void TPoolHilos::Ejecutar(unsigned NroTareas, const TTareaPool &Tarea)
+{
+std::lock_guard<std::mutex>	LockLote(MutexLote);
+
+/* Lotes vacíos o sin hilos extra se ejecutan directamente */
+if ( (NroTareas<=1) || (Hilos.empty()) )
+    {
+	for(unsigned i=0;i<NroTareas;i++)
+		Tarea(i);
+	return;
+    }
+
+/* Publicar el lote */
+    {
+	std::lock_guard<std::mutex> Lock(Mutex);
+	TPoolHilos::Tarea=&Tarea;
+	TPoolHilos::NroTareas=NroTareas;
+	CuentaAlocaciones=TMedidorComandos::CuentaDelHilo();
+	Siguiente=0;
+	Terminadas=0;
+	Generacion++;
+    }
+HayLote.notify_all();
+
+/* Trabajar yo también */
+TomarTareas(Tarea, NroTareas, TMedidorComandos::CuentaDelHilo());
+
+/* Esperar a que terminen las tareas que tomaron los otros hilos y que ninguno siga mirando este lote */
+std::unique_lock<std::mutex> Lock(Mutex);
+LoteTerminado.wait(Lock, [this]{ return( (Terminadas==TPoolHilos::NroTareas) && (!Activos) ); });
+TPoolHilos::Tarea=NULL;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							 TPoolHilos :: Trabajar								*
+ *																	*
+ * OBJETIVO: Esta función es el cuerpo de cada hilo de trabajo, espera lotes nuevos y toma tareas de ellos.				*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Mientras toma tareas el hilo queda contado en Activos, y Ejecutar() no retorna hasta que no quede ninguno.		*
+ *																	*
+ ****************************************************************************************************************************************/
+void TPoolHilos::Trabajar(void)
+{
+const TTareaPool	*TareaLote;
+std::atomic<__u64>	*CuentaLote;
+unsigned		GeneracionVista = 0, TareasLote;
+
+while (true)
+    {
+	/* Esperar un lote nuevo o el pedido de terminar, y copiar los datos del lote sin soltar el mutex */
+	    {
+		std::unique_lock<std::mutex> Lock(Mutex);
+		HayLote.wait(Lock, [&]{ return( (Terminar) || (Generacion!=GeneracionVista) ); });
+		if (Terminar)
+			return;
+		GeneracionVista=Generacion;
+
+		/* Si el lote ya terminó sin este hilo no queda nada que tomar */
+		if (!Tarea)
+			continue;
+		TareaLote=Tarea;
+		TareasLote=NroTareas;
+		CuentaLote=CuentaAlocaciones;
+		Activos++;
+	    }
+
+	/* Tomar tareas hasta que no queden */
+	TomarTareas(*TareaLote, TareasLote, CuentaLote);
+
+	/* Avisar que ya no uso el lote */
+	    {
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Activos--;
+		if (!Activos)
+			LoteTerminado.notify_all();
+	    }
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TPoolHilos :: TomarTareas							*
+ *																	*
+ * OBJETIVO: Esta función toma y ejecuta tareas del lote actual hasta que no queden por tomar.						*
+ *																	*
+ * ENTRADA: Tarea: Función del lote.													*
+ *	    NroTareas: Cantidad de tareas del lote.											*
+ *	    CuentaAlocaciones: Contador del medidor de quien pidió el lote (NULL si no tiene).						*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Recibe los datos del lote copiados bajo el mutex, nunca lee los de la clase: el lote no se da por terminado (ni se	*
+ *		  publica otro) mientras algún hilo de trabajo siga acá.								*
+ *																	*
+ ****************************************************************************************************************************************/
+void TPoolHilos::TomarTareas(const TTareaPool &Tarea, unsigned NroTareas, std::atomic<__u64> *CuentaAlocaciones)
+{
+unsigned		i, Hechas;
+std::atomic<__u64>	*CuentaPropia;
+
+/* Contar las alocaciones en el medidor de quien pidió el lote */
+CuentaPropia=TMedidorComandos::CuentaDelHilo();
+TMedidorComandos::UsarCuentaEnHilo(CuentaAlocaciones);
+
+/* Tomar índices hasta agotarlos */
+Hechas=0;
+while ( (i=Siguiente.fetch_add(1)) < NroTareas )
+    {
+	Tarea(i);
+	Hechas++;
+    }
+TMedidorComandos::UsarCuentaEnHilo(CuentaPropia);
+
+/* Informar cuántas terminé */
+if (Hechas>0)
+    {
+	std::lock_guard<std::mutex> Lock(Mutex);
+	Terminadas+=Hechas;
+	if (Terminadas==NroTareas)
+		LoteTerminado.notify_all();
+    }
+}
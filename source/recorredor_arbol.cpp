@@ -0,0 +1,510 @@
+﻿#include "all_heads.h"
+
+
+/********************************
+ *				*
+ *   Clase TRecorredorArbol	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *						  TRecorredorArbol :: TRecorredorArbol							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Driver: Driver con la imágen a recorrer (sigue siendo propiedad del llamador).						*
+ *	    NroHilos: Cantidad de hilos a usar (0 usa uno por núcleo).									*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Si la fuente de la imágen no admite lecturas concurrentes se recorre con un solo hilo.				*
+ *																	*
+ ****************************************************************************************************************************************/
+TRecorredorArbol::TRecorredorArbol(TDriverBase *Driver, unsigned NroHilos)
+{
+/* Inicializar variables */
+TRecorredorArbol::Driver=Driver;
+TRecorredorArbol::NroHilos=NroHilos;
+Colas=NULL;
+NodosPendientes=0;
+Cortar=false;
+CodError=CODERROR_NINGUNO;
+Totales=NULL;
+
+/* Determinar la cantidad de hilos */
+if (TRecorredorArbol::NroHilos==0)
+	TRecorredorArbol::NroHilos=std::thread::hardware_concurrency();
+if ( (TRecorredorArbol::NroHilos==0) || (!Driver->AdmiteHilos()) )
+	TRecorredorArbol::NroHilos=1;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TRecorredorArbol :: ~TRecorredorArbol							*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TRecorredorArbol::~TRecorredorArbol()
+{
+Liberar();
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TRecorredorArbol :: UsarPredicado							*
+ *																	*
+ * OBJETIVO: Esta función elige qué entradas se informan al visitante (estilo find).							*
+ *																	*
+ * ENTRADA: Predicado: Filtro a aplicar (vacío para informar todas).									*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Se llama desde varios hilos a la vez, sin sincronizar.								*
+ *																	*
+ ****************************************************************************************************************************************/
+void TRecorredorArbol::UsarPredicado(const TPredicadoArbol &Predicado)
+{
+TRecorredorArbol::Predicado=Predicado;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TRecorredorArbol :: UsarVisitante							*
+ *																	*
+ * OBJETIVO: Esta función elige a quién se informa cada entrada encontrada.								*
+ *																	*
+ * ENTRADA: Visitante: Función a llamar con cada entrada que pasa el filtro.								*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Se llama desde los hilos del recorrido, pero nunca desde dos a la vez.						*
+ *																	*
+ ****************************************************************************************************************************************/
+void TRecorredorArbol::UsarVisitante(const TVisitanteArbol &Visitante)
+{
+TRecorredorArbol::Visitante=Visitante;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TRecorredorArbol :: UsarResumen							*
+ *																	*
+ * OBJETIVO: Esta función elige a quién se informan los totales de cada directorio (estilo du).						*
+ *																	*
+ * ENTRADA: Resumen: Función a llamar con los totales de cada directorio.								*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Cada directorio se informa después que todos sus subdirectorios. Nunca se llama desde dos hilos a la vez.		*
+ *																	*
+ ****************************************************************************************************************************************/
+void TRecorredorArbol::UsarResumen(const TResumenArbol &Resumen)
+{
+TRecorredorArbol::Resumen=Resumen;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TRecorredorArbol :: Recorrer							*
+ *																	*
+ * OBJETIVO: Esta función recorre recursivamente un directorio, informando las entradas y los totales a medida que los encuentra.	*
+ *																	*
+ * ENTRADA: Ruta: Ruta absoluta al directorio raíz del recorrido.									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Totales: Totales de todo el árbol (de lo recorrido hasta el corte, si el visitante o un error lo cortó).			*
+ *																	*
+ * OBSERVACIONES: Cada hilo procesa los subdirectorios que encuentra y, cuando se queda sin trabajo, le roba a los demás los		*
+ *		  directorios más cercanos a la raíz (que suelen ser los de subárboles más grandes). Los objetos se reconocen por	*
+ *		  su identificador: un directorio ya visto es un ciclo y no se vuelve a entrar, un archivo ya visto es un hard link	*
+ *		  y no se vuelve a sumar.												*
+ *																	*
+ ****************************************************************************************************************************************/
+int TRecorredorArbol::Recorrer(const char *Ruta, TTotalesArbol &Totales)
+{
+TManejadorArchivo	Manejador;
+std::string		Raiz;
+TNodoArbol		*Nodo;
+unsigned		i, j;
+int			CodError;
+
+/* Inicializar */
+memset(&Totales, 0, sizeof(Totales));
+Liberar();
+Colas=new TColaRecorrido[NroHilos];
+NodosPendientes=0;
+Cortar=false;
+TRecorredorArbol::CodError=CODERROR_NINGUNO;
+TRecorredorArbol::Totales=&Totales;
+
+/* Ubicar la raíz, que tiene que ser un directorio */
+CodError=Driver->Abrir(Ruta, Manejador);
+if (CodError==CODERROR_ARCHIVO_INEXISTENTE)
+	return(CODERROR_DIRECTORIO_INEXISTENTE);
+if (CodError!=CODERROR_NINGUNO)
+	return(CodError);
+if (!(Manejador.Flags&fedDIRECTORIO))
+	return(CODERROR_DIRECTORIO_INEXISTENTE);
+
+/* Normalizar la ruta (sin '/' al final, salvo la raíz) */
+Raiz.assign(Ruta);
+while ( (Raiz.size()>1) && (Raiz[Raiz.size()-1]=='/') )
+	Raiz.erase(Raiz.size()-1);
+
+/* Ponerla en la cola del primer hilo y largar a todos */
+Visto(Manejador);
+Agregar(0, NULL, Raiz.c_str(), Manejador);
+    {
+	TPoolHilos Pool(NroHilos);
+	Pool.Ejecutar(Pool.NroHilos(), [this](unsigned Hilo) { Trabajar(Hilo); });
+    }
+
+/* Si se cortó antes de completar la raíz (el primer nodo creado), cada directorio completo ya se sumó a su padre: lo recorrido
+   está en los incompletos */
+if (Colas[0].Creados[0]->Pendientes>0)
+	for(i=0;i<NroHilos;i++)
+		for(j=0;j<Colas[i].Creados.size();j++)
+		    {
+			Nodo=Colas[i].Creados[j];
+			if (Nodo->Pendientes==0)
+				continue;
+			Totales.Bytes+=Nodo->Bytes;
+			Totales.Archivos+=Nodo->Archivos;
+			Totales.Directorios+=Nodo->Directorios;
+			Totales.Repetidos+=Nodo->Repetidos;
+		    }
+
+/* Salir */
+TRecorredorArbol::Totales=NULL;
+return(TRecorredorArbol::CodError);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TRecorredorArbol :: Trabajar							*
+ *																	*
+ * OBJETIVO: Esta función es el cuerpo de cada hilo del recorrido: procesa directorios hasta que no quede ninguno pendiente.		*
+ *																	*
+ * ENTRADA: Hilo: Índice del hilo (y de su cola).											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TRecorredorArbol::Trabajar(unsigned Hilo)
+{
+TNodoArbol	*Nodo;
+
+/* Mientras haya directorios sin procesar en alguna cola (o siendo procesados, que pueden agregar más) */
+while ( (!Cortar) && (NodosPendientes>0) )
+    {
+	if ( (Nodo=Tomar(Hilo)) == NULL )
+	    {
+		std::this_thread::yield();
+		continue;
+	    }
+	ProcesarDirectorio(Hilo, Nodo);
+	NodosPendientes--;
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TRecorredorArbol :: Tomar							*
+ *																	*
+ * OBJETIVO: Esta función toma el próximo directorio a procesar: el último agregado a la cola propia o, si está vacía, el primero	*
+ *	     de la cola de otro hilo.													*
+ *																	*
+ * ENTRADA: Hilo: Índice del hilo que toma.												*
+ *																	*
+ * SALIDA: En el nombre de la función el directorio, o NULL si no hay ninguno en las colas.						*
+ *																	*
+ ****************************************************************************************************************************************/
+TNodoArbol *TRecorredorArbol::Tomar(unsigned Hilo)
+{
+TNodoArbol	*Nodo;
+unsigned	i, Victima;
+
+/* Primero la cola propia, en profundidad */
+    {
+	std::lock_guard<std::mutex> Lock(Colas[Hilo].Mutex);
+	if (!Colas[Hilo].Nodos.empty())
+	    {
+		Nodo=Colas[Hilo].Nodos.back();
+		Colas[Hilo].Nodos.pop_back();
+		return(Nodo);
+	    }
+    }
+
+/* Después robar, empezando por el hilo siguiente para no ir todos contra el mismo */
+for(i=1;i<NroHilos;i++)
+    {
+	Victima=(Hilo+i)%NroHilos;
+	std::lock_guard<std::mutex> Lock(Colas[Victima].Mutex);
+	if (!Colas[Victima].Nodos.empty())
+	    {
+		Nodo=Colas[Victima].Nodos.front();
+		Colas[Victima].Nodos.pop_front();
+		return(Nodo);
+	    }
+    }
+
+/* No hay nada */
+return(NULL);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TRecorredorArbol :: Agregar							*
+ *																	*
+ * OBJETIVO: Esta función agrega un directorio a recorrer a la cola de un hilo.								*
+ *																	*
+ * ENTRADA: Hilo: Índice del hilo que lo encontró.											*
+ *	    Padre: Directorio que lo contiene (NULL para la raíz del recorrido).							*
+ *	    Ruta: Ruta del directorio.													*
+ *	    Manejador: Manejador del directorio.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TRecorredorArbol::Agregar(unsigned Hilo, TNodoArbol *Padre, const char *Ruta, const TManejadorArchivo &Manejador)
+{
+TNodoArbol	*Nodo;
+
+/* Armar el nodo: queda pendiente su propio listado */
+Nodo=new TNodoArbol;
+Nodo->Ruta.assign(Ruta);
+Nodo->Manejador=Manejador;
+Nodo->Padre=Padre;
+Nodo->Pendientes=1;
+Nodo->Bytes=0;
+Nodo->Archivos=0;
+Nodo->Directorios=0;
+Nodo->Repetidos=0;
+
+/* El padre no se completa hasta que se complete éste */
+if (Padre)
+	Padre->Pendientes++;
+
+/* Encolarlo */
+NodosPendientes++;
+std::lock_guard<std::mutex> Lock(Colas[Hilo].Mutex);
+Colas[Hilo].Creados.push_back(Nodo);
+Colas[Hilo].Nodos.push_back(Nodo);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						 TRecorredorArbol :: ProcesarDirectorio							*
+ *																	*
+ * OBJETIVO: Esta función lista un directorio, informa sus entradas, suma sus archivos y encola sus subdirectorios.			*
+ *																	*
+ * ENTRADA: Hilo: Índice del hilo que lo procesa.											*
+ *	    Nodo: Directorio a procesar.												*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Un error del driver corta todo el recorrido.										*
+ *																	*
+ ****************************************************************************************************************************************/
+void TRecorredorArbol::ProcesarDirectorio(unsigned Hilo, TNodoArbol *Nodo)
+{
+TManejadorArchivo	Manejador;
+std::string		Ruta;
+bool			Repetida;
+int			CodError;
+
+/* Recorrer las entradas a medida que el driver las decodifica */
+CodError=Driver->RecorrerDirectorio(Nodo->Manejador, [&](const TEntradaDirectorio &Entrada)
+    {
+	/* El propio directorio y el padre no son parte del árbol */
+	if ( (Entrada.Nombre==".") || (Entrada.Nombre=="..") )
+		return(true);
+
+	/* Reconocer lo que ya se vio por otro nombre */
+	Driver->ManejadorEntrada(Entrada, Manejador);
+	Repetida=!Visto(Manejador);
+
+	/* Sumar y seguir por los subdirectorios (un directorio repetido es un ciclo, no se entra) */
+	if (Repetida)
+		Nodo->Repetidos++;
+	else if (Entrada.Flags&fedDIRECTORIO)
+	    {
+		/* Un nombre que no es un único componente (imágen dañada) no arma una ruta, se informa pero no se entra */
+		Nodo->Directorios++;
+		if (NombreValido(Entrada.Nombre))
+		    {
+			Ruta.assign(Nodo->Ruta);
+			if (Ruta.size()>1)
+				Ruta+='/';
+			Ruta+=Entrada.Nombre;
+			Agregar(Hilo, Nodo, Ruta.c_str(), Manejador);
+		    }
+	    }
+	else
+	    {
+		Nodo->Archivos++;
+		Nodo->Bytes+=Entrada.Bytes;
+	    }
+
+	/* Informar la entrada si pasa el filtro */
+	if ( (!Visitante) || ((Predicado) && (!Predicado(Nodo->Ruta.c_str(), Entrada))) )
+		return(!Cortar);
+	std::lock_guard<std::mutex> Lock(MutexLlamadas);
+	if ( (!Cortar) && (!Visitante(Nodo->Ruta.c_str(), Entrada, Repetida)) )
+		Cortar=true;
+	return(!Cortar);
+    });
+
+/* Un error corta el recorrido (queda el primero) */
+if (CodError!=CODERROR_NINGUNO)
+    {
+	std::lock_guard<std::mutex> Lock(MutexLlamadas);
+	if (TRecorredorArbol::CodError==CODERROR_NINGUNO)
+		TRecorredorArbol::CodError=CodError;
+	Cortar=true;
+	return;
+    }
+
+/* Terminó su propio listado */
+Completar(Nodo);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TRecorredorArbol :: Completar							*
+ *																	*
+ * OBJETIVO: Esta función descuenta una tarea pendiente de un directorio y, si era la última, informa sus totales y los suma a su	*
+ *	     padre (que a su vez puede quedar completo).										*
+ *																	*
+ * ENTRADA: Nodo: Directorio.														*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TRecorredorArbol::Completar(TNodoArbol *Nodo)
+{
+TTotalesArbol	Suma;
+
+/* Subir mientras se vayan completando directorios */
+while ( (Nodo) && (--Nodo->Pendientes==0) )
+    {
+	/* Ya no cambia nadie: el listado y todos los subdirectorios terminaron */
+	Suma.Bytes=Nodo->Bytes;
+	Suma.Archivos=Nodo->Archivos;
+	Suma.Directorios=Nodo->Directorios;
+	Suma.Repetidos=Nodo->Repetidos;
+
+	/* Informarlo */
+	if (Resumen)
+	    {
+		std::lock_guard<std::mutex> Lock(MutexLlamadas);
+		if (!Cortar)
+			Resumen(Nodo->Ruta.c_str(), Suma);
+	    }
+
+	/* Sumarlo al padre, o al total si es la raíz */
+	if (!Nodo->Padre)
+		*Totales=Suma;
+	else
+	    {
+		Nodo->Padre->Bytes+=Suma.Bytes;
+		Nodo->Padre->Archivos+=Suma.Archivos;
+		Nodo->Padre->Directorios+=Suma.Directorios;
+		Nodo->Padre->Repetidos+=Suma.Repetidos;
+	    }
+	Nodo=Nodo->Padre;
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						    TRecorredorArbol :: NombreValido							*
+ *																	*
+ * OBJETIVO: Esta función indica si el nombre de una entrada es un único componente de ruta.						*
+ *																	*
+ * ENTRADA: Nombre: Nombre de la entrada, tal como lo decodificó el driver.								*
+ *																	*
+ * SALIDA: En el nombre de la función false si es vacío, "." o "..", o si tiene '/' o '\0'.						*
+ *																	*
+ * OBSERVACIONES: Sólo un nombre válido se puede agregar a una ruta sin cambiar a qué directorio se refiere.				*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TRecorredorArbol::NombreValido(const std::string &Nombre)
+{
+if ( (Nombre.empty()) || (Nombre==".") || (Nombre=="..") )
+	return(false);
+return(Nombre.find_first_of(std::string("/\0", 2)) == std::string::npos);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TRecorredorArbol :: Visto							*
+ *																	*
+ * OBJETIVO: Esta función marca como visto al objeto de un manejador.									*
+ *																	*
+ * ENTRADA: Manejador: Manejador del archivo o directorio.										*
+ *																	*
+ * SALIDA: En el nombre de la función true si es la primera vez que se lo ve.								*
+ *																	*
+ * OBSERVACIONES: Los objetos sin identificador (archivos vacíos en FAT) se consideran siempre nuevos.					*
+ *																	*
+ ****************************************************************************************************************************************/
+bool TRecorredorArbol::Visto(const TManejadorArchivo &Manejador)
+{
+__u64	Clave;
+
+/* Buscar el identificador en su parte del conjunto */
+if ( (Clave=Driver->Identificador(Manejador)) == 0 )
+	return(true);
+TParteVistos &Parte=Vistos[Clave%RECORRIDO_PARTES_VISTOS];
+std::lock_guard<std::mutex> Lock(Parte.Mutex);
+return(Parte.Claves.insert(Clave).second);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TRecorredorArbol :: Liberar							*
+ *																	*
+ * OBJETIVO: Esta función libera los nodos y colas de un recorrido anterior.								*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TRecorredorArbol::Liberar(void)
+{
+unsigned	i, j;
+
+/* Liberar los nodos que creó cada hilo */
+if (Colas)
+    {
+	for(i=0;i<NroHilos;i++)
+		for(j=0;j<Colas[i].Creados.size();j++)
+			delete Colas[i].Creados[j];
+	delete[] Colas;
+	Colas=NULL;
+    }
+
+/* Olvidar lo visto */
+for(i=0;i<RECORRIDO_PARTES_VISTOS;i++)
+	Vistos[i].Claves.clear();
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+﻿#include "all_heads.h"
+
+
+/********************************
+ *				*
+ *    Clase TRegistroDrivers	*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *						  TRegistroDrivers :: TRegistroDrivers							*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TRegistroDrivers::TRegistroDrivers()
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						  TRegistroDrivers :: ~TRegistroDrivers							*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados.													*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TRegistroDrivers::~TRegistroDrivers()
+{
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TRegistroDrivers :: Registrar							*
+ *																	*
+ * OBJETIVO: Esta función agrega un driver al final de la lista de drivers disponibles.							*
+ *																	*
+ * ENTRADA: Nombre: Nombre de los filesystems que maneja el driver (para los mensajes).							*
+ *	    Sondear: Función que reconoce la firma del filesystem en el comienzo de la imágen.						*
+ *	    Crear: Función que construye el driver.											*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Los drivers se prueban en el orden en que se registraron.								*
+ *																	*
+ ****************************************************************************************************************************************/
+void TRegistroDrivers::Registrar(const char *Nombre, TSondearDriver Sondear, TCrearDriver Crear)
+{
+TDriverRegistrado	Driver;
+
+/* Agregarlo a la lista */
+Driver.Nombre=Nombre;
+Driver.Sondear=Sondear;
+Driver.Crear=Crear;
+Drivers.push_back(Driver);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TRegistroDrivers :: NroDrivers							*
+ *																	*
+ * OBJETIVO: Esta función devuelve la cantidad de drivers registrados.									*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función la cantidad de drivers.										*
+ *																	*
+ ****************************************************************************************************************************************/
+unsigned TRegistroDrivers::NroDrivers(void)
+{
+return(Drivers.size());
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						       TRegistroDrivers :: Driver							*
+ *																	*
+ * OBJETIVO: Esta función devuelve los datos de un driver registrado.									*
+ *																	*
+ * ENTRADA: Indice: Posición del driver en la lista (0..NroDrivers()-1).								*
+ *																	*
+ * SALIDA: En el nombre de la función los datos del driver.										*
+ *																	*
+ ****************************************************************************************************************************************/
+const TDriverRegistrado &TRegistroDrivers::Driver(unsigned Indice)
+{
+return(Drivers[Indice]);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						     TRegistroDrivers :: LeerInicio							*
+ *																	*
+ * OBJETIVO: Esta función levanta, con una sola lectura, el comienzo de la imágen sobre el que trabajan las funciones de sondeo.	*
+ *																	*
+ * ENTRADA: Fuente: Origen de los datos de la imágen.											*
+ *	    Inicio: Buffer de al menos SONDEO_BYTES bytes.										*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si no hubo errores, caso contrario el código de error.				*
+ *	   Longitud: Cantidad de bytes levantados (menos de SONDEO_BYTES si la imágen es más chica).					*
+ *																	*
+ ****************************************************************************************************************************************/
+int TRegistroDrivers::LeerInicio(TFuenteSectores *Fuente, unsigned char *Inicio, unsigned &Longitud)
+{
+/* Recortar al tamaño de la imágen */
+Longitud=SONDEO_BYTES;
+if (Fuente->Longitud()<Longitud)
+	Longitud=(unsigned)Fuente->Longitud();
+
+/* Leerlo */
+return(Fuente->Leer(0, Longitud, Inicio));
+}
\ No newline at end of file
@@ -0,0 +1,350 @@
+﻿#include "all_heads.h"
+
+
+/************************
+ *			*
+ *     Constantes	*
+ *			*
+ ************************/
+static const char	DigitosMayusculas[] = "0123456789ABCDEF";
+static const char	DigitosMinusculas[] = "0123456789abcdef";
+
+
+/********************************
+ *				*
+ *	  Clase TSalida		*
+ *				*
+ ********************************/
+/****************************************************************************************************************************************
+ *																	*
+ *							   TSalida :: TSalida								*
+ *																	*
+ * OBJETIVO: Inicializar la clase recién creada.											*
+ *																	*
+ * ENTRADA: Archivo: Archivo abierto para escritura al que se vacía el buffer (sigue siendo propiedad del llamador).			*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TSalida::TSalida(FILE *Archivo)
+{
+/* Tomar los valores recibidos */
+TSalida::Archivo=Archivo;
+
+/* Alocar el buffer, se reutiliza durante toda la vida del objeto (si no hay memoria queda vacío y se informa en Error()) */
+Tamano=SALIDA_TAM_BUFFER;
+Usado=0;
+CodError=CODERROR_NINGUNO;
+if ( (Buffer=(char *)malloc(Tamano)) == NULL )
+    {
+	Tamano=0;
+	CodError=CODERROR_FALTA_MEMORIA;
+    }
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							   TSalida :: ~TSalida								*
+ *																	*
+ * OBJETIVO: Liberar recursos alocados, vaciando antes lo que quede en el buffer.							*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+TSalida::~TSalida()
+{
+/* Vaciar lo pendiente y liberar el buffer */
+Vaciar();
+free(Buffer);
+Buffer=NULL;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							TSalida :: CambiarArchivo							*
+ *																	*
+ * OBJETIVO: Esta función vacía el buffer al archivo actual y pasa a escribir en otro.							*
+ *																	*
+ * ENTRADA: Archivo: Archivo abierto para escritura (sigue siendo propiedad del llamador).						*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TSalida::CambiarArchivo(FILE *Archivo)
+{
+Vaciar();
+TSalida::Archivo=Archivo;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							    TSalida :: Vaciar								*
+ *																	*
+ * OBJETIVO: Esta función escribe en el archivo todo lo acumulado en el buffer.								*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TSalida::Vaciar(void)
+{
+/* Escribir lo acumulado de una sola vez */
+if (Usado>0)
+	fwrite(Buffer, 1, Usado, Archivo);
+Usado=0;
+fflush(Archivo);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							    TSalida :: Error								*
+ *																	*
+ * OBJETIVO: Esta función informa si desde la llamada anterior se perdió texto por falta de memoria para el buffer, y lo olvida.	*
+ *																	*
+ * ENTRADA: Nada.															*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si se escribió todo, caso contrario CODERROR_FALTA_MEMORIA.			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TSalida::Error(void)
+{
+int	Resultado;
+
+Resultado=CodError;
+CodError=CODERROR_NINGUNO;
+return(Resultado);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							   TSalida :: Agrandar								*
+ *																	*
+ * OBJETIVO: Esta función hace lugar en el buffer para Longitud bytes más.								*
+ *																	*
+ * ENTRADA: Longitud: Cantidad de bytes que se necesitan libres.									*
+ *																	*
+ * SALIDA: En el nombre de la función CODERROR_NINGUNO si hay lugar, caso contrario CODERROR_FALTA_MEMORIA.				*
+ *																	*
+ * OBSERVACIONES: Primero vacía el buffer al archivo, y sólo si el pedido no entra en un buffer vacío lo realoca. Si no hay memoria	*
+ *		  el buffer queda como estaba, lo que no entra se descarta y el error queda pendiente para Error().			*
+ *																	*
+ ****************************************************************************************************************************************/
+int TSalida::Agrandar(size_t Longitud)
+{
+char	*Nuevo;
+
+/* Vaciar lo acumulado */
+Vaciar();
+
+/* Si no alcanza con el buffer vacío, agrandarlo */
+if (Longitud>Tamano)
+    {
+	if ( (Nuevo=(char *)realloc(Buffer, Longitud)) == NULL )
+	    {
+		CodError=CODERROR_FALTA_MEMORIA;
+		return(CodError);
+	    }
+	Buffer=Nuevo;
+	Tamano=Longitud;
+    }
+
+/* Salir indicando éxito */
+return(CODERROR_NINGUNO);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *						      TSalida :: AgrandarYReservar							*
+ *																	*
+ * OBJETIVO: Esta función es el camino lento de Reservar() y Caracter(), cuando lo pedido no entra en el lugar libre del buffer.	*
+ *																	*
+ * ENTRADA: Longitud: Cantidad de bytes que se necesitan libres.									*
+ *																	*
+ * SALIDA: En el nombre de la función dónde escribirlos, o NULL si no hay memoria (el error queda pendiente para Error()).		*
+ *																	*
+ ****************************************************************************************************************************************/
+char *TSalida::AgrandarYReservar(size_t Longitud)
+{
+if (Agrandar(Longitud) != CODERROR_NINGUNO)
+	return(NULL);
+return(Buffer+Usado);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							    TSalida :: Printf								*
+ *																	*
+ * OBJETIVO: Esta función agrega al buffer un texto con el mismo formato que printf().							*
+ *																	*
+ * ENTRADA: Formato: Formato, igual que en printf().											*
+ *	    ...: Valores a formatear.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ * OBSERVACIONES: Para los encabezados y mensajes. Los ciclos que se repiten por entrada o por byte arman el texto a mano.		*
+ *																	*
+ ****************************************************************************************************************************************/
+void TSalida::Printf(const char *Formato, ...)
+{
+va_list	Argumentos;
+int	Longitud;
+
+/* Intentar formatear directamente en el lugar libre del buffer */
+va_start(Argumentos, Formato);
+Longitud=vsnprintf(Buffer+Usado, Tamano-Usado, Formato, Argumentos);
+va_end(Argumentos);
+if (Longitud<0)
+	return;
+
+/* Si no entró, hacer lugar y repetir */
+if ((size_t)Longitud>=Tamano-Usado)
+    {
+	if (Agrandar(Longitud+1) != CODERROR_NINGUNO)
+		return;
+	va_start(Argumentos, Formato);
+	vsnprintf(Buffer+Usado, Tamano-Usado, Formato, Argumentos);
+	va_end(Argumentos);
+    }
+Usado+=Longitud;
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							    TSalida :: Cadena								*
+ *																	*
+ * OBJETIVO: Esta función agrega al buffer una cadena terminada en '\0'.								*
+ *																	*
+ * ENTRADA: Texto: Cadena a agregar.													*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TSalida::Cadena(const char *Texto)
+{
+Bytes(Texto, strlen(Texto));
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							    TSalida :: Bytes								*
+ *																	*
+ * OBJETIVO: Esta función agrega al buffer un bloque de bytes tal cual.									*
+ *																	*
+ * ENTRADA: Datos: Bytes a agregar.													*
+ *	    Longitud: Cantidad de bytes.												*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TSalida::Bytes(const void *Datos, size_t Longitud)
+{
+char	*p;
+
+if ( (p=Reservar(Longitud)) == NULL )
+	return;
+memcpy(p, Datos, Longitud);
+Avanzar(Longitud);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							   TSalida :: Repetir								*
+ *																	*
+ * OBJETIVO: Esta función agrega al buffer un caracter repetido varias veces.								*
+ *																	*
+ * ENTRADA: Caracter: Caracter a agregar.												*
+ *	    Veces: Cantidad de repeticiones.												*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TSalida::Repetir(char Caracter, unsigned Veces)
+{
+char	*p;
+
+if ( (p=Reservar(Veces)) == NULL )
+	return;
+memset(p, Caracter, Veces);
+Avanzar(Veces);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							   TSalida :: Decimal								*
+ *																	*
+ * OBJETIVO: Esta función agrega al buffer un número en decimal, alineado a derecha como "%*llu".					*
+ *																	*
+ * ENTRADA: Valor: Número a agregar.													*
+ *	    Ancho: Ancho mínimo del campo (se completa con espacios a la izquierda).							*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TSalida::Decimal(__u64 Valor, unsigned Ancho)
+{
+char		Digitos[20];
+unsigned	n;
+
+/* Armar los dígitos de atrás para adelante */
+n=0;
+do
+    {
+	Digitos[sizeof(Digitos)-1-n++]='0'+(Valor%10);
+	Valor/=10;
+    }
+while (Valor);
+
+/* Rellenar y copiar */
+if (Ancho>n)
+	Repetir(' ', Ancho-n);
+Bytes(Digitos+sizeof(Digitos)-n, n);
+}
+
+
+/****************************************************************************************************************************************
+ *																	*
+ *							     TSalida :: Hexa								*
+ *																	*
+ * OBJETIVO: Esta función agrega al buffer un número en hexadecimal, completado con ceros como "%0*llx" o "%0*llX".			*
+ *																	*
+ * ENTRADA: Valor: Número a agregar.													*
+ *	    Ancho: Cantidad mínima de dígitos.												*
+ *	    Mayusculas: true para usar A-F, false para usar a-f.									*
+ *																	*
+ * SALIDA: Nada.															*
+ *																	*
+ ****************************************************************************************************************************************/
+void TSalida::Hexa(__u64 Valor, unsigned Ancho, bool Mayusculas)
+{
+const char	*Tabla = Mayusculas ? DigitosMayusculas : DigitosMinusculas;
+char		Digitos[16];
+unsigned	n;
+
+/* Armar los dígitos de atrás para adelante */
+n=0;
+do
+    {
+	Digitos[sizeof(Digitos)-1-n++]=Tabla[Valor & 0xF];
+	Valor>>=4;
+    }
+while (Valor);
+
+/* Rellenar y copiar */
+if (Ancho>n)
+	Repetir('0', Ancho-n);
+Bytes(Digitos+sizeof(Digitos)-n, n);
+}
\ No newline at end of file